@@ -19,10 +19,18 @@
 #include "render_engine.h"
 #include "timer.h"
 #include "logger.h"
+#include "metrics.h"
+#include "memory_usage.h"
+#include "flight_recorder.h"
 
 #include <boost/lexical_cast.hpp>
 
-AppGui::~AppGui() = default;
+#include <algorithm>
+
+AppGui::~AppGui()
+{
+    WaitForCompiles();
+}
 
 AppGui::AppGui(Scene& scene, 
                Timer& timer,
@@ -37,11 +45,14 @@ AppGui::AppGui(Scene& scene,
     , m_camera(camera)
     , m_selectedMap(selectedMap)
     , m_reloadEngine(reloadEngine)
+    , m_patchesMetric(Metrics::AddCounter("Patches Re-placed"))
+    , m_allocationsMetric(Metrics::AddGauge("Frame Allocations"))
 {
 }
 
-void AppGui::Tick(RenderEngine& engine)
+void AppGui::Tick(RenderEngine& engine, const FrameTimes& times)
 {
+    ApplyTweaks();
     UpdateShader(engine);
     switch (m_cache->PageSelected.Get())
     {
@@ -61,7 +72,98 @@ void AppGui::Tick(RenderEngine& engine)
         UpdateLight();
         UpdatePost(engine);
         break;
+    case Tweakable::GuiPage::Performance:
+        UpdatePerformance();
+        break;
     }
+
+    PublishStats(engine, times);
+}
+
+void AppGui::ApplyTweaks()
+{
+    TweakEvent event;
+    while (m_cache->Tweaks.Pop(event))
+    {
+        m_cache->Attribute(event.object, event.attribute).Set(event.value);
+        m_tweaked |= 1u << event.object;
+
+        if (event.object == TweakEvent::Texture)
+        {
+            m_cache->ReloadTexture.Set(true);
+        }
+        else if (event.object == TweakEvent::Terrain && 
+                (event.attribute == Tweakable::Terrain::MaxHeight ||
+                 event.attribute == Tweakable::Terrain::MinHeight ||
+                 event.attribute == Tweakable::Terrain::Scale))
+        {
+            m_cache->ReloadTerrain.Set(true);
+        }
+    }
+
+    // Changes are cached directly by the gui when the queue is full
+    // so which textures or terrain attributes changed is unknown
+    if (m_cache->Tweaks.TakeOverflowed())
+    {
+        m_tweaked = ~0u;
+        m_cache->ReloadTexture.Set(true);
+        m_cache->ReloadTerrain.Set(true);
+    }
+}
+
+void AppGui::PublishStats(const RenderEngine& engine, const FrameTimes& times)
+{
+    FrameStats stats;
+    stats.deltaTime = m_timer.GetDeltaTime();
+    stats.timer = m_timer.GetTotalTime();
+    stats.framesPerSec = m_timer.GetFPS();
+    stats.bytesUploaded = engine.GetBytesUploaded();
+    stats.patchesPlaced = Metrics::Get(m_patchesMetric);
+    stats.allocations = Metrics::Get(m_allocationsMetric);
+    stats.times = times;
+
+    auto addInstances = [&stats](const auto& objects)
+    {
+        for (const auto& data : objects)
+        {
+            stats.sceneInstances += data->GetVisibleInstances();
+        }
+    };
+
+    addInstances(m_data.meshes);
+    addInstances(m_data.water);
+    addInstances(m_data.terrain);
+    addInstances(m_data.emitters);
+
+    for (const auto& emitter : m_data.emitters)
+    {
+        stats.aliveParticles += emitter->GetAliveParticles();
+    }
+
+    auto setInstances = [&stats](FrameStats::Object object, int selected, const auto& objects)
+    {
+        if (selected >= 0 && selected < static_cast<int>(objects.size()))
+        {
+            const auto& data = *objects[selected];
+            stats.visibleInstances[object] = data.GetVisibleInstances();
+            stats.totalInstances[object] = static_cast<int>(data.Instances().size());
+        }
+    };
+
+    setInstances(FrameStats::Mesh, m_selectedMesh, m_data.meshes);
+    setInstances(FrameStats::Water, m_selectedWater, m_data.water);
+    setInstances(FrameStats::Terrain, m_selectedTerrain, m_data.terrain);
+    setInstances(FrameStats::Emitter, m_selectedEmitter, m_data.emitters);
+
+    m_cache->Stats.Publish(stats);
+}
+
+bool AppGui::TakeTweaked(TweakEvent::Object object)
+{
+    const unsigned int flag = 1u << object;
+    const bool tweaked = (m_tweaked & flag) != 0;
+    m_tweaked &= ~flag;
+    return tweaked;
 }
 
 void AppGui::SetApplicationRunning(bool run)
@@ -69,22 +171,73 @@ void AppGui::SetApplicationRunning(bool run)
     m_cache->ApplicationRunning.Set(run);
 }
 
-bool AppGui::ReCompileShader(const std::string& text, RenderEngine& engine)
+void AppGui::ReCompileShader(int index, 
+                             std::unique_ptr<ShaderCompileJob> job, 
+                             bool reload, 
+                             RenderEngine& engine)
+{
+    auto compile = std::make_shared<ShaderCompile>();
+    compile->job = std::move(job);
+    compile->engine = &engine;
+    compile->shader = index;
+    compile->reload = reload;
+    m_compiles.push_back(compile);
+
+    // Writing and compiling the text is kept off the render thread and
+    // serialised with the shader watcher regenerating the same files
+    const Shader& shader = *m_data.shaders[index];
+    m_compiler.Push([compile, &shader]()
+    {
+        std::lock_guard<std::mutex> lock(shader.FileMutex());
+        compile->errors = compile->job->Prepare();
+        compile->ready = true;
+    });
+}
+
+void AppGui::WaitForCompiles()
+{
+    m_compiler.Wait();
+    m_compiles.clear();
+}
+
+bool AppGui::IsEditCompiling() const
 {
-    const auto& shader = *m_data.shaders[m_selectedShader];
-    m_cache->CompileShader.Clear();
-    engine.WriteToShader(shader, text);
+    return std::any_of(m_compiles.begin(), m_compiles.end(),
+        [](const std::shared_ptr<ShaderCompile>& compile){ return !compile->reload; });
+}
+
+bool AppGui::FinishReCompile(RenderEngine& engine)
+{
+    // Finishing stalls the render thread so only one is swapped in each frame
+    if (m_compiles.empty() || !m_compiles.front()->ready)
+    {
+        return false;
+    }
+
+    auto compile = m_compiles.front();
+    m_compiles.pop_front();
+
+    // The engine has changed since the job was created
+    if (compile->engine != &engine)
+    {
+        return false;
+    }
+
+    const auto& shader = *m_data.shaders[compile->shader];
+    const std::string errors = compile->errors.empty() ?
+        compile->job->Finish() : compile->errors;
+    FlightRecorder::Record(FlightRecorder::ShaderRecompile, "%s", shader.Name().c_str());
 
-    std::string errors = engine.CompileShader(m_selectedShader);
     if(errors.empty())
     {
-        Logger::LogInfo(shader.Name() + ": Recompiled successfully");
-        return true;
+        Logger::LogInfo(shader.Name() + (compile->reload ?
+            ": Reloaded successfully" : ": Recompiled successfully"));
+        return compile->shader == m_selectedShader;
     }
     else
     {
-        Logger::LogInfo(shader.Name() + ": Failed Recompilation");
-        MessageBox(nullptr, (shader.Name() + ":" + errors).c_str(), "Compilation Errors", MB_OK);
+        Logger::LogError(shader.Name() + (compile->reload ?
+            ": Failed Reload\n" : ": Failed Recompilation\n") + errors);
         return false;
     }
 }
@@ -95,17 +248,44 @@ void AppGui::UpdateShader(RenderEngine& engine)
     bool changedShader = selectedShader != m_selectedShader;
     bool recompiledShader = false;
 
+    // Shaders regenerated from edited base shaders are reloaded in the background
+    for (int index : m_scene.GetReloadedShaders())
+    {
+        ReCompileShader(index, engine.CreateReloadJob(index), true, engine);
+    }
+
+    // Edits made while recompiling are left in the cache until it finishes
     const std::string updatedText = m_cache->CompileShader.Get();
-    if(!updatedText.empty() && m_selectedShader != -1)
+    if(!updatedText.empty() && m_selectedShader != -1 && !IsEditCompiling())
     {
-        recompiledShader = ReCompileShader(updatedText, engine);
+        m_cache->CompileShader.Clear();
+        ReCompileShader(m_selectedShader, 
+            engine.CreateCompileJob(m_selectedShader, updatedText), false, engine);
     }
+    recompiledShader |= FinishReCompile(engine);
 
     if(changedShader || recompiledShader)
     {
         m_selectedShader = selectedShader;
         m_cache->ShaderText.SetUpdated(engine.GetShaderText(m_selectedShader));
-        m_cache->ShaderAsm.SetUpdated(engine.GetShaderAssembly(m_selectedShader));
+        m_assemblyRequested = true;
+
+        std::string assembly;
+        if (!engine.GetShaderAssembly(m_selectedShader, assembly))
+        {
+            m_cache->ShaderAsm.SetUpdated("Generating assembly...");
+        }
+    }
+
+    // Assembly may be generated in the background so is sent once ready
+    if (m_assemblyRequested && m_selectedShader != -1)
+    {
+        std::string assembly;
+        if (engine.GetShaderAssembly(m_selectedShader, assembly))
+        {
+            m_cache->ShaderAsm.SetUpdated(assembly);
+            m_assemblyRequested = false;
+        }
     }
 }
 
@@ -126,13 +306,10 @@ void AppGui::UpdateScene(RenderEngine& engine)
 {
     UpdateCamera();
 
-    m_cache->FramesPerSec.Set(m_timer.GetFPS());
-    m_cache->DeltaTime.Set(m_timer.GetDeltaTime());
-    m_cache->Timer.Set(m_timer.GetTotalTime());
-
     if (m_cache->ReloadScene.Get())
     {
         m_cache->ReloadScene.Set(false);
+        FlightRecorder::Record(FlightRecorder::SceneReload);
         m_scene.Reload();
 
         const auto maxTextures = m_cache->Textures.Get().size();
@@ -156,9 +333,54 @@ void AppGui::UpdateScene(RenderEngine& engine)
 
     if (m_cache->ReloadPlacement.Get())
     {
+        FlightRecorder::Record(FlightRecorder::SceneReload, "Placement");
         m_scene.ReloadPlacement();
         m_cache->ReloadPlacement.Set(false);
     }
+
+    if (m_cache->ExportMetrics.Get())
+    {
+        if (Metrics::IsExporting())
+        {
+            Metrics::StopExport();
+        }
+        else
+        {
+            Metrics::StartExport("Metrics.csv");
+            Metrics::StartExport("Metrics.json");
+        }
+        m_cache->ExportMetrics.Set(false);
+    }
+
+    if (m_cache->WriteMemoryReport.Get())
+    {
+        Memory::WriteReport("MemoryReport.csv");
+        m_cache->WriteMemoryReport.Set(false);
+    }
+
+    // Only needs to refresh a few times a second to be readable
+    const float metricsInterval = 0.25f;
+    if (m_timer.GetTotalTime() >= m_metricsTime)
+    {
+        m_metricsTime = m_timer.GetTotalTime() + metricsInterval;
+        m_cache->PassMetrics.SetUpdated(Metrics::GetPassSummary());
+        m_cache->MemoryTotals.SetUpdated(Memory::GetSummary());
+    }
+}
+
+void AppGui::UpdatePerformance()
+{
+    const float budget = m_cache->FrameBudget.Get();
+    if (budget > 0.0f)
+    {
+        FlightRecorder::SetBudget(budget);
+    }
+
+    if (m_cache->CaptureTrace.Get())
+    {
+        m_cache->Stats.WriteTrace("Trace.json");
+        m_cache->CaptureTrace.Set(false);
+    }
 }
 
 void AppGui::UpdateCamera()
@@ -170,8 +392,11 @@ void AppGui::UpdateCamera()
     m_cache->Camera[Tweakable::Camera::Yaw].SetUpdated(m_camera.Rotation().y);
     m_cache->Camera[Tweakable::Camera::Roll].SetUpdated(m_camera.Rotation().z);
 
-    m_camera.SetForwardSpeed(m_cache->Camera[Tweakable::Camera::ForwardSpd].Get());
-    m_camera.SetRotationSpeed(m_cache->Camera[Tweakable::Camera::RotationSpd].Get());
+    if (TakeTweaked(TweakEvent::Camera))
+    {
+        m_camera.SetForwardSpeed(m_cache->Camera[Tweakable::Camera::ForwardSpd].Get());
+        m_camera.SetRotationSpeed(m_cache->Camera[Tweakable::Camera::RotationSpd].Get());
+    }
 }
 
 void AppGui::UpdateMesh()
@@ -187,8 +412,10 @@ void AppGui::UpdateMesh()
              m_selectedMesh < static_cast<int>(m_scene.Meshes().size()))
     {
         auto& mesh = *m_data.meshes[m_selectedMesh];
-        mesh.Read(*m_cache);
-        m_cache->MeshInstances.SetUpdated(mesh.GetRenderedInstances());
+        if (TakeTweaked(TweakEvent::Mesh))
+        {
+            mesh.Read(*m_cache);
+        }
     }
 }
 
@@ -204,8 +431,10 @@ void AppGui::UpdateWater()
             m_selectedWater < static_cast<int>(m_scene.Waters().size()))
     {
         auto& water = *m_data.water[m_selectedWater];
-        water.Read(*m_cache);
-        m_cache->WaterInstances.SetUpdated(water.GetRenderedInstances());
+        if (TakeTweaked(TweakEvent::Water))
+        {
+            water.Read(*m_cache);
+        }
     }
 
     if (m_selectedWater != -1)
@@ -221,7 +450,10 @@ void AppGui::UpdateWater()
         }
         else if(m_selectedWave >= 0 && m_selectedWave < waveCount)
         {
-            water.ReadWave(*m_cache, m_selectedWave);
+            if (TakeTweaked(TweakEvent::Wave))
+            {
+                water.ReadWave(*m_cache, m_selectedWave);
+            }
         }
     }
 }
@@ -238,8 +470,10 @@ void AppGui::UpdateTerrain(RenderEngine& engine)
             m_selectedTerrain < static_cast<int>(m_scene.Terrains().size()))
     {
         auto& terrain = *m_data.terrain[m_selectedTerrain];
-        terrain.Read(*m_cache);
-        m_cache->TerrainInstances.SetUpdated(terrain.GetRenderedInstances());
+        if (TakeTweaked(TweakEvent::Terrain))
+        {
+            terrain.Read(*m_cache);
+        }
     }
 
     if (m_cache->ReloadTerrain.Get())
@@ -264,8 +498,11 @@ void AppGui::UpdateTexture(RenderEngine& engine)
     else if(m_selectedTexture >= 0 && 
             m_selectedTexture < static_cast<int>(m_data.proceduralTextures.size()))
     {
-        const int ID = m_data.proceduralTextures[m_selectedTexture];
-        m_data.textures[ID]->Read(*m_cache);
+        if (TakeTweaked(TweakEvent::Texture))
+        {
+            const int ID = m_data.proceduralTextures[m_selectedTexture];
+            m_data.textures[ID]->Read(*m_cache);
+        }
     }
 
     if (m_cache->ReloadTexture.Get())
@@ -291,8 +528,10 @@ void AppGui::UpdateEmitter()
             m_selectedEmitter < static_cast<int>(m_scene.Emitters().size()))
     {
         auto& emitter = *m_data.emitters[m_selectedEmitter];
-        emitter.Read(*m_cache);
-        m_cache->EmitterInstances.SetUpdated(emitter.GetRenderedInstances());
+        if (TakeTweaked(TweakEvent::Emitter))
+        {
+            emitter.Read(*m_cache);
+        }
     }
 
     if (m_cache->PauseEmission.Get() && m_selectedEmitter != -1)
@@ -311,10 +550,12 @@ void AppGui::UpdatePost(RenderEngine& engine)
         m_scene.SetPostMap(selectedMap);
     }
 
-    m_data.post->Read(*m_cache);
-
-    m_data.caustics->SetSpeed(
-        m_cache->Post[Tweakable::Post::CausticSpeed].Get());
+    if (TakeTweaked(TweakEvent::Post))
+    {
+        m_data.post->Read(*m_cache);
+        m_data.caustics->SetSpeed(
+            m_cache->Post[Tweakable::Post::CausticSpeed].Get());
+    }
 
     if (m_cache->ToggleWireframe.Get())
     {
@@ -334,7 +575,10 @@ void AppGui::UpdateLight()
     else if(m_selectedLight >= 0 && 
             m_selectedLight < static_cast<int>(m_scene.Lights().size()))
     {
-        m_data.lights[m_selectedLight]->Read(*m_cache);
+        if (TakeTweaked(TweakEvent::Light))
+        {
+            m_data.lights[m_selectedLight]->Read(*m_cache);
+        }
     }
 
     if (m_cache->LightDiagnostics.Get())
@@ -378,6 +622,8 @@ void AppGui::Initialise(const std::vector<std::string>& engineNames,
     m_cache->Post[Tweakable::Post::CausticSpeed].SetUpdated(
         m_data.caustics->GetSpeed());
 
+    m_cache->FrameBudget.SetUpdated(FlightRecorder::GetBudget());
+
     m_data.post->Write(*m_cache);
 }
 
@@ -5,8 +5,13 @@
 #pragma once
 
 #include "cache.h"
+#include "shader_compile_job.h"
+#include "worker_thread.h"
 
 #include <functional>
+#include <atomic>
+#include <memory>
+#include <deque>
 
 struct SceneData;
 class Scene;
@@ -45,8 +50,9 @@ public:
     /**
     * Ticks the modifier to recieve information from the gui cache
     * @param engine The selected render engine
+    * @param times The stage times of the previous frame
     */
-    void Tick(RenderEngine& engine);
+    void Tick(RenderEngine& engine, const FrameTimes& times);
 
     /**
     * Sets whether the application should be running
@@ -64,6 +70,12 @@ public:
     */
     void SetSelectedEngine(int engine);
 
+    /**
+    * Blocks until shaders recompiling in the background are prepared and drops them
+    * @note called before releasing the engine the recompiles belong to
+    */
+    void WaitForCompiles();
+
     /**
     * Initialises the cache shared between the application and gui
     * @param engineNames The names of all engines supported
@@ -80,6 +92,30 @@ private:
     */
     void UpdateScene(RenderEngine& engine);
 
+    /**
+    * Updates the performance shared cache between the gui and application
+    */
+    void UpdatePerformance();
+
+    /**
+    * Caches any attribute changes sent from the gui
+    */
+    void ApplyTweaks();
+
+    /**
+    * Publishes the statistics of the frame for the gui
+    * @param engine The selected Render Engine
+    * @param times The stage times of the previous frame
+    */
+    void PublishStats(const RenderEngine& engine, const FrameTimes& times);
+
+    /**
+    * Clears whether the attributes of an object have changed
+    * @param object The object to query
+    * @return whether any attributes changed since last queried
+    */
+    bool TakeTweaked(TweakEvent::Object object);
+
     /**
     * Updates the scene camera from the shared cache
     */
@@ -130,12 +166,28 @@ private:
     void UpdateShader(RenderEngine& engine);
 
     /**
-    * Recompiles the currently selected shader
-    * @param text The new text to recompile with
+    * Queues recompiling a shader with its first stage in the background
+    * @param index The index of the shader to recompile
+    * @param job The job recompiling the shader
+    * @param reload Whether the job reloads regenerated files rather than edited text
+    * @param engine The selected render engine
+    */
+    void ReCompileShader(int index, 
+                         std::unique_ptr<ShaderCompileJob> job, 
+                         bool reload, 
+                         RenderEngine& engine);
+
+    /**
+    * Swaps in the oldest recompiled shader once its background stage is ready
     * @param engine The selected render engine
-    * @return whether recompilation was successful
+    * @return whether the selected shader was recompiled
     */
-    bool ReCompileShader(const std::string& text, RenderEngine& engine);
+    bool FinishReCompile(RenderEngine& engine);
+
+    /**
+    * @return whether edited text from the gui is recompiling
+    */
+    bool IsEditCompiling() const;
 
     /**
     * @return the names of the terrain in the scene
@@ -177,6 +229,20 @@ private:
     */
     std::vector<std::string> GetPostMapNames() const;
 
+    /**
+    * A shader recompiling in the background
+    * @note only read once ready as it is filled in by a worker thread
+    */
+    struct ShaderCompile
+    {
+        std::atomic<bool> ready { false };       ///< Whether the background stage has finished
+        std::unique_ptr<ShaderCompileJob> job;   ///< Job to finish on the render thread
+        std::string errors;                      ///< Errors from the background stage
+        const RenderEngine* engine = nullptr;    ///< Engine the job was created by
+        int shader = -1;                         ///< Index of the shader recompiling
+        bool reload = false;                     ///< Whether reloading regenerated files
+    };
+
 private:
 
     Scene& m_scene;                   ///< The scene object to manipulate
@@ -193,7 +259,14 @@ private:
     int m_selectedTexture = -1;       ///< Current texture selected
     int m_selectedTerrain = -1;       ///< Current terrain selected
     int m_engineAmount = 0;           ///< Number of engines that can be selected
+    bool m_assemblyRequested = false; ///< Whether the selected shader assembly is waiting to be sent
+    unsigned int m_tweaked = ~0u;     ///< Flag for each object with attributes changed by the gui
+    float m_metricsTime = 0.0f;       ///< Time to next send the pass metrics to the gui
+    int m_patchesMetric = -1;         ///< Metric for the terrain patches re-placed each frame
+    int m_allocationsMetric = -1;     ///< Metric for the heap allocations each frame
     std::shared_ptr<Cache> m_cache;   ///< Shared data between the gui and application
 
-    std::function<void(void)> m_reloadEngine = nullptr; ///< Callback to reload the engine
+    std::deque<std::shared_ptr<ShaderCompile>> m_compiles; ///< Shaders recompiling in the order requested
+    WorkerThread m_compiler;                               ///< Prepares recompiling shaders off the render thread
+    std::function<void(void)> m_reloadEngine = nullptr;    ///< Callback to reload the engine
 };
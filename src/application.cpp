@@ -7,23 +7,50 @@
 #include "timer.h"
 #include "opengl_engine.h"
 #include "directx_engine.h"
+#include "software_engine.h"
 #include "scene.h"
 #include "camera.h"
 #include "cache.h"
 #include "logger.h"
 #include "app_gui.h"
+#include "simulation_thread.h"
+#include "metrics.h"
+#include "flight_recorder.h"
+#include "arena.h"
 
 #include <windowsx.h>
+#include <chrono>
+
+namespace
+{
+    /**
+    * @return the milliseconds passed since the given time
+    */
+    float GetMillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+    {
+        return static_cast<float>(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count());
+    }
+
+    const bool PIPELINE_SIMULATION = true; ///< Whether to simulate the next frame while rendering
+}
 
 Application::Application()
     : m_selectedEngine(RenderingEngine::OpenGL)
     , m_camera(std::make_unique<Camera>())
     , m_timer(std::make_unique<Timer>())
     , m_scene(std::make_unique<Scene>())
+    , m_pipelined(PIPELINE_SIMULATION)
+    , m_bytesUploadedMetric(Metrics::AddGauge("Bytes Uploaded"))
+    , m_allocationsMetric(Metrics::AddGauge("Frame Allocations"))
 {
 }
 
-Application::~Application() = default;
+Application::~Application()
+{
+    // Worker must finish before the scene it ticks is destroyed
+    m_simulation.reset();
+}
 
 void Application::Run()
 {
@@ -31,6 +58,7 @@ void Application::Run()
     MSG msg;
     m_timer->StartTimer();
     bool runApplication = true;
+    Memory::TrackAllocations();
     
     while(runApplication)
     {
@@ -65,6 +93,10 @@ void Application::HandleKeyPress(const WPARAM& keypress)
     {
         m_camera->ToggleAutoMove();
     }
+    if (keypress == VK_F3)
+    {
+        TogglePipelining();
+    }
     if (keypress == VK_F2)
     {
         int index = m_selectedEngine + 1;
@@ -72,7 +104,8 @@ void Application::HandleKeyPress(const WPARAM& keypress)
         {
             index = 0;
         }
-        ForceRenderEngine(index);
+        // Switched once the worker is idle as the scene is reuploaded
+        m_forcedEngine = index;
     }
     else if (keypress == '1')
     {
@@ -195,20 +228,60 @@ void Application::HandleMouseMovement(const MSG& msg)
 
 void Application::TickApplication()
 {
-    m_modifier->Tick(GetEngine());
+    const float deltaTime = m_timer->GetDeltaTime();
+
+    // Any scene changes below require the worker to be idle
+    const bool simulated = m_simulation->Wait();
+    float simulationTime = simulated ? m_simulation->GetTickTime() : 0.0f;
 
-    if(m_camera->Update(m_timer->GetDeltaTime()))
+    m_modifier->Tick(GetEngine(), m_frameTimes);
+
+    if (m_forcedEngine != -1)
+    {
+        ForceRenderEngine(m_forcedEngine);
+        m_forcedEngine = -1;
+    }
+    FadeRenderEngine();
+
+    if(m_camera->Update(deltaTime))
     {
         GetEngine().UpdateView(m_camera->GetWorld());
     }
 
-    m_scene->Tick(m_timer->GetDeltaTime(), *m_camera);
+    if (!simulated)
+    {
+        const auto tickStart = std::chrono::high_resolution_clock::now();
+        m_scene->Tick(deltaTime, *m_camera);
+        simulationTime = GetMillisecondsSince(tickStart);
+    }
+
+    m_scene->Publish();
+    m_scene->PostTick();
 
+    if (m_pipelined)
+    {
+        m_simulation->Start(deltaTime, m_camera->Position(), m_camera->GetBounds());
+    }
+
+    const auto renderStart = std::chrono::high_resolution_clock::now();
     GetEngine().Render(*m_scene, m_timer->GetTotalTime());
+    const float renderTime = GetMillisecondsSince(renderStart);
 
-    m_scene->PostTick();
+    m_frameTimes.simulation = simulationTime;
+    m_frameTimes.gpuWait = GetEngine().GetPresentTime();
+    m_frameTimes.submission = renderTime > m_frameTimes.gpuWait ? 
+        renderTime - m_frameTimes.gpuWait : 0.0f;
 
-    FadeRenderEngine();
+    Scratch::Reset();
+
+    // Counts the heap allocations of the frame loop threads since the last frame
+    const unsigned int allocations = Memory::GetAllocations();
+    Metrics::Set(m_allocationsMetric, static_cast<int>(allocations - m_allocations));
+    m_allocations = allocations;
+
+    Metrics::Set(m_bytesUploadedMetric, GetEngine().GetBytesUploaded());
+    Metrics::EndFrame();
+    FlightRecorder::EndFrame(deltaTime, m_frameTimes);
 
     m_mouseDirection.x = 0;
     m_mouseDirection.y = 0;
@@ -228,6 +301,7 @@ bool Application::Initialise(HWND hwnd,
     m_engines.resize(RenderingEngine::Max);
     m_engines[RenderingEngine::OpenGL].reset(new OpenglEngine(hwnd));
     m_engines[RenderingEngine::DirectX].reset(new DirectxEngine(hwnd));
+    m_engines[RenderingEngine::Software].reset(new SoftwareEngine(hwnd));
 
     // Ensure that all engines can be initialised
     bool failed = false;
@@ -255,6 +329,13 @@ bool Application::Initialise(HWND hwnd,
 
     m_modifier->Initialise(engineNames, m_selectedEngine);
 
+    if (!GetEngine().RequiresGeometry())
+    {
+        m_scene->ReleaseGeometry();
+    }
+
+    m_simulation = std::make_unique<SimulationThread>(*m_scene);
+
     return true;
 }
 
@@ -307,22 +388,53 @@ void Application::FadeRenderEngine()
 
 void Application::SwitchRenderEngine(int index)
 {
+    // Geometry released after the last upload is needed to upload again
+    if (!m_scene->FetchGeometry())
+    {
+        Logger::LogError(m_engines[index]->GetName() + ": Failed to fetch scene geometry");
+
+        // Stays on the current engine which still holds the uploaded scene
+        if (!GetEngine().RequiresGeometry())
+        {
+            m_scene->ReleaseGeometry();
+        }
+        m_modifier->SetSelectedEngine(m_selectedEngine);
+        return;
+    }
+
+    // Recompiles in the background belong to the engine being released
+    m_modifier->WaitForCompiles();
+
     m_engines[m_selectedEngine]->Release();
     m_selectedEngine = index;
     auto& engine = GetEngine();
+    FlightRecorder::Record(FlightRecorder::EngineSwitch, "%s", engine.GetName().c_str());
 
     if (!engine.Initialize() || !engine.ReInitialiseScene())
     {
         Logger::LogError(engine.GetName() + ": Failed to reinitialise");
     }
 
+    if (!engine.RequiresGeometry())
+    {
+        m_scene->ReleaseGeometry();
+    }
+
     engine.UpdateView(m_camera->GetWorld());
     engine.SetFade(0.0f);
 }
 
+void Application::TogglePipelining()
+{
+    m_pipelined = !m_pipelined;
+    Logger::LogInfo(m_pipelined ? 
+        "Application: Pipelined simulation" : 
+        "Application: Serial simulation");
+}
+
 void Application::ForceRenderEngine(int index)
 {
     m_modifier->SetSelectedEngine(index);
     SwitchRenderEngine(index);
-    m_engines[index]->SetFade(1.0f);
+    GetEngine().SetFade(1.0f);
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "float3.h"
+#include "telemetry.h"
 
 #include <memory>
 #include <vector>
@@ -17,6 +18,7 @@ class Timer;
 class Scene;
 class AppGui;
 class Camera;
+class SimulationThread;
 struct Cache;
 
 /**
@@ -57,23 +59,33 @@ private:
     /**
     * Switches to a new render engine
     * @param index The index of the engine to switch to
+    * @note requires the simulation worker to be idle
     */
     void SwitchRenderEngine(int index);
 
     /**
     * Forces a direct switch to a render engine without fade
     * @param index The index of the engine to switch to
+    * @note requires the simulation worker to be idle
     */
     void ForceRenderEngine(int index);
 
     /**
     * Updates and renders the application
+    * @note when pipelined the scene for the next frame is
+    *       ticked on a worker thread while the current frame renders
     */
     void TickApplication();
 
+    /**
+    * Toggles between pipelined and serial simulation
+    */
+    void TogglePipelining();
+
     /**
     * Fades in or out if required for the selected render engine
     * @note when completing a fade out the render engine is release and switched
+    *       so requires the simulation worker to be idle
     */
     void FadeRenderEngine();
 
@@ -135,10 +147,17 @@ private:
     Float2 m_mousePosition;                               ///< 2D coordinates of the mouse
     bool m_mousePressed = false;                          ///< Whether the mouse is held down or not
     int m_selectedEngine = -1;                            ///< Currently selected engine
+    int m_forcedEngine = -1;                              ///< Engine to force a switch to at the next sync point
     std::unique_ptr<Camera> m_camera;                     ///< Scene camera for generating view matrix
     std::unique_ptr<Scene> m_scene;                       ///< Holds meshes, lighting and shader data
     std::unique_ptr<Timer> m_timer;                       ///< For measure change in frame time
     std::unique_ptr<AppGui> m_modifier;                   ///< Manipulates meshes, lighting and shader data
+    std::unique_ptr<SimulationThread> m_simulation;       ///< Ticks the scene alongside rendering
+    bool m_pipelined = false;                             ///< Whether simulation and rendering are pipelined
+    int m_bytesUploadedMetric = -1;                       ///< Metric for the bytes uploaded each frame
+    int m_allocationsMetric = -1;                         ///< Metric for the heap allocations each frame
+    unsigned int m_allocations = 0;                       ///< Heap allocations counted at the last frame
+    FrameTimes m_frameTimes;                              ///< Stage times of the previous frame
     std::vector<std::unique_ptr<RenderEngine>> m_engines; ///< Available render engines
     FadeState m_fadeState = FadeState::FadeIn;            ///< Current state of fading in/out the selected engine
 };
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - arena.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace
+{
+    const size_t SCRATCH_BLOCK_SIZE = 64 * 1024; ///< Bytes of each scratch block
+}
+
+Arena::Arena(Memory::Category category, size_t blockSize) :
+    m_blockSize(blockSize),
+    m_memory(category)
+{
+}
+
+void* Arena::Allocate(size_t bytes, size_t alignment)
+{
+    while (true)
+    {
+        if (m_block < m_blocks.size())
+        {
+            Block& block = m_blocks[m_block];
+            const uintptr_t start = reinterpret_cast<uintptr_t>(block.memory.get());
+            const uintptr_t aligned = (start + m_offset + alignment - 1) & ~(alignment - 1);
+            const size_t offset = static_cast<size_t>(aligned - start);
+
+            if (offset + bytes <= block.size)
+            {
+                m_offset = offset + bytes;
+                return block.memory.get() + offset;
+            }
+
+            // Blocks kept from before a reset are tried in turn
+            m_used += m_offset;
+            m_offset = 0;
+            ++m_block;
+            if (m_block < m_blocks.size() && m_blocks[m_block].size >= bytes + alignment)
+            {
+                continue;
+            }
+        }
+
+        Block block;
+        block.size = std::max(m_blockSize, bytes + alignment);
+        block.memory.reset(new char[block.size]);
+        m_memory.Add(block.size);
+        m_blocks.insert(m_blocks.begin() + m_block, std::move(block));
+    }
+}
+
+void Arena::Reset()
+{
+    m_block = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t Arena::Used() const
+{
+    return m_used + m_offset;
+}
+
+Arena& Scratch::Get()
+{
+    thread_local Arena arena(Memory::Scratch, SCRATCH_BLOCK_SIZE);
+    return arena;
+}
+
+void Scratch::Reset()
+{
+    Get().Reset();
+}
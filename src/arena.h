@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - arena.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "memory_usage.h"
+
+#include <boost/noncopyable.hpp>
+#include <type_traits>
+#include <memory>
+#include <vector>
+#include <new>
+
+/**
+* Linear allocator handing out memory from large blocks. Memory is only
+* released all at once on reset, which keeps the blocks for reuse so an
+* arena reset each frame stops allocating once the largest frame is seen
+*/
+class Arena : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param category The subsystem to account the blocks to
+    * @param blockSize The bytes of each block, larger requests get their own block
+    */
+    Arena(Memory::Category category, size_t blockSize);
+
+    /**
+    * Allocates memory which lives until the arena is reset or destroyed
+    * @param bytes The amount to allocate
+    * @param alignment The alignment required, must be a power of two
+    * @return the allocated memory
+    */
+    void* Allocate(size_t bytes, size_t alignment);
+
+    /**
+    * Allocates and value initialises an array of objects
+    * @param count The number of objects
+    * @return the first object
+    * @note objects are never destroyed so must not need to be
+    */
+    template <typename T> T* Create(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+            "Arena objects are never destroyed");
+
+        T* objects = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+        for (size_t i = 0; i < count; ++i)
+        {
+            new (&objects[i]) T();
+        }
+        return objects;
+    }
+
+    /**
+    * Releases all allocations while keeping the blocks for reuse
+    */
+    void Reset();
+
+    /**
+    * @return the bytes currently allocated from the arena
+    */
+    size_t Used() const;
+
+private:
+
+    /**
+    * A single block of memory
+    */
+    struct Block
+    {
+        std::unique_ptr<char[]> memory;   ///< The memory of the block
+        size_t size = 0;                  ///< Bytes in the block
+    };
+
+    std::vector<Block> m_blocks;     ///< All blocks held
+    size_t m_block = 0;              ///< Index of the block being allocated from
+    size_t m_offset = 0;             ///< Bytes used of the current block
+    size_t m_used = 0;               ///< Bytes used of all previous blocks
+    size_t m_blockSize = 0;          ///< The bytes of each block
+    MemoryUsage m_memory;            ///< Bytes held by all blocks
+};
+
+/**
+* Fixed size array of objects living in an arena
+* @note does not own the objects, copies refer to the same objects
+*/
+template <typename T> class ArenaArray
+{
+public:
+
+    /**
+    * Constructor
+    * @param arena The arena to allocate from
+    * @param size The number of objects to hold
+    */
+    ArenaArray(Arena& arena, size_t size) :
+        m_data(arena.Create<T>(size)),
+        m_size(size)
+    {
+    }
+
+    /**
+    * Constructor for an empty array
+    */
+    ArenaArray() = default;
+
+    T* begin() { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* begin() const { return m_data; }
+    const T* end() const { return m_data + m_size; }
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+    size_t size() const { return m_size; }
+
+private:
+
+    T* m_data = nullptr;  ///< The first object
+    size_t m_size = 0;    ///< The number of objects
+};
+
+/**
+* Per thread arena for temporaries only needed during a frame
+*/
+class Scratch
+{
+public:
+
+    /**
+    * @return the arena of the calling thread
+    */
+    static Arena& Get();
+
+    /**
+    * Releases all temporaries of the calling thread
+    * @note must be called once no temporaries of the thread are in use
+    */
+    static void Reset();
+};
+
+/**
+* Allocator for standard containers using the scratch arena of the calling thread.
+* Freeing does nothing, the memory is released when the scratch arena is reset
+*/
+template <typename T> class ScratchAllocator
+{
+public:
+
+    typedef T value_type;
+
+    ScratchAllocator() = default;
+    template <typename U> ScratchAllocator(const ScratchAllocator<U>&) {}
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(Scratch::Get().Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void deallocate(T*, size_t)
+    {
+    }
+
+    template <typename U> bool operator==(const ScratchAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const ScratchAllocator<U>&) const { return false; }
+};
+
+template <typename T> using ScratchVector = std::vector<T, ScratchAllocator<T>>;
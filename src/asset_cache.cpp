@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - asset_cache.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "asset_cache.h"
+#include "logger.h"
+
+#include "soil/SOIL.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    /**
+    * Gets the size and last write time of a file
+    * @note the time is finer than a second so a file rewritten
+    *       within the same second as it was last read is detected
+    * @param path The full path to the file
+    * @param size Set to the bytes in the file
+    * @param modified Set to the last write time in the finest units available
+    * @return whether the file exists
+    */
+    bool GetFileStamp(const std::string& path,
+                      unsigned long long& size,
+                      unsigned long long& modified)
+    {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data))
+        {
+            return false;
+        }
+        size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        modified = (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+            data.ftLastWriteTime.dwLowDateTime;
+#else
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return false;
+        }
+        size = static_cast<unsigned long long>(info.st_size);
+        modified = static_cast<unsigned long long>(info.st_mtim.tv_sec) * 1000000000ull +
+            static_cast<unsigned long long>(info.st_mtim.tv_nsec);
+#endif
+        return true;
+    }
+}
+
+std::shared_ptr<const AssetCache::Image> AssetCache::GetImage(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto itr = m_images.find(path);
+    if (itr != m_images.end())
+    {
+        return itr->second;
+    }
+
+    if (!boost::filesystem::exists(path))
+    {
+        Logger::LogError(path + " doesn't exist");
+        return nullptr;
+    }
+
+    int width = 0, height = 0;
+    unsigned char* data = SOIL_load_image(path.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
+    if (!data)
+    {
+        Logger::LogError("Failed to decode " + path);
+        return nullptr;
+    }
+
+    auto image = std::make_shared<Image>();
+    image->width = width;
+    image->height = height;
+    image->pixels.assign(data, data + width * height * 4);
+    SOIL_free_image_data(data);
+
+    m_images[path] = image;
+    return image;
+}
+
+std::shared_ptr<const std::string> AssetCache::GetText(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    unsigned long long size = 0;
+    unsigned long long modified = 0;
+    if (!GetFileStamp(path, size, modified))
+    {
+        return nullptr;
+    }
+
+    // Generated text is rewritten when shaders are edited
+    auto& entry = m_text[path];
+    if (entry.text && entry.modified == modified && entry.size == size)
+    {
+        return entry.text;
+    }
+
+    std::ifstream file(path, std::ios::in|std::ios::binary|std::ios::ate);
+    if (!file.is_open())
+    {
+        m_text.erase(path);
+        return nullptr;
+    }
+
+    auto text = std::make_shared<std::string>();
+    text->resize(static_cast<int>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(&(*text)[0], text->size());
+
+    entry.modified = modified;
+    entry.size = size;
+    entry.text = text;
+    return text;
+}
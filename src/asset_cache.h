@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - asset_cache.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+* Backend independent cache of decoded assets owned by the scene. Render
+* engines upload from the cache so switching engines does not decode
+* from disk again. Entries are shared so they stay valid while in use
+*/
+class AssetCache : boost::noncopyable
+{
+public:
+
+    /**
+    * Decoded RGBA image
+    */
+    struct Image
+    {
+        int width = 0;                     ///< Width of the image in pixels
+        int height = 0;                    ///< Height of the image in pixels
+        std::vector<unsigned char> pixels; ///< RGBA pixels of the image
+    };
+
+    /**
+    * Gets a decoded image, decoding it from file if not cached
+    * @param path The full path to the image
+    * @return the image or null if decoding failed
+    */
+    std::shared_ptr<const Image> GetImage(const std::string& path);
+
+    /**
+    * Gets the text of a file, reading it if not cached or if the file has changed
+    * @param path The full path to the file
+    * @return the text or null if reading failed
+    */
+    std::shared_ptr<const std::string> GetText(const std::string& path);
+
+private:
+
+    /**
+    * Cached text of a file
+    */
+    struct TextEntry
+    {
+        unsigned long long modified = 0;          ///< Time the file was last written
+        unsigned long long size = 0;              ///< Bytes in the file when read
+        std::shared_ptr<const std::string> text;  ///< Text of the file
+    };
+
+    std::mutex m_mutex;                                                     ///< Guards the cached entries
+    std::unordered_map<std::string, std::shared_ptr<const Image>> m_images; ///< Decoded images by path
+    std::unordered_map<std::string, TextEntry> m_text;                      ///< File text by path
+};
@@ -5,10 +5,12 @@
 #pragma once
 
 #include "tweakable_enums.h"
+#include "tweak_queue.h"
+#include "telemetry.h"
 
 #include <thread>
+#include <atomic>
 #include <array>
-#include <mutex>
 #include <vector>
 #include <string>
 
@@ -17,6 +19,9 @@
 * to control the value which a 'getter' thread will read. The getter 
 * thread can also lock the value from being set when the setter is
 * required to make an irregular get to update or initialise the value.
+* The value is double buffered: writers publish a whole new block and
+* readers copy the active block without locking or blocking writers
+* for longer than the copy of a block no longer active.
 */
 template <typename T> class Lockable
 {
@@ -26,16 +31,18 @@ public:
     * Constructor
     * @param data The value to initialise with
     */
-    Lockable(const T& data) :
-        m_data(data)
+    Lockable(const T& data)
     {
+        m_blocks[0].data = data;
+        m_readers[0] = 0;
+        m_readers[1] = 0;
     }
 
     /**
     * Constructor
     */
     Lockable() :
-        m_data(T())
+        Lockable(T())
     {
     }
 
@@ -45,58 +52,68 @@ public:
     virtual ~Lockable() = default;
 
     /**
-    * Locks the thread to update the data
+    * Publishes the data as an update
     * @note called by the getter thread to
     * notify the setter thread of irregular changes
     * @param data The data to set
     */
     void SetUpdated(const T& data)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (m_data != data)
+        LockWrite();
+        if (m_blocks[m_active].data != data)
         {
-            m_data = data;
-            m_updated = true;
+            Publish(data, true);
         }
+        UnlockWrite();
     }
 
     /**
-    * Locks the thread to get the updated data
+    * Gets the updated data and clears the update
     * @note called by the setter thread to 
     * recieve any getter thread irregular updates
     * @return a copy of the data
     */
     T GetUpdated()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_updated = false;
-        return m_data;
+        LockWrite();
+        const Block& block = m_blocks[m_active];
+        T data(block.data);
+        if (block.updated)
+        {
+            Publish(data, false);
+        }
+        UnlockWrite();
+        return data;
     }
 
     /**
-    * Locks the thread to set the data
+    * Publishes the data
     * @note called by the setter thread. Will not update
     * if an update is requested by the getter thread
     * @param data The data to set
     */
     void Set(const T& data)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if(!m_updated && m_data != data)
+        LockWrite();
+        const Block& block = m_blocks[m_active];
+        if(!block.updated && block.data != data)
         {
-            m_data = data;
+            Publish(data, false);
         }
+        UnlockWrite();
     }
 
     /**
-    * Locks the thread to get the data
+    * Gets the data without locking
     * @note calle by the getter thread
     * @return a copy of the data
     */
     T Get() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_data;
+        const int index = AcquireRead();
+        T data(m_blocks[index].data);
+        ReleaseRead(index);
+        return data;
     }
 
     /**
@@ -104,15 +121,104 @@ public:
     */
     bool RequiresUpdate() const
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        return m_updated;
+        const int index = AcquireRead();
+        const bool updated = m_blocks[index].updated;
+        ReleaseRead(index);
+        return updated;
+    }
+
+    /**
+    * @return the number of times the data has been published
+    */
+    unsigned int Version() const
+    {
+        return m_version;
     }
 
 protected:
 
-    bool m_updated = false;       ///< Flag for irregular updates by the getter thread
-    T m_data;                     ///< Internal data
-    mutable std::mutex m_mutex;   ///< Mutex for access
+    /**
+    * A consistent copy of the data and its update request
+    */
+    struct Block
+    {
+        T data = T();         ///< Internal data
+        bool updated = false; ///< Flag for irregular updates by the getter thread
+    };
+
+    /**
+    * Marks the active block as being read so it is not written to
+    * @return the index of the block to read
+    */
+    int AcquireRead() const
+    {
+        while (true)
+        {
+            // The block must still be active once marked or a writer may be filling it
+            const int index = m_active;
+            ++m_readers[index];
+            if (m_active == index)
+            {
+                return index;
+            }
+            --m_readers[index];
+        }
+    }
+
+    /**
+    * Allows the block to be written to once no longer active
+    * @param index The index of the block that was read
+    */
+    void ReleaseRead(int index) const
+    {
+        --m_readers[index];
+    }
+
+    /**
+    * Prevents other threads from publishing
+    */
+    void LockWrite()
+    {
+        while (m_writing.test_and_set(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+    * Allows other threads to publish
+    */
+    void UnlockWrite()
+    {
+        m_writing.clear(std::memory_order_release);
+    }
+
+    /**
+    * Fills the inactive block and makes it active
+    * @note requires the write lock
+    * @param data The data to set
+    * @param updated Whether the data is an irregular update
+    */
+    void Publish(const T& data, bool updated)
+    {
+        // Readers may still be copying the block from before the last publish
+        const int index = 1 - m_active;
+        while (m_readers[index] != 0)
+        {
+            std::this_thread::yield();
+        }
+
+        m_blocks[index].data = data;
+        m_blocks[index].updated = updated;
+        m_active = index;
+        ++m_version;
+    }
+
+    std::array<Block, 2> m_blocks;                     ///< The active and inactive blocks
+    std::atomic<int> m_active { 0 };                   ///< Index of the block to read
+    mutable std::atomic<int> m_readers[2];             ///< Number of readers of each block
+    std::atomic<unsigned int> m_version { 0 };         ///< Number of times the data was published
+    std::atomic_flag m_writing = ATOMIC_FLAG_INIT;     ///< Whether a thread is publishing
 };
 
 /**
@@ -127,11 +233,13 @@ public:
     */
     void Clear()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if(!m_updated)
+        LockWrite();
+        const Block& block = m_blocks[m_active];
+        if(!block.updated && !block.data.empty())
         {
-            m_data.clear();
+            Publish(std::string(), false);
         }
+        UnlockWrite();
     }
 };
 
@@ -151,10 +259,44 @@ struct Cache
         ToggleWireframe(false),
         RenderLightsOnly(false),
         LightDiagnostics(false),
-        PauseEmission(false)
+        PauseEmission(false),
+        ExportMetrics(false),
+        WriteMemoryReport(false),
+        CaptureTrace(false)
     {
     }
 
+    /**
+    * Gets the cached value of a tweakable attribute
+    * @param object The object the attribute belongs to
+    * @param attribute The attribute of the object
+    * @return the cached value of the attribute
+    */
+    Lockable<float>& Attribute(TweakEvent::Object object, int attribute)
+    {
+        switch (object)
+        {
+        case TweakEvent::Camera:
+            return Camera[attribute];
+        case TweakEvent::Light:
+            return Light[attribute];
+        case TweakEvent::Mesh:
+            return Mesh[attribute];
+        case TweakEvent::Water:
+            return Water[attribute];
+        case TweakEvent::Wave:
+            return Wave[attribute];
+        case TweakEvent::Emitter:
+            return Emitter[attribute];
+        case TweakEvent::Terrain:
+            return Terrain[attribute];
+        case TweakEvent::Texture:
+            return Texture[attribute];
+        default:
+            return Post[attribute];
+        }
+    }
+
     Lockable<int> PageSelected;         ///< Current page selected for the gui  
     Lockable<bool> ApplicationRunning;  ///< Whether the application is running          
     Lockable<bool> ReloadScene;         ///< Request to reload the scene
@@ -166,9 +308,9 @@ struct Cache
     Lockable<bool> LightDiagnostics;    ///< Request to toggle the light diagnostics
     Lockable<bool> PauseEmission;       ///< Request to pause the currently selected emitter
     Lockable<bool> RenderLightsOnly;    ///< Request to render only the lights
-    Lockable<float> DeltaTime;          ///< The time passed in seconds between ticks
-    Lockable<float> Timer;              ///< The time passed in seconds from start
-    Lockable<int> FramesPerSec;         ///< The frames per second for the application
+    Lockable<bool> ExportMetrics;       ///< Request to toggle exporting the frame metrics
+    Lockable<bool> WriteMemoryReport;   ///< Request to write the memory used to a file
+    Lockable<bool> CaptureTrace;        ///< Request to write the recent frames to a trace file
     Lockable<int> ShaderSelected;       ///< Index for the selected shader
     Lockable<int> EngineSelected;       ///< The selected render engine to use
     Lockable<int> LightSelected;        ///< Index of the currently selected light                                           
@@ -180,14 +322,13 @@ struct Cache
     Lockable<int> PostMapSelected;      ///< Index of the currently selected post map
     Lockable<int> TerrainSelected;      ///< Index of the currently selected terrain
     Lockable<int> WaveAmount;           ///< The amount of waves for the selected water
+    Lockable<float> FrameBudget;        ///< Milliseconds a frame can take before it is recorded
 
     LockableString TexturePath;         ///< Path to the currently selected texture
     LockableString TerrainShader;       ///< Shader used for the selected terrain
     LockableString MeshShader;          ///< Shader used for the selected mesh
-    LockableString MeshInstances;       ///< Number of instances of the selected mesh
-    LockableString TerrainInstances;    ///< Number of instances of the selected terrain
-    LockableString WaterInstances;      ///< Number of instances of the selected water
-    LockableString EmitterInstances;    ///< Number of instances of the selected emitter
+    LockableString PassMetrics;         ///< Calls counted for each render pass, one per line
+    LockableString MemoryTotals;        ///< Memory used by each subsystem, one per line
     LockableString ShaderText;          ///< Text for the selected shader
     LockableString ShaderAsm;           ///< Assembly for the selected shader
     LockableString CompileShader;       ///< Text to request to be compiled
@@ -211,4 +352,7 @@ struct Cache
     std::array<Lockable<float>, Tweakable::Emitter::Max> Emitter;  ///< Emitter attributes
     std::array<Lockable<float>, Tweakable::Terrain::Max> Terrain;  ///< Terrain attributes
     std::array<Lockable<float>, Tweakable::Texture::Max> Texture;  ///< Texture attributes
+
+    TweakQueue Tweaks;  ///< Attribute changes from the gui waiting to be cached
+    Telemetry Stats;    ///< Statistics of each frame published by the application
 };
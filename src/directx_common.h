@@ -21,6 +21,7 @@
 #include "emitter.h"
 #include "terrain.h"
 #include "light.h"
+#include "memory_usage.h"
 
 /**
 * Callbacks for pre-rendering elements
@@ -21,7 +21,7 @@ void DxEmitter::Render(ID3D11DeviceContext* context,
     D3DXMatrixIdentity(&rotate);
     D3DXMatrixIdentity(&translate);
 
-    for (const auto& instance : m_emitter.Instances())
+    for (const auto& instance : m_emitter.RenderInstances())
     {
         if (instance.render)
         {
@@ -9,11 +9,14 @@
 #include "directx_texture.h"
 #include "directx_emitter.h"
 #include "directx_target.h"
+#include "directx_ring_buffer.h"
+#include "shader_compile_job.h"
 #include "scene_interface.h"
+#include "metrics.h"
 #include "logger.h"
 
 #include <array>
-#include <fstream>
+#include <chrono>
 
 /**
 * Draw states available for rendering
@@ -72,6 +75,7 @@ struct DirectxData
     Rasterizer::State drawState;                     ///< The current state of the rasterizer
 
     DxQuad quad;                         ///< Quad to render the final post processed scene onto
+    DxRingBuffer uploads;                ///< Ring buffer for streaming dynamic data
     DxRenderTarget backBuffer;           ///< Render target for the back buffer
     DxRenderTarget sceneTarget;          ///< Render target for the main scene
     DxRenderTarget preEffectsTarget;     ///< Render target for pre-rendering effects
@@ -89,6 +93,7 @@ struct DirectxData
     bool useDiffuseTextures = true;      ///< Whether to render diffuse textures
     int selectedShader = -1;             ///< currently selected shader for rendering the scene
     float fadeAmount = 0.0f;             ///< the amount to fade the scene by
+    float presentTime = 0.0f;            ///< Milliseconds spent presenting the last frame
     
     std::unique_ptr<DxQuadMesh> shadows;              ///< Shadow instances
     std::vector<std::unique_ptr<DxTexture>> textures; ///< Textures shared by all meshes
@@ -105,6 +110,7 @@ DirectxData::DirectxData()
     , preEffectsTarget("PreEffectsTarget", EFFECTS_TEXTURES, false)
     , backBuffer("BackBuffer")
     , quad("SceneQuad")
+    , uploads("UploadRing", UPLOAD_FRAME_BYTES)
     , drawState(Rasterizer::None)
 {
     samplers.resize(Sampler::Max);
@@ -160,6 +166,7 @@ void DirectxData::Release()
     }
 
     quad.Release();
+    uploads.Release();
     sceneTarget.Release();
     blurTarget.Release();
     backBuffer.Release();
@@ -240,6 +247,13 @@ bool DirectxEngine::Initialize()
     // Create the post processing quad
     m_data->quad.Initialise(m_data->device, m_data->context);
 
+    // Create the ring buffer for dynamic uploads
+    if (!m_data->uploads.Initialise(m_data->device))
+    {
+        Logger::LogError("DirectX: Upload ring buffer failed to initialise");
+        return false;
+    }
+
     // Initialise all states
     if (!InitialiseBlendStates() ||
         !InitialiseDrawStates() ||
@@ -515,14 +529,14 @@ bool DirectxEngine::InitialiseScene(const IScene& scene)
     for(const auto& texture : scene.Textures())
     {
         m_data->textures.push_back(std::unique_ptr<DxTexture>(
-            new DxTexture(*texture)));
+            new DxTexture(*texture, scene.Assets())));
     }
 
     m_data->shaders.reserve(scene.Shaders().size());
     for(const auto& shader : scene.Shaders())
     {
         m_data->shaders.push_back(std::unique_ptr<DxShader>(
-            new DxShader(*shader)));
+            new DxShader(*shader, scene.Assets())));
     }
 
     m_data->meshes.reserve(scene.Meshes().size());
@@ -586,7 +600,7 @@ bool DirectxEngine::ReInitialiseScene()
 
     for(auto& texture : m_data->textures)
     {
-        texture->Initialise(m_data->device);
+        texture->Initialise(m_data->device, m_data->context);
     }
 
     for(auto& emitter : m_data->emitters)
@@ -623,11 +637,16 @@ void DirectxEngine::Render(const IScene& scene, float timer)
     RenderPreEffects(scene.Post());
     RenderBlur(scene.Post());
     RenderPostProcessing(scene.Post());
+    const auto presentStart = std::chrono::high_resolution_clock::now();
     m_data->swapchain->Present(0, 0);
+    m_data->presentTime = static_cast<float>(std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - presentStart).count());
+    m_data->uploads.EndFrame(m_data->context);
 }
 
 void DirectxEngine::RenderSceneMap(const IScene& scene, float timer)
 {
+    Metrics::SetPass(Metrics::Scene);
     m_data->sceneTarget.SetActive(m_data->context);
 
     RenderTerrain(scene);
@@ -700,6 +719,7 @@ void DirectxEngine::RenderEmitters(const IScene& scene)
 
 void DirectxEngine::RenderPreEffects(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::PreEffects);
     SetRenderState(false, false);
     EnableAlphaBlending(false, false);
 
@@ -721,6 +741,7 @@ void DirectxEngine::RenderPreEffects(const PostProcessing& post)
 
 void DirectxEngine::RenderBlur(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::Blur);
     SetRenderState(false, false);
     EnableAlphaBlending(false, false);
 
@@ -755,6 +776,7 @@ void DirectxEngine::RenderBlur(const PostProcessing& post)
 
 void DirectxEngine::RenderPostProcessing(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::Post);
     m_data->useDiffuseTextures = post.UseDiffuseTextures();
 
     SetRenderState(false, false);
@@ -848,7 +870,7 @@ bool DirectxEngine::UpdateShader(const MeshData& mesh,
             }
         }
 
-        SendTextures(mesh.TextureIDs());
+        SendTextures(mesh.RenderTextureIDs());
         SetRenderState(mesh.BackfaceCull(), m_data->isWireframe);
         EnableAlphaBlending(alphaBlend, false);
         return true;
@@ -1006,6 +1028,7 @@ bool DirectxEngine::SendTexture(int slot, int ID)
 
 void DirectxEngine::SetSelectedShader(int index)
 {
+    Metrics::Count(Metrics::ShaderSwitches);
     m_data->selectedShader = index;
     m_data->shaders[index]->SetActive(m_data->context);
 }
@@ -1057,9 +1080,11 @@ std::string DirectxEngine::GetShaderText(int index) const
     return m_data->shaders[index]->GetText();
 }
 
-std::string DirectxEngine::GetShaderAssembly(int index)
+bool DirectxEngine::GetShaderAssembly(int index, std::string& assembly)
 {
-    return m_data->shaders[index]->GetAssembly();
+    // Disassembly is from the compiled blobs without an external process
+    assembly = m_data->shaders[index]->GetAssembly();
+    return true;
 }
 
 void DirectxEngine::SetFade(float value)
@@ -1067,21 +1092,15 @@ void DirectxEngine::SetFade(float value)
     m_data->fadeAmount = value;
 }
 
-void DirectxEngine::WriteToShader(const Shader& shader,
-                                  const std::string& text)
+std::unique_ptr<ShaderCompileJob> DirectxEngine::CreateCompileJob(int index,
+                                                                  const std::string& text)
 {
-    std::ofstream file(shader.HLSLShaderFile().c_str(), 
-        std::ios_base::out | std::ios_base::trunc);
+    return m_data->shaders[index]->CreateCompileJob(m_data->device, text);
+}
 
-    if (!file.is_open())
-    {
-        Logger::LogError("Could not open " + shader.HLSLShaderFile());
-    }
-    else
-    {
-        file << text << std::endl;
-        file.close();
-    }
+std::unique_ptr<ShaderCompileJob> DirectxEngine::CreateReloadJob(int index)
+{
+    return m_data->shaders[index]->CreateReloadJob(m_data->device);
 }
 
 void DirectxEngine::EnableDepthWrite(bool enable)
@@ -1128,7 +1147,8 @@ void DirectxEngine::ToggleWireframe()
 void DirectxEngine::ReloadTerrain(int index)
 {
     const auto& name = m_data->terrain[index]->GetTerrain().Name();
-    if (!m_data->terrain[index]->Reload(m_data->context))
+    if (!m_data->terrain[index]->Reload(
+        m_data->uploads, m_data->device, m_data->context))
     {
         Logger::LogError("Terrain: " + name + " reload failed");
     }
@@ -1137,7 +1157,23 @@ void DirectxEngine::ReloadTerrain(int index)
 void DirectxEngine::ReloadTexture(int index)
 {
     const auto& name = m_data->textures[index]->Name();
-    m_data->textures[index]->ReloadPixels(m_data->device) ?
+    m_data->textures[index]->ReloadPixels(
+        m_data->device, m_data->context, m_data->uploads) ?
         Logger::LogInfo("Texture: " + name + " reload successful") :
         Logger::LogError("Texture: " + name + " reload failed");
 }
+
+int DirectxEngine::GetBytesUploaded() const
+{
+    return m_data->uploads.GetBytesUploaded();
+}
+
+float DirectxEngine::GetPresentTime() const
+{
+    return m_data->presentTime;
+}
+
+bool DirectxEngine::RequiresGeometry() const
+{
+    return false;
+}
@@ -115,10 +115,12 @@ public:
 
     /**
     * Gets the assembly for a specific shader
+    * @note does not block if the assembly is generated in the background
     * @param index The shader index
-    * @return the assembly for the shader
+    * @param assembly Filled with the assembly for the shader once ready
+    * @return whether the assembly is ready
     */
-    virtual std::string GetShaderAssembly(int index) override;
+    virtual bool GetShaderAssembly(int index, std::string& assembly) override;
 
     /**
     * Fades the screen in or out to black by the given amount
@@ -140,12 +142,35 @@ public:
     virtual void ToggleWireframe() override;
 
     /**
-    * Writes the shader text file
-    * @param shader The shader to write to
+    * Creates a job to recompile a shader from new text
+    * @param index The shader index
     * @param text The new text for the shader
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    virtual std::unique_ptr<ShaderCompileJob> CreateCompileJob(int index,
+                                                               const std::string& text) override;
+
+    /**
+    * Creates a job to recompile a shader from its regenerated files
+    * @param index The shader index
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    virtual std::unique_ptr<ShaderCompileJob> CreateReloadJob(int index) override;
+
+    /**
+    * @return the amount of bytes uploaded to the gpu during the last frame
+    */
+    virtual int GetBytesUploaded() const override;
+
+    /**
+    * @return the milliseconds spent presenting the last frame, including any wait on the gpu
+    */
+    virtual float GetPresentTime() const override;
+
+    /**
+    * @return whether the engine reads mesh geometry from the scene while rendering
     */
-    virtual void WriteToShader(const Shader& shader,
-                               const std::string& text) override;
+    virtual bool RequiresGeometry() const override;
 
 private:
 
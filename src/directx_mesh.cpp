@@ -3,6 +3,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 
 #include "directx_mesh.h"
+#include "directx_ring_buffer.h"
+#include "metrics.h"
 #include "logger.h"
 
 DxMeshBuffer::DxMeshBuffer(const std::string& name,
@@ -13,6 +15,7 @@ DxMeshBuffer::DxMeshBuffer(const std::string& name,
     , m_vertices(vertices)
     , m_indices(indices)
     , m_vertexStride(vertexStride)
+    , m_bufferMemory(Memory::GpuBuffers)
 {
 }
 
@@ -48,29 +51,9 @@ void DxMeshBuffer::Release()
 {
     SafeRelease(&m_vertexBuffer);
     SafeRelease(&m_indexBuffer);
-}
-
-bool DxMeshBuffer::FillBuffers(ID3D11DeviceContext* context)
-{
-    // Copy the mesh vertices to the directx mesh
-    D3D11_MAPPED_SUBRESOURCE vms;
-    if (FAILED(context->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &vms)))
-    {
-        return false;
-    }
-    memcpy(vms.pData, &m_vertices[0], sizeof(float)*m_vertices.size());
-    context->Unmap(m_vertexBuffer, 0); 
-    
-    // Copy the mesh indicies to the directx mesh
-    D3D11_MAPPED_SUBRESOURCE ims;
-    if(FAILED(context->Map(m_indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &ims)))
-    {
-        return false;
-    }
-    memcpy(ims.pData, &m_indices[0], sizeof(DWORD)*m_indices.size());
-    context->Unmap(m_indexBuffer, 0);
-
-    return true;
+    m_bufferMemory.Set(0);
+    m_vertexBytes = 0;
+    m_indexBytes = 0;
 }
 
 void DxMeshData::Initialise(ID3D11Device* device, 
@@ -79,7 +62,7 @@ void DxMeshData::Initialise(ID3D11Device* device,
     DxMeshBuffer::Initialise(device, context);
 
     m_world.clear();
-    m_world.resize(m_meshdata.Instances().size());
+    m_world.resize(m_meshdata.RenderInstances().size());
     for (auto& world : m_world)
     {
         D3DXMatrixIdentity(&world);
@@ -90,35 +73,72 @@ void DxMeshData::Initialise(ID3D11Device* device,
 void DxMeshBuffer::Initialise(ID3D11Device* device, 
                               ID3D11DeviceContext* context)
 {
-    // Create the vertex buffer
+    FillBuffers(device);
+}
+
+bool DxMeshBuffer::FillBuffers(ID3D11Device* device)
+{
+    Release();
+
+    // Create the vertex buffer. Reloads are streamed in through a ring buffer
     D3D11_BUFFER_DESC vbd;
     ZeroMemory(&vbd, sizeof(vbd));
-    vbd.Usage = D3D11_USAGE_DYNAMIC;
-    vbd.ByteWidth = m_vertexStride * m_vertices.size();
+    vbd.Usage = D3D11_USAGE_DEFAULT;
+    vbd.ByteWidth = sizeof(float) * m_vertices.size();
     vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    device->CreateBuffer(&vbd, 0, &m_vertexBuffer);
+    vbd.CPUAccessFlags = 0;
+
+    D3D11_SUBRESOURCE_DATA vdata;
+    ZeroMemory(&vdata, sizeof(vdata));
+    vdata.pSysMem = &m_vertices[0];
+
+    if (FAILED(device->CreateBuffer(&vbd, &vdata, &m_vertexBuffer)))
+    {
+        Logger::LogError("DirectX: Could not load mesh buffers");
+        return false;
+    }
     SetDebugName(m_vertexBuffer, m_name + "_VertexBuffer");
 
     // Create the index buffer
     D3D11_BUFFER_DESC ibd;
-    ibd.Usage = D3D11_USAGE_DYNAMIC;
+    ZeroMemory(&ibd, sizeof(ibd));
+    ibd.Usage = D3D11_USAGE_DEFAULT;
     ibd.ByteWidth = sizeof(DWORD) * m_indices.size();
     ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    ibd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    ibd.CPUAccessFlags = 0;
     ibd.MiscFlags = 0;
-    device->CreateBuffer(&ibd, 0, &m_indexBuffer);
-    SetDebugName(m_indexBuffer, m_name + "_IndexBuffer");
 
-    if (!FillBuffers(context))
+    D3D11_SUBRESOURCE_DATA idata;
+    ZeroMemory(&idata, sizeof(idata));
+    idata.pSysMem = &m_indices[0];
+
+    if (FAILED(device->CreateBuffer(&ibd, &idata, &m_indexBuffer)))
     {
         Logger::LogError("DirectX: Could not load mesh buffers");
+        return false;
     }
+    SetDebugName(m_indexBuffer, m_name + "_IndexBuffer");
+    m_bufferMemory.Set(vbd.ByteWidth + ibd.ByteWidth);
+    m_indexCount = static_cast<UINT>(m_indices.size());
+    m_vertexBytes = vbd.ByteWidth;
+    m_indexBytes = ibd.ByteWidth;
+    return true;
 }
 
-bool DxMeshBuffer::Reload(ID3D11DeviceContext* context)
+bool DxMeshBuffer::Reload(DxRingBuffer& ring, 
+                          ID3D11Device* device,
+                          ID3D11DeviceContext* context)
 {
-    return FillBuffers(context);
+    // Buffers can only be streamed into if their size hasn't changed
+    const int vertexBytes = sizeof(float) * m_vertices.size();
+    const int indexBytes = sizeof(DWORD) * m_indices.size();
+    if (vertexBytes != m_vertexBytes || indexBytes != m_indexBytes)
+    {
+        return FillBuffers(device);
+    }
+
+    return ring.UploadBuffer(context, m_vertexBuffer, &m_vertices[0], vertexBytes) &&
+           ring.UploadBuffer(context, m_indexBuffer, &m_indices[0], indexBytes);
 }
 
 void DxMeshBuffer::Render(ID3D11DeviceContext* context)
@@ -127,12 +147,13 @@ void DxMeshBuffer::Render(ID3D11DeviceContext* context)
     context->IASetVertexBuffers(0, 1, &m_vertexBuffer, &m_vertexStride, &offset);
     context->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
     context->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    context->DrawIndexed(m_indices.size(), 0, 0);
+    context->DrawIndexed(m_indexCount, 0, 0);
+    Metrics::Count(Metrics::DrawCalls);
 }
 
 void DxMeshData::Render(ID3D11DeviceContext* context)
 {
-    const auto& instances = m_meshdata.Instances();
+    const auto& instances = m_meshdata.RenderInstances();
     for (unsigned int i = 0; i < instances.size(); ++i)
     {
         const auto& instance = instances[i];
@@ -6,6 +6,8 @@
 
 #include "directx_common.h"
 
+class DxRingBuffer;
+
 /**
 * Base data for any polygons to be rendered
 */
@@ -51,28 +53,36 @@ public:
 
     /**
     * Reloads the mesh
+    * @param ring The ring buffer to stream the data through
+    * @param device The DirectX device interface
     * @param context The direct3D context
     * @return whether reloading was successful
     */
-    bool Reload(ID3D11DeviceContext* context);
+    bool Reload(DxRingBuffer& ring, 
+                ID3D11Device* device,
+                ID3D11DeviceContext* context);
 
-protected:
+private:
 
     /**
-    * Fills the vertex and index buffers
-    * @param context Direct3D device context
-    * @return whether call was successful
+    * Creates the vertex and index buffers from the mesh data
+    * @param device The DirectX device interface
+    * @return whether creation was successful
     */
-    bool FillBuffers(ID3D11DeviceContext* context);
+    bool FillBuffers(ID3D11Device* device);
 
 private:
 
     UINT m_vertexStride = 0;                    ///< Size of the vertex structure
+    UINT m_indexCount = 0;                      ///< Number of indices in the index buffer
+    int m_vertexBytes = 0;                      ///< Size of the vertex buffer in bytes
+    int m_indexBytes = 0;                       ///< Size of the index buffer in bytes
     ID3D11Buffer* m_vertexBuffer = nullptr;     ///< Buffer of vertex data for the mesh
     ID3D11Buffer* m_indexBuffer = nullptr;      ///< Buffer of index data for the mesh
     std::string m_name;                         ///< Name of the mesh
-    const std::vector<float>& m_vertices;       ///< Vertex buffer data
-    const std::vector<unsigned int>& m_indices; ///< Index buffer data
+    const std::vector<float>& m_vertices;       ///< Vertex buffer data, only read while uploading
+    const std::vector<unsigned int>& m_indices; ///< Index buffer data, only read while uploading
+    MemoryUsage m_bufferMemory;                 ///< Bytes held by the vertex and index buffers
 };
 
 /**
@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - directx_ring_buffer.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "directx_ring_buffer.h"
+#include "logger.h"
+
+namespace
+{
+    const int ALIGNMENT = 16; ///< Byte alignment of each allocation
+}
+
+DxRingBuffer::DxRingBuffer(const std::string& name, int frameBytes)
+    : m_name(name)
+    , m_frameBytes(frameBytes)
+    , m_bufferMemory(Memory::GpuBuffers)
+{
+    m_fences.fill(nullptr);
+    m_fenceIssued.fill(false);
+}
+
+DxRingBuffer::~DxRingBuffer()
+{
+    Release();
+}
+
+void DxRingBuffer::Release()
+{
+    for (auto& fence : m_fences)
+    {
+        SafeRelease(&fence);
+    }
+    m_fenceIssued.fill(false);
+
+    SafeRelease(&m_buffer);
+    m_bufferMemory.Set(0);
+
+    m_section = 0;
+    m_offset = 0;
+    m_bytesUploaded = 0;
+    m_lastBytesUploaded = 0;
+    m_sectionReady = false;
+    m_wrapped = true;
+}
+
+bool DxRingBuffer::Initialise(ID3D11Device* device)
+{
+    // Vertex binding is required for MAP_WRITE_NO_OVERWRITE on feature level 11.0
+    D3D11_BUFFER_DESC desc;
+    ZeroMemory(&desc, sizeof(desc));
+    desc.Usage = D3D11_USAGE_DYNAMIC;
+    desc.ByteWidth = m_frameBytes * UPLOAD_FRAMES;
+    desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    if (FAILED(device->CreateBuffer(&desc, 0, &m_buffer)))
+    {
+        Logger::LogError("DirectX: " + m_name + " failed to create buffer");
+        return false;
+    }
+    SetDebugName(m_buffer, m_name);
+    m_bufferMemory.Set(desc.ByteWidth);
+
+    D3D11_QUERY_DESC queryDesc;
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    queryDesc.MiscFlags = 0;
+
+    for (auto& fence : m_fences)
+    {
+        if (FAILED(device->CreateQuery(&queryDesc, &fence)))
+        {
+            Logger::LogError("DirectX: " + m_name + " failed to create fence");
+            return false;
+        }
+        SetDebugName(fence, m_name + "_Fence");
+    }
+    return true;
+}
+
+void DxRingBuffer::EndFrame(ID3D11DeviceContext* context)
+{
+    if (m_buffer && m_offset > 0)
+    {
+        context->End(m_fences[m_section]);
+        m_fenceIssued[m_section] = true;
+
+        m_section = (m_section + 1) % UPLOAD_FRAMES;
+        m_wrapped |= m_section == 0;
+        m_sectionReady = false;
+        m_offset = 0;
+    }
+
+    m_lastBytesUploaded = m_bytesUploaded;
+    m_bytesUploaded = 0;
+}
+
+void DxRingBuffer::WaitForSection(ID3D11DeviceContext* context)
+{
+    if (m_fenceIssued[m_section])
+    {
+        BOOL finished = FALSE;
+        while (context->GetData(m_fences[m_section],
+            &finished, sizeof(finished), 0) == S_FALSE)
+        {
+            SwitchToThread();
+        }
+        m_fenceIssued[m_section] = false;
+    }
+    m_sectionReady = true;
+}
+
+int DxRingBuffer::Stage(ID3D11DeviceContext* context, const void* data, int bytes)
+{
+    const int start = (m_offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (!m_buffer || start + bytes > m_frameBytes)
+    {
+        return -1;
+    }
+
+    if (!m_sectionReady)
+    {
+        WaitForSection(context);
+    }
+
+    // Discarding on wrap lets the driver rename the buffer, all other
+    // writes append to regions the gpu is guaranteed not to be reading
+    const auto mapType = m_wrapped ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(m_buffer, 0, mapType, 0, &mapped)))
+    {
+        Logger::LogError("DirectX: " + m_name + " failed to map buffer");
+        return -1;
+    }
+
+    const int offset = m_section * m_frameBytes + start;
+    memcpy(static_cast<unsigned char*>(mapped.pData) + offset, data, bytes);
+    context->Unmap(m_buffer, 0);
+
+    m_wrapped = false;
+    m_offset = start + bytes;
+    return offset;
+}
+
+bool DxRingBuffer::UploadBuffer(ID3D11DeviceContext* context,
+                                ID3D11Buffer* buffer,
+                                const void* data,
+                                int bytes)
+{
+    if (!buffer)
+    {
+        Logger::LogError("DirectX: " + m_name + " has no buffer to upload to");
+        return false;
+    }
+
+    D3D11_BUFFER_DESC desc;
+    buffer->GetDesc(&desc);
+    if (static_cast<int>(desc.ByteWidth) < bytes)
+    {
+        Logger::LogError("DirectX: " + m_name + " upload is larger than the buffer");
+        return false;
+    }
+
+    const int offset = Stage(context, data, bytes);
+    if (offset >= 0)
+    {
+        D3D11_BOX box;
+        box.left = offset;
+        box.right = offset + bytes;
+        box.top = 0;
+        box.bottom = 1;
+        box.front = 0;
+        box.back = 1;
+        context->CopySubresourceRegion(buffer, 0, 0, 0, 0, m_buffer, 0, &box);
+    }
+    else
+    {
+        context->UpdateSubresource(buffer, 0, nullptr, data, 0, 0);
+    }
+
+    m_bytesUploaded += bytes;
+    return true;
+}
+
+bool DxRingBuffer::UploadTexture(ID3D11DeviceContext* context,
+                                 ID3D11Texture2D* texture,
+                                 int size,
+                                 const void* pixels)
+{
+    if (!texture)
+    {
+        Logger::LogError("DirectX: " + m_name + " has no texture to upload to");
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+    if (static_cast<int>(desc.Width) != size || static_cast<int>(desc.Height) != size)
+    {
+        Logger::LogError("DirectX: " + m_name + " upload does not match the texture size");
+        return false;
+    }
+
+    // Direct3D 11 cannot copy from a buffer into a texture, so the pixels
+    // go through the driver's staging memory and are counted as an upload
+    const int channels = 4;
+    context->UpdateSubresource(texture, 0, nullptr, pixels, size * channels, 0);
+
+    m_bytesUploaded += size * size * channels;
+    return true;
+}
+
+int DxRingBuffer::GetBytesUploaded() const
+{
+    return m_lastBytesUploaded;
+}
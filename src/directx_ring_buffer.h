@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - directx_ring_buffer.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "directx_common.h"
+
+#include <array>
+
+/**
+* Dynamic buffer split into a section per frame in flight. Dynamic data is
+* appended with MAP_WRITE_NO_OVERWRITE and copied on the gpu into its
+* destination, with an event query guarding each section from being
+* overwritten before the gpu has finished reading from it
+*/
+class DxRingBuffer : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param name The name of the ring buffer
+    * @param frameBytes The size of a single frame section
+    */
+    DxRingBuffer(const std::string& name, int frameBytes);
+
+    /**
+    * Destructor
+    */
+    ~DxRingBuffer();
+
+    /**
+    * Releases the ring buffer
+    */
+    void Release();
+
+    /**
+    * Initialises the ring buffer
+    * @param device The DirectX device interface
+    * @return whether initialisation succeeded
+    */
+    bool Initialise(ID3D11Device* device);
+
+    /**
+    * Fences the current section and moves to the next
+    * @param context Direct3D device context
+    * @note should be called once all commands for the frame are submitted
+    */
+    void EndFrame(ID3D11DeviceContext* context);
+
+    /**
+    * Uploads data into the start of an existing buffer
+    * @param context Direct3D device context
+    * @param buffer The buffer to upload to
+    * @param data The data to upload
+    * @param bytes The size of the data in bytes
+    * @return whether the upload was successful
+    */
+    bool UploadBuffer(ID3D11DeviceContext* context,
+                      ID3D11Buffer* buffer,
+                      const void* data,
+                      int bytes);
+
+    /**
+    * Uploads pixels into the top mip level of an existing texture
+    * @param context Direct3D device context
+    * @param texture The RGBA texture to upload to
+    * @param size The dimensions of the texture
+    * @param pixels The pixels to upload
+    * @return whether the upload was successful
+    */
+    bool UploadTexture(ID3D11DeviceContext* context,
+                       ID3D11Texture2D* texture,
+                       int size,
+                       const void* pixels);
+
+    /**
+    * @return the amount of bytes uploaded during the last frame
+    */
+    int GetBytesUploaded() const;
+
+private:
+
+    /**
+    * Copies the data into the current section
+    * @param context Direct3D device context
+    * @param data The data to copy
+    * @param bytes The size of the data in bytes
+    * @return the offset into the buffer or -1 if the data could not fit
+    */
+    int Stage(ID3D11DeviceContext* context, const void* data, int bytes);
+
+    /**
+    * Waits for the gpu to finish reading the current section
+    * @param context Direct3D device context
+    */
+    void WaitForSection(ID3D11DeviceContext* context);
+
+private:
+
+    std::string m_name;                              ///< Name of the ring buffer
+    ID3D11Buffer* m_buffer = nullptr;                ///< Dynamic buffer to stage data in
+    std::array<ID3D11Query*, UPLOAD_FRAMES> m_fences; ///< Event query for each frame section
+    std::array<bool, UPLOAD_FRAMES> m_fenceIssued;   ///< Whether the section's query is pending
+    int m_frameBytes = 0;                            ///< Size of a single frame section
+    int m_section = 0;                               ///< Section currently being written to
+    int m_offset = 0;                                ///< Offset into the current section
+    int m_bytesUploaded = 0;                         ///< Bytes uploaded for the current frame
+    int m_lastBytesUploaded = 0;                     ///< Bytes uploaded for the last frame
+    bool m_sectionReady = false;                     ///< Whether the current section can be written to
+    bool m_wrapped = true;                           ///< Whether the next map should discard the buffer
+    MemoryUsage m_bufferMemory;                      ///< Bytes held by the buffer
+};
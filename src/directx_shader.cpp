@@ -4,6 +4,10 @@
 
 #include "directx_shader.h"
 #include "directx_target.h"
+#include "shader_cache.h"
+#include "asset_cache.h"
+#include "shader_compile_job.h"
+#include "metrics.h"
 #include "logger.h"
 
 #include <boost/algorithm/string.hpp>
@@ -31,12 +35,46 @@ namespace
     const std::string VERTEX_MODEL("vs_5_0");
     const std::string PIXEL_MODEL("ps_5_0");
     const std::string HLSL_IN_POSITION("POSITION");
+
+    /**
+    * @return identification of the adapter, driver and compiler used to generate bytecode
+    */
+    std::string GetDriverID(ID3D11Device* device)
+    {
+        std::string driver(std::to_string(D3DX11_SDK_VERSION));
+
+        IDXGIDevice* dxgiDevice = nullptr;
+        IDXGIAdapter* adapter = nullptr;
+        if (SUCCEEDED(device->QueryInterface(__uuidof(IDXGIDevice), (void**)&dxgiDevice)) &&
+            SUCCEEDED(dxgiDevice->GetAdapter(&adapter)))
+        {
+            DXGI_ADAPTER_DESC desc;
+            if (SUCCEEDED(adapter->GetDesc(&desc)))
+            {
+                driver += "|" + std::to_string(desc.VendorId) +
+                          "|" + std::to_string(desc.DeviceId) +
+                          "|" + std::to_string(desc.Revision);
+            }
+
+            LARGE_INTEGER version;
+            if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &version)))
+            {
+                driver += "|" + std::to_string(version.QuadPart);
+            }
+        }
+
+        SafeRelease(&adapter);
+        SafeRelease(&dxgiDevice);
+        return driver;
+    }
 }
 
-DxShader::DxShader(const Shader& shader)
+DxShader::DxShader(const Shader& shader, AssetCache& assets)
     : m_shader(shader)
+    , m_assets(assets)
     , m_filepath(shader.HLSLShaderFile())
     , m_asmpath(shader.HLSLShaderAsmFile())
+    , m_textMemory(Memory::ShaderText)
 {
     const int maxSupportedTextures = 8;
     m_allocatedSlots.resize(maxSupportedTextures);
@@ -68,7 +106,8 @@ DxShader::ConstantBuffer::ConstantBuffer() :
     buffer(nullptr),
     isVertexBuffer(false),
     updated(false),
-    startSlot(-1)
+    startSlot(-1),
+    memory(Memory::GpuBuffers)
 {
 }
 
@@ -79,24 +118,223 @@ DxShader::ConstantBuffer::~ConstantBuffer()
 
 std::string DxShader::CompileShader(ID3D11Device* device)
 {
-    std::string vertexError = CompileShader(&m_vsBlob, true);
-    std::string pixelError = CompileShader(&m_psBlob, false);
+    const auto text = m_assets.GetText(m_filepath);
+    if (!text)
+    {
+        return "Could not open file " + m_filepath;
+    }
 
+    ID3D10Blob* vsBlob = nullptr;
+    ID3D10Blob* psBlob = nullptr;
+    const unsigned long long cacheKey = ShaderCache::GenerateKey(GetDriverID(device), *text);
+    std::string vertexError = CompileShader(m_filepath, 
+        m_shader.HLSLVertexBinaryFile(), true, cacheKey, &vsBlob);
+    std::string pixelError = CompileShader(m_filepath, 
+        m_shader.HLSLPixelBinaryFile(), false, cacheKey, &psBlob);
+
+    std::string errorBuffer;
     if(!vertexError.empty() || !pixelError.empty())
     {
+        errorBuffer = vertexError.empty() ? pixelError :
+            vertexError + (pixelError.empty() ? "" : "\n"+pixelError);
+    }
+    else
+    {
+        errorBuffer = CreateShaders(device, *text, vsBlob, psBlob);
+    }
+
+    SafeRelease(&vsBlob);
+    SafeRelease(&psBlob);
+    return errorBuffer;
+}
+
+class DxShader::CompileJob : public ShaderCompileJob
+{
+public:
+
+    /**
+    * Constructor
+    * @param shader The shader to recompile
+    * @param device The DirectX device interface
+    * @param text The new text for the shader
+    */
+    CompileJob(DxShader& shader, ID3D11Device* device, const std::string& text)
+        : m_shader(shader)
+        , m_device(device)
+        , m_text(text + "\n")
+        , m_driver(GetDriverID(device))
+        , m_filepath(shader.m_filepath)
+        , m_vsCachePath(shader.m_shader.HLSLVertexBinaryFile())
+        , m_psCachePath(shader.m_shader.HLSLPixelBinaryFile())
+    {
+    }
+
+    /**
+    * Constructor for reloading the regenerated file
+    * @param shader The shader to recompile
+    * @param device The DirectX device interface
+    */
+    CompileJob(DxShader& shader, ID3D11Device* device)
+        : m_shader(shader)
+        , m_device(device)
+        , m_driver(GetDriverID(device))
+        , m_filepath(shader.m_filepath)
+        , m_vsCachePath(shader.m_shader.HLSLVertexBinaryFile())
+        , m_psCachePath(shader.m_shader.HLSLPixelBinaryFile())
+        , m_reload(true)
+    {
+    }
+
+    /**
+    * Destructor
+    */
+    ~CompileJob()
+    {
+        SafeRelease(&m_vsBlob);
+        SafeRelease(&m_psBlob);
+    }
+
+    /**
+    * Writes the text, or reads the regenerated text when reloading,
+    * and compiles it into bytecode
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Prepare() override
+    {
+        if (m_reload)
+        {
+            // The asset cache is safe to read through off the render thread
+            const auto text = m_shader.m_assets.GetText(m_filepath);
+            if (!text)
+            {
+                return "Could not open file " + m_filepath;
+            }
+            m_text = *text;
+        }
+        else
+        {
+            // Text mode keeps the line endings the linker generates with
+            std::ofstream file(m_filepath.c_str(), std::ios_base::out|std::ios_base::trunc);
+
+            if(!file.is_open())
+            {
+                return "Could not open file " + m_filepath;
+            }
+            file << m_text;
+        }
+
+        const unsigned long long cacheKey = ShaderCache::GenerateKey(m_driver, m_text);
+        std::string vertexError = DxShader::CompileShader(
+            m_filepath, m_vsCachePath, true, cacheKey, &m_vsBlob);
+        std::string pixelError = DxShader::CompileShader(
+            m_filepath, m_psCachePath, false, cacheKey, &m_psBlob);
+
         return vertexError.empty() ? pixelError :
             vertexError + (pixelError.empty() ? "" : "\n"+pixelError);
     }
 
-    Release();
+    /**
+    * Creates the shaders from the bytecode, swapping them on success
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Finish() override
+    {
+        return m_shader.CreateShaders(m_device, m_text, m_vsBlob, m_psBlob);
+    }
 
-    std::string errorBuffer = LoadShaderText();
-    if(!errorBuffer.empty())
+private:
+
+    DxShader& m_shader;              ///< The shader to swap once compiled
+    ID3D11Device* m_device;          ///< The device to create the shaders with
+    std::string m_text;              ///< The new text as written to the file
+    std::string m_driver;            ///< Identification of the driver for the cache key
+    std::string m_filepath;          ///< Path to the shader file
+    std::string m_vsCachePath;       ///< Path to the cached vertex bytecode
+    std::string m_psCachePath;       ///< Path to the cached pixel bytecode
+    ID3D10Blob* m_vsBlob = nullptr;  ///< Compiled vertex shader
+    ID3D10Blob* m_psBlob = nullptr;  ///< Compiled pixel shader
+    bool m_reload = false;           ///< Whether to read the file rather than write it
+};
+
+std::unique_ptr<ShaderCompileJob> DxShader::CreateCompileJob(ID3D11Device* device,
+                                                             const std::string& text)
+{
+    return std::make_unique<CompileJob>(*this, device, text);
+}
+
+std::unique_ptr<ShaderCompileJob> DxShader::CreateReloadJob(ID3D11Device* device)
+{
+    return std::make_unique<CompileJob>(*this, device);
+}
+
+std::string DxShader::CompileShader(const std::string& filepath,
+                                    const std::string& cachePath,
+                                    bool isVertex, 
+                                    unsigned long long cacheKey,
+                                    ID3D10Blob** shader)
+{
+    SafeRelease(shader);
+    ID3D10Blob* errorBlob = nullptr;
+
+    const std::string entry = isVertex ? VERTEX_ENTRY : PIXEL_ENTRY;
+    const std::string model = isVertex ? VERTEX_MODEL : PIXEL_MODEL;
+
+    unsigned int format = 0;
+    std::vector<char> bytecode;
+    if (ShaderCache::Load(cachePath, cacheKey, format, bytecode) &&
+        SUCCEEDED(D3DCreateBlob(bytecode.size(), shader)))
     {
-        return errorBuffer;
+        memcpy((*shader)->GetBufferPointer(), &bytecode[0], bytecode.size());
+        return std::string();
     }
 
-    errorBuffer = CreateShaders(device);
+    if(FAILED(D3DX11CompileFromFile(filepath.c_str(), 0, 0,
+        entry.c_str(), model.c_str(), 0, 0, 0, shader, &errorBlob, 0)) || !(*shader))
+    {
+        return (isVertex ? VS : PS) + (!errorBlob ? "Unknown Error" :
+            std::string(static_cast<char*>(errorBlob->GetBufferPointer())));
+    }
+
+    SafeRelease(&errorBlob);
+    ShaderCache::Save(cachePath, cacheKey, 0, (*shader)->GetBufferPointer(),
+        static_cast<int>((*shader)->GetBufferSize()));
+
+    return std::string();
+}
+
+std::string DxShader::CreateShaders(ID3D11Device* device,
+                                    const std::string& text,
+                                    ID3D10Blob* vsBlob,
+                                    ID3D10Blob* psBlob)
+{
+    // Created before releasing so the shaders in use are kept on failure
+    ID3D11VertexShader* vs = nullptr;
+    if(FAILED(device->CreateVertexShader(vsBlob->GetBufferPointer(),
+        vsBlob->GetBufferSize(), 0, &vs)))
+    {
+        return VS + "Could not create shader";
+    }
+
+    ID3D11PixelShader* ps = nullptr;
+    if(FAILED(device->CreatePixelShader(psBlob->GetBufferPointer(),
+        psBlob->GetBufferSize(), 0, &ps)))
+    {
+        SafeRelease(&vs);
+        return PS + "Could not create shader";
+    }
+
+    Release();
+    SafeRelease(&m_vsBlob);
+    SafeRelease(&m_psBlob);
+
+    m_vs = vs;
+    m_ps = ps;
+    m_vsBlob = vsBlob;
+    m_psBlob = psBlob;
+    m_vsBlob->AddRef();
+    m_psBlob->AddRef();
+
+    std::string errorBuffer = LoadShaderText(text);
     if(!errorBuffer.empty())
     {
         return errorBuffer;
@@ -138,42 +376,6 @@ std::string DxShader::CompileShader(ID3D11Device* device)
     return std::string();
 }
 
-std::string DxShader::CompileShader(ID3D10Blob** shader, bool isVertex)
-{
-    *shader = nullptr;
-    ID3D10Blob* errorBlob = nullptr;
-
-    const std::string entry = isVertex ? VERTEX_ENTRY : PIXEL_ENTRY;
-    const std::string model = isVertex ? VERTEX_MODEL : PIXEL_MODEL;
-
-    if(FAILED(D3DX11CompileFromFile(m_filepath.c_str(), 0, 0,
-        entry.c_str(), model.c_str(), 0, 0, 0, shader, &errorBlob, 0)) || !(*shader))
-    {
-        return (isVertex ? VS : PS) + (!errorBlob ? "Unknown Error" :
-            std::string(static_cast<char*>(errorBlob->GetBufferPointer())));
-    }
-
-    SafeRelease(&errorBlob);
-    return std::string();
-}
-
-std::string DxShader::CreateShaders(ID3D11Device* device)
-{
-    if(FAILED(device->CreateVertexShader(m_vsBlob->GetBufferPointer(),
-        m_vsBlob->GetBufferSize(), 0, &m_vs)))
-    {
-        return VS + "Could not create shader";
-    }
-
-    if(FAILED(device->CreatePixelShader(m_psBlob->GetBufferPointer(),
-        m_psBlob->GetBufferSize(), 0, &m_ps)))
-    {
-        return PS + "Could not create shader";
-    }
-
-    return std::string();
-}
-
 std::string DxShader::FindShaderDescription(ID3D10Blob* shader, 
                                             ID3D11ShaderReflection** reflection,
                                             D3D11_SHADER_DESC& desc)
@@ -192,19 +394,8 @@ std::string DxShader::FindShaderDescription(ID3D10Blob* shader,
     return std::string();
 }
 
-std::string DxShader::LoadShaderText()
+std::string DxShader::LoadShaderText(const std::string& text)
 {
-    std::ifstream file(m_filepath.c_str(), std::ios::in|std::ios::ate|std::ios::_Nocreate);
-    if(!file.is_open())
-    {
-        return "Could not open file " + m_filepath;
-    }
-
-    // Read all from file directly into a string
-    const int size = static_cast<int>(file.tellg());
-    file.seekg(0, std::ios::beg);
-    std::string text(size, ' ');
-    file.read(&text[0], text.size());
     if(text.empty())
     {
         return m_filepath + " is empty";
@@ -216,6 +407,7 @@ std::string DxShader::LoadShaderText()
     m_vertexText = std::string(text.begin() + vertexIndex, text.begin() + pixelIndex - 1);
     m_pixelText = std::string(text.begin() + pixelIndex, text.end());
     m_sharedText = std::string(text.begin(), text.begin() + vertexIndex - 1);
+    m_textMemory.Set(m_sharedText.capacity() + m_vertexText.capacity() + m_pixelText.capacity());
 
     return std::string();
 }
@@ -490,6 +682,7 @@ std::string DxShader::CreateConstantBuffer(ID3D11Device* device,
     {
         return "Constant buffer " + buffer.name + " creation failed";
     }
+    buffer.memory.Set(bd.ByteWidth);
 
     return std::string();
 }
@@ -539,6 +732,7 @@ void DxShader::SendTexture(ID3D11DeviceContext* context,
 
     context->PSSetShaderResources(slot, 1, view);
     context->PSSetSamplers(slot, 1, state);
+    Metrics::Count(Metrics::TextureBinds);
 }
 
 void DxShader::SendTexture(ID3D11DeviceContext* context, 
@@ -548,6 +742,7 @@ void DxShader::SendTexture(ID3D11DeviceContext* context,
 {
     context->PSSetShaderResources(slot, 1, target.Get(ID));
     context->PSSetSamplers(slot, 1, target.State());
+    Metrics::Count(Metrics::TextureBinds);
 }
 
 void DxShader::SendCopiedTexture(ID3D11DeviceContext* context, 
@@ -557,6 +752,7 @@ void DxShader::SendCopiedTexture(ID3D11DeviceContext* context,
 {
     context->PSSetShaderResources(slot, 1, target.GetCopied(ID));
     context->PSSetSamplers(slot, 1, target.State());
+    Metrics::Count(Metrics::TextureBinds);
 }
 
 void DxShader::ClearTexture(ID3D11DeviceContext* context,
@@ -627,6 +823,7 @@ void DxShader::SendConstants(ID3D11DeviceContext* context)
             cbuffer->updated = false;
             context->UpdateSubresource(cbuffer->buffer, 
                 0, 0, &cbuffer->scratch[0], 0, 0);
+            Metrics::Count(Metrics::UniformSends);
         }
     }
 }
@@ -10,6 +10,8 @@
 
 class Shader;
 class DxRenderTarget;
+class AssetCache;
+class ShaderCompileJob;
 
 /**
 * Holds information for a directx shader
@@ -21,8 +23,9 @@ public:
     /**
     * Constructor
     * @param shader The shader data to create
+    * @param assets The cache of generated shader text
     */
-    DxShader(const Shader& shader);
+    DxShader(const Shader& shader, AssetCache& assets);
 
     /**
     * Destructor
@@ -41,6 +44,24 @@ public:
     */
     std::string CompileShader(ID3D11Device* device);
 
+    /**
+    * Creates a job to recompile the shader from new text
+    * @note the shader in use is kept if recompilation fails
+    * @param device The DirectX device interface
+    * @param text The new text for the shader
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    std::unique_ptr<ShaderCompileJob> CreateCompileJob(ID3D11Device* device,
+                                                       const std::string& text);
+
+    /**
+    * Creates a job to recompile the shader from its regenerated file
+    * @note the shader in use is kept if recompilation fails
+    * @param device The DirectX device interface
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    std::unique_ptr<ShaderCompileJob> CreateReloadJob(ID3D11Device* device);
+
     /**
     * Sets the shader as activated for rendering
     * @param context Direct3D device context
@@ -143,11 +164,24 @@ public:
 private:
 
     /**
-    * Creates the vertex and pixel shaders
+    * Writes and compiles new shader text, or compiles regenerated text, on a
+    * worker thread. Shader objects are created from the blobs on the render thread
+    */
+    class CompileJob;
+
+    /**
+    * Creates the vertex and pixel shaders and swaps them with the shaders in use
+    * @note the shaders in use are kept if creation fails
     * @param device The DirectX device interface interface
+    * @param text The text the blobs were compiled from
+    * @param vsBlob The compiled vertex shader
+    * @param psBlob The compiled pixel shader
     * @return Error message if failed or empty if succeeded
     */
-    std::string CreateShaders(ID3D11Device* device);
+    std::string CreateShaders(ID3D11Device* device,
+                              const std::string& text,
+                              ID3D10Blob* vsBlob,
+                              ID3D10Blob* psBlob);
 
     /**
     * Creates DirectX reflection to obtain information about the compiled shader
@@ -162,11 +196,19 @@ private:
 
     /**
     * Compiles the shader internally in DirectX
-    * @param shader The shader blob to compile into
+    * @note does not use the device so is safe to call from a worker thread
+    * @param filepath The path to the shader file
+    * @param cachePath The path to the cached bytecode
     * @param isVertex Whether this shader is the vertex or pixel shader
+    * @param cacheKey The cache key generated from the shader text and driver
+    * @param shader The shader blob to compile into
     * @return Error message if failed or empty if succeeded
     */
-    std::string CompileShader(ID3D10Blob** shader, bool isVertex);
+    static std::string CompileShader(const std::string& filepath,
+                                     const std::string& cachePath,
+                                     bool isVertex, 
+                                     unsigned long long cacheKey,
+                                     ID3D10Blob** shader);
 
     /**
     * Generates the assembly instructions for the shader if needed
@@ -175,10 +217,11 @@ private:
     std::string GenerateAssembly();
 
     /**
-    * Loads the vertex and pixel shaders into cached strings
+    * Sections the shader text into cached vertex and pixel strings
+    * @param text The text of the shader
     * @return Error message if failed or empty if succeeded
     */
-    std::string LoadShaderText();
+    std::string LoadShaderText(const std::string& text);
 
     /**
     * Determines the vertex shader input attributes and caches them
@@ -265,11 +308,13 @@ private:
         int startSlot;               ///< The register number of the buffer
         bool isVertexBuffer;         ///< Whether this buffer is used by the vertex or pixel shader 
         bool updated;                ///< Whether this buffer was updated last tick
+        MemoryUsage memory;          ///< Bytes held by the buffer object
     };
 
 private:
 
     const Shader& m_shader;                           ///< Shader data and paths
+    AssetCache& m_assets;                             ///< Cache of generated shader text
     D3D11_SHADER_DESC m_vertexDesc;                   ///< Internal description of the vertex shader
     D3D11_SHADER_DESC m_pixelDesc;                    ///< Internal description of the pixel shader
     std::string m_filepath;                           ///< Path to the shader file
@@ -290,4 +335,5 @@ private:
 
     std::vector<ID3D11ShaderResourceView**> m_allocatedSlots;  ///< Textures currently allocated
     std::vector<std::unique_ptr<ConstantBuffer>> m_cbuffers;   ///< Constant buffers for the shader
+    MemoryUsage m_textMemory;                                  ///< Bytes held by the shader text
 };  
@@ -13,6 +13,7 @@ DxRenderTarget::DxRenderTarget(const std::string& name)
     : m_isBackBuffer(true)
     , m_name(name)
     , m_count(1)
+    , m_textureMemory(Memory::GpuTextures)
 {
     InitialiseContainers();
 }
@@ -25,7 +26,8 @@ DxRenderTarget::DxRenderTarget(const std::string& name,
     m_multisampled(multisampled),
     m_name(name),
     m_count(textures),
-    m_readWrite(readWrite)
+    m_readWrite(readWrite),
+    m_textureMemory(Memory::GpuTextures)
 {
     InitialiseContainers();
 }
@@ -87,6 +89,7 @@ void DxRenderTarget::Release()
     }
 
     SafeRelease(&m_depthBuffer);
+    m_textureMemory.Set(0);
 }
 
 bool DxRenderTarget::InitialiseDepthBuffer(ID3D11Device* device)
@@ -120,6 +123,10 @@ bool DxRenderTarget::InitialiseDepthBuffer(ID3D11Device* device)
     SetDebugName(m_depthBuffer, m_name + "DepthBuffer");
     depthTexture->Release();
 
+    const int depthBytes = 4;
+    m_textureMemory.Add(textureDesc.Width * textureDesc.Height *
+        depthBytes * textureDesc.SampleDesc.Count);
+
     return true;
 }
 
@@ -193,6 +200,11 @@ bool DxRenderTarget::InitialiseRenderTarget(ID3D11Device* device, int ID)
     SetDebugName(m_targets[ID], name + "_RenderTarget");
     SetDebugName(m_views[ID], name + "_TextureView");
 
+    const int pixelBytes = m_highQuality[ID] ? 16 : 4;
+    const int textureBytes = textureDesc.Width * textureDesc.Height *
+        pixelBytes * textureDesc.SampleDesc.Count;
+    m_textureMemory.Add(textureBytes);
+
     if (m_readWrite)
     {
         textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
@@ -210,6 +222,7 @@ bool DxRenderTarget::InitialiseRenderTarget(ID3D11Device* device, int ID)
 
         SetDebugName(m_copiedTextures[ID], name + "_CopyTexture");
         SetDebugName(m_copiedViews[ID], name + "_CopyTextureView");
+        m_textureMemory.Add(textureBytes);
     }
 
     return true;
@@ -144,4 +144,5 @@ private:
     ID3D11DepthStencilView* m_depthBuffer = nullptr;      ///< Depth buffer for the render target
     static D3D11_TEXTURE2D_DESC sm_textureDesc;           ///< Base description of the render target textures
     ID3D11SamplerState* m_state = nullptr;                ///< The sampler state for rendering the target
+    MemoryUsage m_textureMemory;                          ///< Bytes held by the textures and depth buffer
 };
@@ -3,12 +3,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 
 #include "directx_texture.h"
+#include "directx_ring_buffer.h"
 #include "logger.h"
 
-#include <boost/filesystem.hpp>
-
-DxTexture::DxTexture(const Texture& texture)
+DxTexture::DxTexture(const Texture& texture, AssetCache& assets)
     : m_texture(texture)
+    , m_assets(assets)
+    , m_textureMemory(Memory::GpuTextures)
 {
 }
 
@@ -20,15 +21,17 @@ DxTexture::~DxTexture()
 void DxTexture::Release()
 {
     SafeRelease(&m_view);
+    m_pixelSize = 0;
+    m_textureMemory.Set(0);
 }
 
-void DxTexture::Initialise(ID3D11Device* device)
+void DxTexture::Initialise(ID3D11Device* device, ID3D11DeviceContext* context)
 {
     if (m_texture.IsRenderable())
     {
         if (m_texture.IsCubeMap())
         {
-            InitialiseCubeMap(device);
+            InitialiseCubeMap(device, context);
         }
         else if (m_texture.HasPixels())
         {
@@ -36,112 +39,185 @@ void DxTexture::Initialise(ID3D11Device* device)
         }
         else
         {
-            InitialiseFromFile(device);
+            InitialiseFromFile(device, context);
         }
 
         SetDebugName(m_view, m_texture.Name() + "_view");
     }
 }
 
-void DxTexture::InitialiseFromFile(ID3D11Device* device)
+void DxTexture::InitialiseFromFile(ID3D11Device* device, ID3D11DeviceContext* context)
 {
-    if(FAILED(D3DX11CreateShaderResourceViewFromFile(device,
-        m_texture.Path().c_str(), 0, 0, &m_view, 0)))
+    const auto image = m_assets.GetImage(m_texture.Path());
+    if (!image || !InitialiseFromImages(device, context, { image }, false))
     {
         Logger::LogError("DirectX: Failed to create texture " + m_texture.Path());
     }
 }
 
-void DxTexture::InitialiseCubeMap(ID3D11Device* device)
+void DxTexture::InitialiseCubeMap(ID3D11Device* device, ID3D11DeviceContext* context)
 {
-    const std::string filePath = m_texture.Path() + ".dds";
-    if (!boost::filesystem::exists(filePath))
+    // Faces are shared with the OpenGL engine in the order +X, -X, +Y, -Y, +Z, -Z
+    const int faces = 6;
+    std::vector<std::shared_ptr<const AssetCache::Image>> images;
+    for (int i = 0; i < faces; ++i)
     {
-        Logger::LogError("DirectX: " + filePath + " doesn't exist");
+        const std::string path(m_texture.Path() + "_c0" + std::to_string(i) + ".png");
+        images.push_back(m_assets.GetImage(path));
+        if (!images.back())
+        {
+            Logger::LogError("DirectX: Failed to create texture " + path);
+            return;
+        }
     }
 
-    D3DX11_IMAGE_LOAD_INFO loadInfo;
-    loadInfo.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+    if (!InitialiseFromImages(device, context, images, true))
+    {
+        Logger::LogError("DirectX: Failed to create cube map " + m_texture.Path());
+    }
+}
 
-    ID3D11Texture2D* texture = nullptr;
-    SetDebugName(texture, filePath + "_texture");
+bool DxTexture::InitialiseFromImages(ID3D11Device* device,
+                                     ID3D11DeviceContext* context,
+                                     const std::vector<std::shared_ptr<const AssetCache::Image>>& images,
+                                     bool cubemap)
+{
+    const bool mipmaps = m_texture.Filtering() != Texture::Nearest;
+    const int channels = 4;
+
+    D3D11_TEXTURE2D_DESC desc;
+    desc.Width = images[0]->width;
+    desc.Height = images[0]->height;
+    desc.MipLevels = mipmaps ? 0 : 1;
+    desc.ArraySize = static_cast<UINT>(images.size());
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.CPUAccessFlags = 0;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE |
+        (mipmaps ? D3D11_BIND_RENDER_TARGET : 0);
+    desc.MiscFlags = (cubemap ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0) |
+        (mipmaps ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0);
 
-    if (FAILED(D3DX11CreateTextureFromFile(device, filePath.c_str(),
-        &loadInfo, 0, (ID3D11Resource**)&texture, 0)))
+    ID3D11Texture2D* texture = nullptr;
+    if (FAILED(device->CreateTexture2D(&desc, 0, &texture)))
     {
-        Logger::LogError("DirectX: Failed to create texture " + filePath);
+        return false;
     }
 
-    D3D11_TEXTURE2D_DESC textureDesc;
-    texture->GetDesc(&textureDesc);
+    texture->GetDesc(&desc);
+    for (unsigned int i = 0; i < images.size(); ++i)
+    {
+        context->UpdateSubresource(texture, D3D11CalcSubresource(0, i, desc.MipLevels),
+            nullptr, &images[i]->pixels[0], images[i]->width * channels, 0);
+    }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
-    viewDesc.Format = textureDesc.Format;
-    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
-    viewDesc.TextureCube.MipLevels = textureDesc.MipLevels;
-    viewDesc.TextureCube.MostDetailedMip = 0;
-
-    if (FAILED(device->CreateShaderResourceView(texture, &viewDesc, &m_view)))
+    viewDesc.Format = desc.Format;
+    if (cubemap)
     {
-        Logger::LogError("DirectX: Failed to resource view " + filePath);
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        viewDesc.TextureCube.MipLevels = desc.MipLevels;
+        viewDesc.TextureCube.MostDetailedMip = 0;
+    }
+    else
+    {
+        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        viewDesc.Texture2D.MipLevels = desc.MipLevels;
+        viewDesc.Texture2D.MostDetailedMip = 0;
     }
 
+    const bool success = SUCCEEDED(device->CreateShaderResourceView(texture, &viewDesc, &m_view));
     texture->Release();
+
+    if (success && mipmaps)
+    {
+        context->GenerateMips(m_view);
+    }
+
+    if (success)
+    {
+        // A full mip chain adds a third to the size of the top level
+        const size_t bytes = desc.Width * desc.Height * channels * desc.ArraySize;
+        m_textureMemory.Set(mipmaps ? bytes * 4 / 3 : bytes);
+    }
+    return success;
 }
 
-bool DxTexture::ReloadPixels(ID3D11Device* device)
+bool DxTexture::ReloadPixels(ID3D11Device* device,
+                             ID3D11DeviceContext* context,
+                             DxRingBuffer& ring)
 {
-    if (m_texture.IsRenderable())
+    if (!m_texture.IsRenderable())
+    {
+        return true;
+    }
+
+    // Textures are only recreated if their size has changed
+    if (!m_view || m_pixelSize != m_texture.Size())
     {
         Release();
+        return InitialiseFromPixels(device);
+    }
 
-        ID3D11Texture2D* texture = nullptr;
-        const int channels = 4;
-        const int size = m_texture.Size();
-
-        D3D11_SUBRESOURCE_DATA data;
-        data.pSysMem = (void*)(&m_texture.Pixels()[0]);
-        data.SysMemPitch = size*channels;
-
-        D3D11_TEXTURE2D_DESC desc;
-        desc.Width = size;
-        desc.Height = size;
-        desc.MipLevels = 1;
-        desc.ArraySize = 1;
-        desc.SampleDesc.Count = 1;
-        desc.SampleDesc.Quality = 0;
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        desc.CPUAccessFlags = 0;
-        desc.MiscFlags = 0;
-
-        if (FAILED(device->CreateTexture2D(&desc, &data, &texture)))
-        {
-            Logger::LogError("DirectX: Failed to create texture from pixels");
-            return false;
-        }
+    ID3D11Resource* resource = nullptr;
+    m_view->GetResource(&resource);
+    const bool success = ring.UploadTexture(context, 
+        static_cast<ID3D11Texture2D*>(resource),
+        m_pixelSize, &m_texture.Pixels()[0]);
 
-        D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
-        viewDesc.Format = desc.Format;
-        viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        viewDesc.TextureCube.MipLevels = 1;
-        viewDesc.TextureCube.MostDetailedMip = 0;
+    resource->Release();
+    return success;
+}
 
-        if (FAILED(device->CreateShaderResourceView(texture, &viewDesc, &m_view)))
-        {
-            Logger::LogError("DirectX: Failed to resource view " + m_texture.Name());
-            return false;
-        }
+bool DxTexture::InitialiseFromPixels(ID3D11Device* device)
+{
+    ID3D11Texture2D* texture = nullptr;
+    const int channels = 4;
+    const int size = m_texture.Size();
+
+    D3D11_SUBRESOURCE_DATA data;
+    data.pSysMem = (void*)(&m_texture.Pixels()[0]);
+    data.SysMemPitch = size*channels;
+
+    D3D11_TEXTURE2D_DESC desc;
+    desc.Width = size;
+    desc.Height = size;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = 0;
+
+    if (FAILED(device->CreateTexture2D(&desc, &data, &texture)))
+    {
+        Logger::LogError("DirectX: Failed to create texture from pixels");
+        return false;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+    viewDesc.Format = desc.Format;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    viewDesc.TextureCube.MipLevels = 1;
+    viewDesc.TextureCube.MostDetailedMip = 0;
+
+    const bool success = SUCCEEDED(device->CreateShaderResourceView(texture, &viewDesc, &m_view));
+    texture->Release();
 
-        texture->Release();
+    if (!success)
+    {
+        Logger::LogError("DirectX: Failed to resource view " + m_texture.Name());
+        return false;
     }
-    return true;
-}
 
-void DxTexture::InitialiseFromPixels(ID3D11Device* device)
-{
-    ReloadPixels(device);
+    m_pixelSize = size;
+    m_textureMemory.Set(size * size * channels);
+    return true;
 }
 
 ID3D11ShaderResourceView** DxTexture::Get()
@@ -5,6 +5,9 @@
 #pragma once
 
 #include "directx_common.h"
+#include "asset_cache.h"
+
+class DxRingBuffer;
 
 /**
 * Holds an individual directx texture
@@ -16,8 +19,9 @@ public:
     /**
     * Constructor
     * @param texture Contains the texture data
+    * @param assets The decoded assets to upload from
     */
-    DxTexture(const Texture& texture);
+    DxTexture(const Texture& texture, AssetCache& assets);
 
     /**
     * Destructor
@@ -32,15 +36,20 @@ public:
     /**
     * Initialises the texture
     * @param device The DirectX device interface
+    * @param context Direct3D device context
     */
-    void Initialise(ID3D11Device* device);
+    void Initialise(ID3D11Device* device, ID3D11DeviceContext* context);
 
     /**
     * Reloads the texture from pixels
     * @param device The DirectX device interface
+    * @param context Direct3D device context
+    * @param ring The ring buffer to stream the pixels through
     * @return whether reloading was successful
     */
-    bool ReloadPixels(ID3D11Device* device);
+    bool ReloadPixels(ID3D11Device* device,
+                      ID3D11DeviceContext* context,
+                      DxRingBuffer& ring);
 
     /**
     * Gets the texture
@@ -62,23 +71,42 @@ private:
     /**
     * Initialises a cube map
     * @param device The DirectX device interface
+    * @param context Direct3D device context
     */
-    void InitialiseCubeMap(ID3D11Device* device);
+    void InitialiseCubeMap(ID3D11Device* device, ID3D11DeviceContext* context);
 
     /**
     * Initialises the texture from file
     * @param device The DirectX device interface
+    * @param context Direct3D device context
+    */
+    void InitialiseFromFile(ID3D11Device* device, ID3D11DeviceContext* context);
+
+    /**
+    * Initialises the texture from decoded images
+    * @param device The DirectX device interface
+    * @param context Direct3D device context
+    * @param images The image for each array slice or cube face
+    * @param cubemap Whether the texture is a cube map
+    * @return whether initialisation was successful
     */
-    void InitialiseFromFile(ID3D11Device* device);
+    bool InitialiseFromImages(ID3D11Device* device,
+                              ID3D11DeviceContext* context,
+                              const std::vector<std::shared_ptr<const AssetCache::Image>>& images,
+                              bool cubemap);
 
     /**
     * Initialises the texture from pixels
     * @param device The DirectX device interface
+    * @return whether initialisation was successful
     */
-    void InitialiseFromPixels(ID3D11Device* device);
+    bool InitialiseFromPixels(ID3D11Device* device);
 
 private:
 
     const Texture& m_texture;  ///< Contains the texture data
+    AssetCache& m_assets;      ///< Decoded assets to upload from
     ID3D11ShaderResourceView* m_view = nullptr; ///< The texture to send to shaders
+    int m_pixelSize = 0;                        ///< Size of the texture created from pixels
+    MemoryUsage m_textureMemory;                ///< Bytes held by the texture and its mipmaps
 };
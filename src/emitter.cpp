@@ -6,6 +6,9 @@
 #include "render_data.h"
 #include "cache.h"
 #include "random_generator.h"
+#include "metrics.h"
+
+#include <algorithm>
 
 namespace
 {
@@ -44,6 +47,8 @@ namespace
 Emitter::Emitter(const std::string& name, int shaderID)
     : m_shaderIndex(shaderID)
     , m_name(name)
+    , m_aliveMetric(Metrics::AddGauge(name + " Particles"))
+    , m_instanceMemory(Memory::Instances)
 {
 }
 
@@ -110,25 +115,35 @@ void Emitter::Read(Cache& cache)
         m_data.minWaitTime, m_data.maxWaitTime);
 }
 
-bool Emitter::Initialise(const EmitterData& data)
+bool Emitter::Initialise(const EmitterData& data, Arena& arena)
 {
     m_data = data;
     m_data.radius = std::max(m_data.length, m_data.width);
     m_instances.resize(data.instances);
+    m_renderInstances.resize(data.instances);
     m_totalParticles = data.instances * data.particles;
 
-    for (Instance& instance : m_instances)
+    // Published instances need their own particles to copy into
+    for (int i = 0; i < data.instances; ++i)
     {
-        instance.particles.resize(data.particles);
+        m_instances[i].particles = ArenaArray<Particle>(arena, data.particles);
+        m_renderInstances[i].particles = ArenaArray<Particle>(arena, data.particles);
     }
 
+    m_instanceMemory.Set((m_instances.capacity() + 
+        m_renderInstances.capacity()) * sizeof(Instance));
+
     return true;
 }
 
-std::string Emitter::GetRenderedInstances() const
+int Emitter::GetVisibleInstances() const
 {
-    return std::to_string(m_visibleInstances) + " / " +
-        std::to_string(m_instances.size());
+    return m_visibleInstances;
+}
+
+int Emitter::GetAliveParticles() const
+{
+    return m_aliveParticles;
 }
 
 const Emitter::Instance& Emitter::GetInstance(int index) const
@@ -181,6 +196,27 @@ const std::vector<Emitter::Instance>& Emitter::Instances() const
     return m_instances;
 }
 
+const std::vector<Emitter::Instance>& Emitter::RenderInstances() const
+{
+    return m_renderInstances;
+}
+
+void Emitter::Publish()
+{
+    for (size_t i = 0; i < m_instances.size(); ++i)
+    {
+        const Instance& instance = m_instances[i];
+        Instance& renderInstance = m_renderInstances[i];
+        renderInstance.render = instance.render;
+        renderInstance.position = instance.position;
+        std::copy(instance.particles.begin(), instance.particles.end(),
+            renderInstance.particles.begin());
+    }
+
+    // Matches the particles rendered rather than the tick in progress
+    Metrics::Set(m_aliveMetric, m_aliveParticles);
+}
+
 bool Emitter::ShouldRender(const Float3& instancePosition,
                            const BoundingArea& bounds)
 {
@@ -198,6 +234,7 @@ void Emitter::Tick(float deltatime,
         return;
     }
 
+    m_aliveParticles = 0;
     m_visibleInstances = 0;
     for (Instance& instance : m_instances)
     {
@@ -228,6 +265,11 @@ void Emitter::Tick(float deltatime,
                                     particlePosition);
     
                 }
+
+                if (particle.Alive())
+                {
+                    ++m_aliveParticles;
+                }
             }
         }
     }
@@ -8,6 +8,8 @@
 #include <string>
 #include "particle.h"
 #include "colour.h"
+#include "memory_usage.h"
+#include "arena.h"
 
 struct Cache;
 struct BoundingArea;
@@ -52,7 +54,7 @@ public:
     */
     struct Instance
     {
-        std::vector<Particle> particles;   ///< Particles this emitter can spawn
+        ArenaArray<Particle> particles;    ///< Particles this emitter can spawn
         bool render = true;                ///< Whether this emitter should be rendered
         Float3 position;                   ///< Position of this emitter
     };
@@ -67,9 +69,10 @@ public:
     /**
     * Initialises the emitter
     * @param data The data to initialise the emitter with
+    * @param arena The scene arena to hold the particles
     * @return whether initialisation succeeded
     */
-    bool Initialise(const EmitterData& data);
+    bool Initialise(const EmitterData& data, Arena& arena);
 
     /**
     * Writes to the data in the cache from the emitter
@@ -138,15 +141,31 @@ public:
     unsigned int InstanceCount() const;
 
     /**
-    * @return a description of what instances are rendered
+    * @return the number of instances rendered
     */
-    std::string GetRenderedInstances() const;
+    int GetVisibleInstances() const;
+
+    /**
+    * @return the number of particles alive over all instances
+    */
+    int GetAliveParticles() const;
 
     /**
     * @return the instances of this emitter
     */
     const std::vector<Instance>& Instances() const;
 
+    /**
+    * @return the instances of this emitter as of the last publish
+    */
+    const std::vector<Instance>& RenderInstances() const;
+
+    /**
+    * Copies the simulated state into the snapshot read by the render engines
+    * @note must not be called while the emitter is ticking or rendering
+    */
+    void Publish();
+
     /**
     * Sets whether the emitter is enabled or not
     */
@@ -167,10 +186,14 @@ private:
     EmitterData m_data;                  ///< Data for this emitter
     std::vector<int> m_textures;         ///< Indexes for the particle textures to use
     std::vector<Instance> m_instances;   ///< All instances of this emitter
+    std::vector<Instance> m_renderInstances; ///< Instances of this emitter as of the last publish
     int m_shaderIndex = -1;              ///< Unique Index of the mesh shader to render with
     int m_totalParticles = 0;            ///< Total amount of particles over all instances
     int m_visibleInstances = 0;          ///< Number of instances currently rendered
+    int m_aliveParticles = 0;            ///< Number of particles alive this tick
     std::string m_name;                  ///< Name of this emitter
+    int m_aliveMetric = -1;              ///< Metric for the particles alive this tick
     bool m_paused = false;               ///< Whether emission is paused
     bool m_enabled = false;              ///< Whether emission is enabled
+    MemoryUsage m_instanceMemory;        ///< Bytes held by the current and published instances
 };
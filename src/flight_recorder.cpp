@@ -0,0 +1,297 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - flight_recorder.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "flight_recorder.h"
+#include "worker_thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <fstream>
+#include <chrono>
+#include <mutex>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+    const float DEFAULT_BUDGET = 50.0f;       ///< Default milliseconds a frame can take
+    const double DUMP_INTERVAL = 5000000.0;   ///< Microseconds to wait before writing again
+    const unsigned int WARMUP_FRAMES = 2;     ///< Frames not checked as they include loading
+
+    /**
+    * @return the name of the event to display
+    */
+    const char* GetEventName(FlightRecorder::Event event)
+    {
+        switch (event)
+        {
+        case FlightRecorder::PatchShift:
+            return "Patch Shift";
+        case FlightRecorder::SceneReload:
+            return "Scene Reload";
+        case FlightRecorder::ShaderRecompile:
+            return "Shader Recompile";
+        case FlightRecorder::EngineSwitch:
+            return "Engine Switch";
+        case FlightRecorder::LongFrame:
+            return "Long Frame";
+        case FlightRecorder::Error:
+            return "Error";
+        default:
+            return "None";
+        }
+    }
+
+    /**
+    * Writes text as a json string
+    */
+    void WriteString(std::ofstream& file, const char* text)
+    {
+        file << '"';
+        for (const char* c = text; *c != '\0'; ++c)
+        {
+            switch (*c)
+            {
+            case '"':
+                file << "\\\"";
+                break;
+            case '\\':
+                file << "\\\\";
+                break;
+            case '\n':
+                file << "\\n";
+                break;
+            case '\r':
+            case '\t':
+                file << ' ';
+                break;
+            default:
+                file << *c;
+            }
+        }
+        file << '"';
+    }
+}
+
+/**
+* Stage times of a recorded frame
+*/
+struct FlightFrame
+{
+    double end = 0.0;                 ///< Microseconds since starting when the frame ended
+    float deltaTime = 0.0f;           ///< Seconds taken by the frame
+    FrameTimes times;                 ///< Stage times of the frame
+};
+
+/**
+* A recorded event
+*/
+struct FlightEvent
+{
+    double time = 0.0;                                  ///< Microseconds since starting
+    FlightRecorder::Event event = FlightRecorder::Events; ///< The type of event
+    char detail[FlightRecorder::DETAIL_SIZE];           ///< Null terminated detail of the event
+};
+
+/**
+* Records copied from the rings to be written to a file
+*/
+struct FlightDump
+{
+    /**
+    * Writes the records as a chrome trace
+    */
+    void Write() const;
+
+    std::string path;                 ///< The file to write to
+    std::string reason;               ///< The cause of writing the file
+    std::vector<FlightFrame> frames;  ///< Frames held, oldest first
+    std::vector<FlightEvent> events;  ///< Events held, oldest first
+};
+
+/**
+* Internal data for the flight recorder
+*/
+struct FlightRecorderData : boost::noncopyable
+{
+    /**
+    * @return the microseconds since starting
+    */
+    double Now() const
+    {
+        return std::chrono::duration<double, std::micro>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    std::mutex mutex;                                          ///< For sole access to the records
+    std::array<FlightFrame, FlightRecorder::FRAMES> frames;    ///< Ring of frames
+    std::array<FlightEvent, FlightRecorder::EVENTS> events;    ///< Ring of events
+    unsigned int frameCount = 0;                               ///< Frames recorded since starting
+    unsigned int eventCount = 0;                               ///< Events recorded since starting
+    double lastDump = -DUMP_INTERVAL;                          ///< Time the last file was written
+    int dumps = 0;                                             ///< Number of files written
+    std::atomic<float> budget { DEFAULT_BUDGET };              ///< Milliseconds a frame can take
+    WorkerThread writer;                                       ///< Writes files off the calling thread
+    const std::chrono::high_resolution_clock::time_point start =
+        std::chrono::high_resolution_clock::now();             ///< Time the recorder started
+};
+
+FlightRecorderData& FlightRecorder::Data()
+{
+    static FlightRecorderData data;
+    return data;
+}
+
+void FlightRecorder::Record(Event event, const char* format, ...)
+{
+    auto& data = Data();
+    const double time = data.Now();
+    std::lock_guard<std::mutex> lock(data.mutex);
+
+    FlightEvent& record = data.events[data.eventCount % EVENTS];
+    record.time = time;
+    record.event = event;
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(record.detail, sizeof(record.detail), format, args);
+    va_end(args);
+
+    ++data.eventCount;
+}
+
+void FlightRecorder::EndFrame(float deltaTime, const FrameTimes& times)
+{
+    auto& data = Data();
+    const double time = data.Now();
+    unsigned int frame = 0;
+    {
+        std::lock_guard<std::mutex> lock(data.mutex);
+        FlightFrame& record = data.frames[data.frameCount % FRAMES];
+        record.end = time;
+        record.deltaTime = deltaTime;
+        record.times = times;
+        frame = data.frameCount++;
+    }
+
+    const float milliseconds = deltaTime * 1000.0f;
+    if (frame >= WARMUP_FRAMES && milliseconds > GetBudget())
+    {
+        Record(LongFrame, "%.2fms", milliseconds);
+
+        std::string path;
+        if (Dump("Long Frame", path))
+        {
+            Logger::LogInfo("FlightRecorder: Frame took %.2fms, writing %s",
+                milliseconds, path.c_str());
+        }
+    }
+}
+
+void FlightRecorder::SetBudget(float budget)
+{
+    Data().budget.store(budget, std::memory_order_relaxed);
+}
+
+float FlightRecorder::GetBudget()
+{
+    return Data().budget.load(std::memory_order_relaxed);
+}
+
+bool FlightRecorder::Dump(const char* reason, std::string& path)
+{
+    auto& data = Data();
+    auto dump = std::make_shared<FlightDump>();
+    dump->reason = reason;
+    {
+        std::lock_guard<std::mutex> lock(data.mutex);
+        const double time = data.Now();
+        if (time - data.lastDump < DUMP_INTERVAL)
+        {
+            return false;
+        }
+        data.lastDump = time;
+        dump->path = "FlightRecord" + std::to_string(data.dumps++ % MAX_DUMPS) + ".json";
+
+        // Copies oldest first so the rings can keep recording while writing
+        const unsigned int frameStart = data.frameCount > FRAMES ? data.frameCount - FRAMES : 0;
+        dump->frames.reserve(data.frameCount - frameStart);
+        for (unsigned int i = frameStart; i != data.frameCount; ++i)
+        {
+            dump->frames.push_back(data.frames[i % FRAMES]);
+        }
+
+        const unsigned int eventStart = data.eventCount > EVENTS ? data.eventCount - EVENTS : 0;
+        dump->events.reserve(data.eventCount - eventStart);
+        for (unsigned int i = eventStart; i != data.eventCount; ++i)
+        {
+            dump->events.push_back(data.events[i % EVENTS]);
+        }
+    }
+
+    path = dump->path;
+    data.writer.Push([dump](){ dump->Write(); });
+    return true;
+}
+
+void FlightDump::Write() const
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    // Times are in microseconds, each frame ends with presenting
+    file << "{\"otherData\":{\"reason\":";
+    WriteString(file, reason.c_str());
+    file << "},\"traceEvents\":[";
+
+    const char* separator = "\n";
+    auto writeStage = [&](const char* name, double start, float duration)
+    {
+        file << separator << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << start << ",\"dur\":" << duration * 1000.0f << "}";
+        separator = ",\n";
+    };
+
+    for (const FlightFrame& frame : frames)
+    {
+        const FrameTimes& times = frame.times;
+        double start = frame.end - (times.simulation + times.submission + times.gpuWait) * 1000.0;
+
+        writeStage("Simulation", start, times.simulation);
+        start += times.simulation * 1000.0;
+        writeStage("Submission", start, times.submission);
+        start += times.submission * 1000.0;
+        writeStage("GPU Wait", start, times.gpuWait);
+
+        file << separator << "{\"name\":\"Frame\",\"ph\":\"C\",\"pid\":1,\"ts\":" << frame.end
+             << ",\"args\":{\"Frame Time\":" << frame.deltaTime * 1000.0f << "}}";
+    }
+
+    for (const FlightEvent& event : events)
+    {
+        file << separator << "{\"name\":\"" << GetEventName(event.event)
+             << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":" << event.time
+             << ",\"args\":{\"detail\":";
+        WriteString(file, event.detail);
+        file << "}}";
+        separator = ",\n";
+    }
+
+    file << "\n]}\n";
+}
+
+void FlightRecorderLogSink::Write(Logger::Level level, const char* message)
+{
+    if (level == Logger::Error)
+    {
+        FlightRecorder::Record(FlightRecorder::Error, "%s", message);
+
+        // Logging the dump from within a sink could block on the logger
+        std::string path;
+        FlightRecorder::Dump("Error", path);
+    }
+}
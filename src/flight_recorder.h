@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - flight_recorder.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "log_sink.h"
+#include "telemetry.h"
+
+struct FlightRecorderData;
+
+/**
+* Always on record of the stage times of the last frames and any notable
+* events. Written to a file when a frame takes longer than the budget
+* or an error is logged to catch stalls too rare to profile
+*/
+class FlightRecorder
+{
+public:
+
+    /**
+    * Notable events recorded between frames
+    */
+    enum Event
+    {
+        PatchShift,
+        SceneReload,
+        ShaderRecompile,
+        EngineSwitch,
+        LongFrame,
+        Error,
+        Events
+    };
+
+    static const int FRAMES = 600;            ///< Number of frames held
+    static const int EVENTS = 128;            ///< Number of events held
+    static const int DETAIL_SIZE = 120;       ///< Longest detail held for an event
+    static const int MAX_DUMPS = 4;           ///< Files written before overwriting the oldest
+
+    /**
+    * Records an event
+    * @param event The type of event
+    * @param format The detail of the event, truncated if too long
+    * @note can be called from any thread
+    */
+    static void Record(Event event, const char* format = "", ...);
+
+    /**
+    * Records the stage times of a frame and writes
+    * the recorder to a file if over the budget
+    * @param deltaTime Seconds taken by the frame
+    * @param times Stage times of the frame
+    * @note only used by the application thread
+    */
+    static void EndFrame(float deltaTime, const FrameTimes& times);
+
+    /**
+    * Sets the milliseconds a frame can take before the recorder is written
+    */
+    static void SetBudget(float budget);
+
+    /**
+    * @return the milliseconds a frame can take before the recorder is written
+    */
+    static float GetBudget();
+
+    /**
+    * Copies the frames and events held and writes them as a chrome trace
+    * on a background thread. Skipped if a file was written too recently
+    * to avoid writing for every frame of a stall or every error of a burst
+    * @param reason The cause of writing the file
+    * @param path Set to the path being written to
+    * @return whether writing the file was started
+    * @note does not log so can be called from a log sink
+    */
+    static bool Dump(const char* reason, std::string& path);
+
+private:
+
+    /**
+    * @return the recorder shared by all threads
+    */
+    static FlightRecorderData& Data();
+};
+
+/**
+* Records any errors logged and writes the flight recorder
+*/
+class FlightRecorderLogSink : public LogSink
+{
+public:
+
+    virtual void Write(Logger::Level level, const char* message) override;
+};
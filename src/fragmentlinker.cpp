@@ -7,258 +7,486 @@
 #include "render_data.h"
 #include "logger.h"
 
+#include <cctype>
 #include <fstream>
+#include <sstream>
+#include <map>
 
-#include <boost/assign.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/regex.hpp>
 
 namespace
 {
     /**
     * Syntax for base shader components
     */
-    const std::string END_OF_FILE("End-of-file");
-    const std::string FAILURE("Failure");
+    const std::string START_OF_FILE("Start-of-file");
     const std::string IF("ifdef: ");
     const std::string ELSE("else:");
     const std::string ELSEIF("elseif: ");
     const std::string ENDIF("endif");
+    const std::vector<std::string> BLOCK_END = { ELSE, ENDIF, ELSEIF };
+    const std::vector<std::string> CONDITIONAL_END = { ENDIF };
+
+    const unsigned int MANIFEST_VERSION = 1;                       ///< Changing regenerates all shaders
+    const unsigned long long FNV_OFFSET = 14695981039346656037ull; ///< FNV-1a 64 bit offset basis
+    const unsigned long long FNV_PRIME = 1099511628211ull;         ///< FNV-1a 64 bit prime
+
+    /**
+    * Continues an FNV-1a hash over the given text
+    */
+    unsigned long long Hash(unsigned long long hash, const std::string& text)
+    {
+        for (const char c : text)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
 }
 
 bool FragmentLinker::GenerateShader(const Shader& shader)
 {
-    m_shaderComponents = shader.GetComponents();
+    const unsigned int components = shader.GetComponents();
     const bool useFragments = shader.GenerateFromFragments();
 
-    return GenerateShader(shader.GLSLVertexBase(), shader.GLSLVertexFile(), useFragments) &&
-        GenerateShader(shader.GLSLFragmentBase(), shader.GLSLFragmentFile(), useFragments) &&
-        GenerateShader(shader.HLSLShaderBase(), shader.HLSLShaderFile(), useFragments);
+    return GenerateShader(shader.GLSLVertexBase(), shader.GLSLVertexFile(), useFragments, components) &&
+        GenerateShader(shader.GLSLFragmentBase(), shader.GLSLFragmentFile(), useFragments, components) &&
+        GenerateShader(shader.HLSLShaderBase(), shader.HLSLShaderFile(), useFragments, components);
 }
 
 bool FragmentLinker::GenerateShader(const std::string& baseFilePath, 
                                     const std::string& generatedFilePath,
-                                    bool generateFromFragments)
+                                    bool generateFromFragments,
+                                    unsigned int components)
 {
-    std::ofstream generatedFile(generatedFilePath.c_str(), 
-        std::ios_base::out|std::ios_base::trunc);
-    
-    if(!generatedFile.is_open())
+    const BaseShader* baseShader = GetBaseShader(baseFilePath);
+    if (!baseShader)
     {
-        Logger::LogError("Could not open " + generatedFilePath);
         return false;
     }
 
-    std::ifstream baseFile(baseFilePath.c_str(), 
-        std::ios_base::in|std::ios_base::_Nocreate);
+    const unsigned long long inputKey = Hash(FNV_OFFSET, 
+        std::to_string(baseShader->key) + " " +
+        std::to_string(m_definesKey) + " " +
+        std::to_string(components) + " " +
+        std::to_string(generateFromFragments));
 
-    if(!baseFile.is_open())
+    if (!RequiresGeneration(generatedFilePath, inputKey))
     {
-        Logger::LogError("Could not open " + baseFilePath);
-        return false;
+        return true;
     }
 
-    std::string previousLine = FAILURE;
+    // Allows the generated shader to start with an empty line
+    std::string previousLine = START_OF_FILE;
+    std::string generated;
 
     if (generateFromFragments)
     {
-        std::vector<std::string> emptyTarget;
-        previousLine = ReadBaseShader(baseFile, generatedFile, 
-            emptyTarget, previousLine, false, 0);
+        EmitNodes(baseShader->nodes, components, 0, previousLine, generated);
     }
     else
     {
-        previousLine = ReadBaseShader(
-            baseFile, generatedFile, previousLine);
+        for (const auto& line : baseShader->lines)
+        {
+            const std::string trimmedLine = boost::trim_copy(line);
+            if (!trimmedLine.empty() || !previousLine.empty())
+            {
+                generated += line;
+                generated += '\n';
+            }
+            previousLine = trimmedLine;
+        }
     }
 
-    generatedFile.close();
-    baseFile.close();
-
-    return previousLine != FAILURE;
+    return WriteShader(generatedFilePath, inputKey, generated);
 }
 
-std::string FragmentLinker::ReadBaseShader(std::ifstream& baseFile,
-                                           std::ofstream& generatedFile,
-                                           std::string& previousLine)
+bool FragmentLinker::RequiresGeneration(const std::string& generatedFilePath,
+                                        unsigned long long inputKey)
 {
-    while(!baseFile.eof())
+    ManifestEntry entry;
     {
-        const std::string line = GetNextLine(baseFile);
-        const std::string trimmedLine = boost::trim_copy(line);
-    
-        if(!trimmedLine.empty() || !previousLine.empty())
+        std::lock_guard<std::mutex> lock(m_manifestMutex);
+        auto itr = m_manifest.find(generatedFilePath);
+        if (itr == m_manifest.end())
         {
-            generatedFile << line << std::endl;
+            return true;
         }
+        entry = itr->second;
+    }
+
+    if (entry.input != inputKey)
+    {
+        return true;
+    }
+
+    // The file may have been edited or removed since it was generated
+    std::ifstream file(generatedFilePath.c_str(), std::ios_base::in);
+    if (!file.is_open())
+    {
+        return true;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return Hash(FNV_OFFSET, stream.str()) != entry.output;
+}
+
+bool FragmentLinker::WriteShader(const std::string& generatedFilePath,
+                                 unsigned long long inputKey,
+                                 const std::string& generated)
+{
+    ManifestEntry entry;
+    entry.input = inputKey;
+    entry.output = Hash(FNV_OFFSET, generated);
+
+    // Leave the file untouched if the regenerated text is the same.
+    // Text mode keeps the platform line endings generated files have always
+    // had and reads them back as the text that was hashed
+    bool requiresWrite = true;
+    std::ifstream existingFile(generatedFilePath.c_str(), std::ios_base::in);
+    if (existingFile.is_open())
+    {
+        std::stringstream stream;
+        stream << existingFile.rdbuf();
+        requiresWrite = stream.str() != generated;
+        existingFile.close();
+    }
+
+    if (requiresWrite)
+    {
+        std::ofstream generatedFile(generatedFilePath.c_str(), 
+            std::ios_base::out|std::ios_base::trunc);
     
-        previousLine = trimmedLine;
-    
-        if(baseFile.fail() || baseFile.bad())
+        if(!generatedFile.is_open())
         {
-            Logger::LogError("Base shader is corrupted");
-            return FAILURE;
+            Logger::LogError("Could not open " + generatedFilePath);
+            return false;
         }
+
+        generatedFile.write(generated.c_str(), generated.size());
+        generatedFile.close();
     }
-    return END_OF_FILE;
+
+    std::lock_guard<std::mutex> lock(m_manifestMutex);
+    ManifestEntry& previous = m_manifest[generatedFilePath];
+    if (previous.input != entry.input || previous.output != entry.output)
+    {
+        previous = entry;
+        m_manifestChanged = true;
+    }
+    return true;
 }
 
-std::string FragmentLinker::ReadBaseShader(std::ifstream& baseFile, 
-                                           std::ofstream& generatedFile, 
-                                           const std::vector<std::string>& targets,
-                                           std::string& previousLine,
-                                           bool skiplines, 
-                                           int level)
+std::string FragmentLinker::ReplaceDefines(const std::string& line) const
 {
-    while(!baseFile.eof())
+    const auto isIdentifier = [](char c)
     {
-        std::string line = GetNextLine(baseFile);
-    
-        // Check for conditional keywords
-        for(const auto& key : targets)
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+
+    std::string replaced;
+    std::string identifier;
+    replaced.reserve(line.size());
+
+    unsigned int index = 0;
+    while (index < line.size())
+    {
+        if (!isIdentifier(line[index]))
         {
-            if(boost::algorithm::icontains(line, key))
-            {
-                // Block has finished once reaching target keyword
-                return line;
-            }
+            replaced += line[index++];
+            continue;
         }
-         
-        // Check if the line contains conditional syntax
-       if(!SolveConditionalLine(level, line, previousLine, baseFile, generatedFile, skiplines))
-       {
-            // If the line only contains whitespace after a previous whitespace line don't add
-             std::string trimmedline = boost::trim_left_copy(line);
-             if (!skiplines && !(previousLine.empty() && trimmedline.empty()))
-             {
-                 // Make sure text is aligned once conditionals are removed
-                 const int spacesInTabs = 4;
-                 const int spaceOffset = targets.empty() ? 0 : spacesInTabs * level;
-                 const int spaceAmount = line.size() - trimmedline.size() - spaceOffset;
-                 const std::string spaces(std::max(0, spaceAmount), ' ');
-                 const std::string extraSpaces(spaceOffset, ' ');
-                 boost::ireplace_all(trimmedline, ":", extraSpaces + ":"); // Ensure semantics align
-                 generatedFile << spaces << trimmedline << std::endl;
-                 previousLine = trimmedline;
-             }
-       }
-    
-        if(boost::algorithm::icontains(line, END_OF_FILE))
+
+        const unsigned int start = index;
+        while (index < line.size() && isIdentifier(line[index]))
         {
-            return END_OF_FILE;
+            ++index;
         }
-        else if(baseFile.fail() || baseFile.bad())
+
+        identifier.assign(line, start, index - start);
+        boost::to_upper(identifier);
+
+        auto itr = m_defines.find(identifier);
+        if (itr != m_defines.end())
         {
-            Logger::LogError("Base shader is corrupted");
-            return FAILURE;
+            replaced += itr->second;
+        }
+        else
+        {
+            replaced.append(line, start, index - start);
         }
     }
-    return END_OF_FILE;
+    return replaced;
 }
 
-bool FragmentLinker::ShouldSkipConditionalBlock(const std::string& conditional, 
-                                                std::string line) const
+void FragmentLinker::LoadManifest()
 {
-    if(conditional != IF && conditional != ELSEIF)
+    m_manifest.clear();
+    m_manifestChanged = false;
+
+    std::ifstream file(Shader::GeneratedManifestFile().c_str(), std::ios_base::in);
+    if (!file.is_open())
     {
-        return false;
+        return;
     }
 
-    std::vector<std::string> components;
-    boost::algorithm::trim(line);
-    boost::erase_head(line, conditional.size());
-    boost::split(components, line, boost::is_any_of("|"));
-
-    auto isComponentSuccessful = [this](std::string component)
+    unsigned int version = 0;
+    file >> version;
+    if (version != MANIFEST_VERSION)
     {
-        const bool required = !boost::icontains(component, "!");
-        boost::ireplace_first(component, "!", "");
-        const auto value = Shader::StringAsComponent(component);
-        const bool found = (m_shaderComponents & value) == value;
-        return (found && required) || (!found && !required);
-    };
+        return;
+    }
 
-    return std::find_if_not(components.begin(), components.end(),
-        isComponentSuccessful) != components.end();
+    std::string path;
+    ManifestEntry entry;
+    while (file >> path >> entry.input >> entry.output)
+    {
+        m_manifest[path] = entry;
+    }
 }
 
-bool FragmentLinker::SolveConditionalLine(int level, 
-                                          std::string line,
-                                          std::string& previousLine,
-                                          std::ifstream& baseFile, 
-                                          std::ofstream& generatedFile, 
-                                          bool skiplines)
+bool FragmentLinker::SaveManifest()
 {
-    if(!boost::algorithm::icontains(line, IF))
+    std::lock_guard<std::mutex> lock(m_manifestMutex);
+    if (!m_manifestChanged)
+    {
+        return true;
+    }
+
+    // Sorted to keep the manifest stable between runs
+    const std::map<std::string, ManifestEntry> sorted(m_manifest.begin(), m_manifest.end());
+
+    std::string manifest = std::to_string(MANIFEST_VERSION) + "\n";
+    for (const auto& entry : sorted)
     {
+        manifest += entry.first + " " + 
+            std::to_string(entry.second.input) + " " + 
+            std::to_string(entry.second.output) + "\n";
+    }
+
+    const std::string path = Shader::GeneratedManifestFile();
+    std::ofstream file(path.c_str(), std::ios_base::out|std::ios_base::trunc);
+    if (!file.is_open())
+    {
+        Logger::LogError("Could not open " + path);
         return false;
     }
 
-    if(skiplines)
+    file.write(manifest.c_str(), manifest.size());
+    m_manifestChanged = false;
+    return file.good();
+}
+
+void FragmentLinker::ReloadBaseShader(const std::string& baseFilePath)
+{
+    std::lock_guard<std::mutex> lock(m_baseShaderMutex);
+    m_baseShaders.erase(baseFilePath);
+}
+
+const FragmentLinker::BaseShader* FragmentLinker::GetBaseShader(const std::string& baseFilePath)
+{
+    // Parsed shaders are never modified so can be read without the lock once returned
+    std::lock_guard<std::mutex> lock(m_baseShaderMutex);
+
+    auto itr = m_baseShaders.find(baseFilePath);
+    if (itr != m_baseShaders.end())
+    {
+        return &itr->second;
+    }
+
+    std::ifstream baseFile(baseFilePath.c_str(), 
+        std::ios_base::in|std::ios_base::_Nocreate);
+
+    if(!baseFile.is_open())
     {
-        ReadBaseShader(baseFile, generatedFile, 
-            boost::assign::list_of(ENDIF), previousLine,
-            skiplines, level+1);
-        return true;
+        Logger::LogError("Could not open " + baseFilePath);
+        return nullptr;
     }
 
-    // Recursively solve ifdefined/ifndefined blocks
-    bool skipConditionalBlock = ShouldSkipConditionalBlock(IF, line);
-    bool solvedConditional = !skipConditionalBlock;
+    std::stringstream stream;
+    stream << baseFile.rdbuf();
+    baseFile.close();
 
-    line = ReadBaseShader(baseFile, generatedFile, 
-        boost::assign::list_of(ELSE)(ENDIF)(ELSEIF), 
-        previousLine, skipConditionalBlock, level+1);
+    BaseShader baseShader;
+    baseShader.key = Hash(FNV_OFFSET, stream.str());
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        // Remove all comments
+        const auto comment = line.find("//");
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
 
-    // Solve elseif blocks
-    while(boost::algorithm::icontains(line, ELSEIF))
+        baseShader.lines.push_back(ReplaceDefines(line));
+    }
+
+    unsigned int index = 0;
+    std::vector<std::string> emptyTarget;
+    ParseNodes(baseShader.lines, index, baseShader.nodes, emptyTarget);
+
+    return &(m_baseShaders[baseFilePath] = std::move(baseShader));
+}
+
+std::string FragmentLinker::ParseNodes(const std::vector<std::string>& lines,
+                                       unsigned int& index,
+                                       std::vector<Node>& nodes,
+                                       const std::vector<std::string>& targets) const
+{
+    while (index < lines.size())
     {
-        skipConditionalBlock = solvedConditional 
-            ? true : ShouldSkipConditionalBlock(ELSEIF, line);
+        const std::string& line = lines[index++];
 
-        solvedConditional = !skipConditionalBlock
-            ? true : solvedConditional;
+        // Check for conditional keywords
+        for(const auto& key : targets)
+        {
+            if(boost::algorithm::icontains(line, key))
+            {
+                // Block has finished once reaching target keyword
+                return line;
+            }
+        }
 
-        line = ReadBaseShader(baseFile, generatedFile, 
-            boost::assign::list_of(ELSE)(ENDIF)(ELSEIF),
-            previousLine, skipConditionalBlock, level+1);
+        if(boost::algorithm::icontains(line, IF))
+        {
+            nodes.push_back(ParseConditional(lines, index, line));
+        }
+        else
+        {
+            Node text;
+            text.type = Node::Text;
+            text.text = line;
+            nodes.push_back(std::move(text));
+        }
     }
+    return std::string();
+}
+
+FragmentLinker::Node FragmentLinker::ParseConditional(const std::vector<std::string>& lines,
+                                                      unsigned int& index,
+                                                      std::string line) const
+{
+    Node conditional;
+    conditional.type = Node::Conditional;
 
-    // Solve else blocks
+    auto addBlock = [&](const std::string& keyword, const std::vector<std::string>& targets)
+    {
+        Node block;
+        block.type = Node::Block;
+        block.requirements = GetRequirements(keyword, line);
+        line = ParseNodes(lines, index, block.children, targets);
+        conditional.children.push_back(std::move(block));
+    };
+
+    addBlock(IF, BLOCK_END);
+
+    while(boost::algorithm::icontains(line, ELSEIF))
+    {
+        addBlock(ELSEIF, BLOCK_END);
+    }
+
+    // Else blocks have no requirements so are used if no other block is
     if(boost::algorithm::icontains(line, ELSE))
     {
-        ReadBaseShader(baseFile, generatedFile, 
-            boost::assign::list_of(ENDIF), 
-            previousLine, solvedConditional, level+1);
+        addBlock(ELSE, CONDITIONAL_END);
     }
 
-    return true;
+    return conditional;
 }
 
-std::string FragmentLinker::GetNextLine(std::ifstream& file) const
+std::vector<FragmentLinker::Requirement> FragmentLinker::GetRequirements(const std::string& conditional,
+                                                                         std::string line) const
 {
-    std::string line;
-    std::getline(file, line);
+    std::vector<Requirement> requirements;
+    if(conditional != IF && conditional != ELSEIF)
+    {
+        return requirements;
+    }
+
+    std::vector<std::string> components;
+    boost::algorithm::trim(line);
+    boost::erase_head(line, conditional.size());
+    boost::split(components, line, boost::is_any_of("|"));
 
-    // Remove all comments
-    if(line.find("//") != -1)
+    for (auto& component : components)
     {
-        line = boost::regex_replace(line, boost::regex("//.*?$"), "");
+        Requirement requirement;
+        requirement.required = !boost::icontains(component, "!");
+        boost::ireplace_first(component, "!", "");
+        requirement.component = Shader::StringAsComponent(component);
+        requirements.push_back(requirement);
     }
+    return requirements;
+}
 
-    // Replace any defined values
-    for(const auto& define : m_defines)
+bool FragmentLinker::ShouldIncludeBlock(const Node& block, unsigned int components) const
+{
+    for (const auto& requirement : block.requirements)
     {
-        boost::ireplace_all(line, define.first, define.second);
+        const auto value = requirement.component;
+        const bool found = (components & value) == value;
+        if (found != requirement.required)
+        {
+            return false;
+        }
     }
+    return true;
+}
+
+void FragmentLinker::EmitNodes(const std::vector<Node>& nodes,
+                               unsigned int components,
+                               int level,
+                               std::string& previousLine,
+                               std::string& generated) const
+{
+    for (const auto& node : nodes)
+    {
+        if (node.type == Node::Conditional)
+        {
+            // Only the first block with successful requirements is used
+            for (const auto& block : node.children)
+            {
+                if (ShouldIncludeBlock(block, components))
+                {
+                    EmitNodes(block.children, components, level + 1, previousLine, generated);
+                    break;
+                }
+            }
+            continue;
+        }
 
-    return line;
+        // If the line only contains whitespace after a previous whitespace line don't add
+        std::string trimmedline = boost::trim_left_copy(node.text);
+        if (!(previousLine.empty() && trimmedline.empty()))
+        {
+            // Make sure text is aligned once conditionals are removed
+            const int spacesInTabs = 4;
+            const int spaceOffset = spacesInTabs * level;
+            const int spaceAmount = node.text.size() - trimmedline.size() - spaceOffset;
+            if (spaceOffset > 0)
+            {
+                const std::string extraSpaces(spaceOffset, ' ');
+                boost::ireplace_all(trimmedline, ":", extraSpaces + ":"); // Ensure semantics align
+            }
+
+            generated.append(std::max(0, spaceAmount), ' ');
+            generated += trimmedline;
+            generated += '\n';
+            previousLine = trimmedline;
+        }
+    }
 }
 
 bool FragmentLinker::Initialise(unsigned int maxWaves, 
                                 unsigned int maxLights, 
                                 const std::vector<float>& blurWeights)
 {
+    // Base shaders are parsed with the defines already replaced
+    m_baseShaders.clear();
+
     m_defines["MAX_LIGHTS"] = std::to_string(maxLights);
     m_defines["MAX_WAVES"] = std::to_string(maxWaves);
     m_defines["SAMPLES"] = std::to_string(MULTISAMPLING_COUNT);
@@ -274,5 +502,14 @@ bool FragmentLinker::Initialise(unsigned int maxWaves,
         m_defines[key] = std::to_string(blurWeights[i]);
     }
 
+    // Sorted as the order of the defines is not guaranteed
+    const std::map<std::string, std::string> sorted(m_defines.begin(), m_defines.end());
+    m_definesKey = FNV_OFFSET;
+    for (const auto& define : sorted)
+    {
+        m_definesKey = Hash(m_definesKey, define.first + "=" + define.second + "\n");
+    }
+
+    LoadManifest();
     return true;
 }
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <mutex>
 #include <unordered_map>
 #include <boost/noncopyable.hpp>
 
@@ -12,6 +14,8 @@ class Shader;
 
 /**
 * Generates a shader from a file replacing any special syntax or defined values
+* Base shaders are parsed once into a tree of conditional blocks that each
+* generated shader is emitted from
 */
 class FragmentLinker : boost::noncopyable
 {
@@ -28,93 +32,196 @@ public:
     * @return Whether initialisation was successful
     */
     bool Initialise(unsigned int maxWaves,
-                    unsigned int maxLights, 
+                    unsigned int maxLights,
                     const std::vector<float>& blurWeights);
 
     /**
     * Generates a new shader
+    * @note safe to call from multiple threads once initialised
     * @param shader The shader information to generate from
     * @return Whether generation was successful
     */
     bool GenerateShader(const Shader& shader);
 
+    /**
+    * Removes the parsed base shader so it is read again on next generation
+    * @note must not be called while shaders are being generated
+    * @param baseFilePath path of the base shader
+    */
+    void ReloadBaseShader(const std::string& baseFilePath);
+
+    /**
+    * Saves the manifest of generated shaders if any were regenerated
+    * @return Whether saving was successful
+    */
+    bool SaveManifest();
+
 private:
 
+    /**
+    * A component a conditional block requires or excludes
+    */
+    struct Requirement
+    {
+        unsigned int component = 0;   ///< The component to check for
+        bool required = true;         ///< Whether the component must exist or not exist
+    };
+
+    /**
+    * Part of a base shader, either a line of text,
+    * a conditional or a single block of a conditional
+    */
+    struct Node
+    {
+        enum Type
+        {
+            Text,
+            Conditional,
+            Block
+        };
+
+        Type type = Text;                       ///< What this node represents
+        std::string text;                       ///< The line if this node is text
+        std::vector<Requirement> requirements;  ///< All must succeed for a block to be used
+        std::vector<Node> children;             ///< Blocks of a conditional or contents of a block
+    };
+
+    /**
+    * A base shader parsed with comments removed and defines replaced
+    */
+    struct BaseShader
+    {
+        std::vector<std::string> lines;  ///< All lines of the base shader
+        std::vector<Node> nodes;         ///< The lines grouped into conditional blocks
+        unsigned long long key = 0;      ///< Hash of the base shader text
+    };
+
+    /**
+    * Hashes of a generated shader when it was last written
+    */
+    struct ManifestEntry
+    {
+        unsigned long long input = 0;    ///< Hash of everything the shader was generated from
+        unsigned long long output = 0;   ///< Hash of the generated text
+    };
+
     /**
     * Generates a new shader
     * @param baseFilePath path of the file to use as a base for generation
     * @param generatedFilePath path of the file to save to once generated
     * @param generateFromFragments Whether to create a new shader based off conditionals
+    * @param components The components of the shader being generated
     * @return Whether generation was successful
     */
-    bool GenerateShader(const std::string& baseFilePath, 
+    bool GenerateShader(const std::string& baseFilePath,
                         const std::string& generatedFilePath,
-                        bool generateFromFragments);
+                        bool generateFromFragments,
+                        unsigned int components);
 
     /**
-    * Reads the base shader until the end of the file
-    * @param baseFile The filestream for the base shader
-    * @param generatedFile The filestream of the shader being created
-    * @param previousLine The line last added to the generated shader
-    * @return the last line read after the target string is found
+    * Gets the parsed base shader, reading the file if not already parsed
+    * @param baseFilePath path of the base shader
+    * @return the parsed base shader or null if it could not be read
     */
-    std::string ReadBaseShader(std::ifstream& baseFile, 
-                               std::ofstream& generatedFile, 
-                               std::string& previousLine);
+    const BaseShader* GetBaseShader(const std::string& baseFilePath);
 
     /**
-    * Reads the base shader until the end of the file
-    * Any components the generated shader requires will be written to it
-    * @note Used recursively when determining component conditionals
-    * @param baseFile The filestream for the base shader
-    * @param generatedFile The filestream of the shader being created
-    * @param targets The target strings to read the base file until
-    * @param previousLine The line last added to the generated shader
-    * @param skiplines Whether to write to the generated file or not
-    * @param level The recursive level this function is on
-    * @return the last line read after the target string is found
+    * Replaces any defined identifiers in the line in a single pass
+    * @note identifiers are matched whole and ignoring case
+    * @param line The line to replace defines in
+    * @return the line with all defines replaced
     */
-    std::string ReadBaseShader(std::ifstream& baseFile, 
-                               std::ofstream& generatedFile, 
-                               const std::vector<std::string>& targets, 
-                               std::string& previousLine, 
-                               bool skiplines, 
-                               int level);
+    std::string ReplaceDefines(const std::string& line) const;
 
     /**
-    * Determines if given line is a conditional and solves it if so
-    * @param level The recursive level ReadBaseShader() is on
-    * @param line The current line read from the base shader
-    * @param previousLine The line last added to the generated shader
-    * @param baseFile The filestream for the base shader
-    * @param generatedFile The filestream of the shader being created
-    * @param skiplines Whether to write to the generated file or not
-    * @return whether the line was a conditional statement or not
+    * Reads the manifest of previously generated shaders
+    */
+    void LoadManifest();
+
+    /**
+    * Determines whether a generated shader is missing or out of date
+    * @param generatedFilePath path of the generated shader
+    * @param inputKey hash of everything the shader is generated from
+    * @return whether the shader needs to be generated
     */
-    bool SolveConditionalLine(int level, 
-                              std::string line, 
-                              std::string& previousLine,
-                              std::ifstream& baseFile,
-                              std::ofstream& generatedFile,
-                              bool skiplines);
+    bool RequiresGeneration(const std::string& generatedFilePath,
+                            unsigned long long inputKey);
+
     /**
-    * Gets the next line from the file, filtering and removing syntax as needed
-    * @param file The shader file to read from
-    * @return the next line from the file
+    * Writes the generated shader only if its text has changed
+    * @param generatedFilePath path of the generated shader
+    * @param inputKey hash of everything the shader is generated from
+    * @param generated the text of the generated shader
+    * @return whether writing was successful
     */
-    std::string GetNextLine(std::ifstream& file) const;
+    bool WriteShader(const std::string& generatedFilePath,
+                     unsigned long long inputKey,
+                     const std::string& generated);
 
     /**
-    * Determines whether the conditional if-else block should be included
+    * Groups lines of the base shader into nodes until reaching a target keyword
+    * @note Used recursively when parsing conditional blocks
+    * @param lines The lines of the base shader
+    * @param index The line to start from, set to the line after the target
+    * @param nodes The nodes to add to
+    * @param targets The target strings to read the base file until
+    * @return the line containing the target or empty if reaching the end
+    */
+    std::string ParseNodes(const std::vector<std::string>& lines,
+                           unsigned int& index,
+                           std::vector<Node>& nodes,
+                           const std::vector<std::string>& targets) const;
+
+    /**
+    * Parses a conditional and all of its blocks
+    * @param lines The lines of the base shader
+    * @param index The line after the conditional, set to the line after its end
+    * @param line The line containing the conditional
+    * @return the node holding each block of the conditional
+    */
+    Node ParseConditional(const std::vector<std::string>& lines,
+                          unsigned int& index,
+                          std::string line) const;
+
+    /**
+    * Determines the components a conditional block requires
     * @param conditional The conditional keyword of the block
     * @param line The line with the conditional keyword
+    * @return the requirements for the block to be included
+    */
+    std::vector<Requirement> GetRequirements(const std::string& conditional,
+                                             std::string line) const;
+
+    /**
+    * Writes any nodes the generated shader requires
+    * @note Used recursively when determining component conditionals
+    * @param nodes The nodes to write
+    * @param components The components of the shader being generated
+    * @param level The nesting level of the nodes
+    * @param previousLine The line last added to the generated shader
+    * @param generated The text of the generated shader
+    */
+    void EmitNodes(const std::vector<Node>& nodes,
+                   unsigned int components,
+                   int level,
+                   std::string& previousLine,
+                   std::string& generated) const;
+
+    /**
+    * Determines whether the conditional block should be included
+    * @param block The block to check
+    * @param components The components of the shader being generated
     * @return whether the block should be included in the generated shader or not
     */
-    bool ShouldSkipConditionalBlock(const std::string& conditional, 
-                                    std::string line) const;
+    bool ShouldIncludeBlock(const Node& block, unsigned int components) const;
 
 private:
 
-    std::unordered_map<std::string, std::string> m_defines; ///< map of #defined items to replace
-    unsigned int m_shaderComponents;                        ///< components of shader undergoing linking
+    std::unordered_map<std::string, std::string> m_defines;     ///< map of upper case #defined items to replace
+    std::unordered_map<std::string, BaseShader> m_baseShaders;  ///< Parsed base shaders by path
+    std::mutex m_baseShaderMutex;                               ///< Guards parsing the base shaders
+    std::unordered_map<std::string, ManifestEntry> m_manifest;  ///< Generated shaders by path
+    std::mutex m_manifestMutex;                                 ///< Guards the manifest
+    unsigned long long m_definesKey = 0;                        ///< Hash of all defined items
+    bool m_manifestChanged = false;                             ///< Whether the manifest requires saving
 };
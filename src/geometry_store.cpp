@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - geometry_store.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "geometry_store.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+GeometryStore::GeometryStore(const std::string& path) :
+    m_path(path),
+    m_file(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)
+{
+}
+
+GeometryStore::~GeometryStore()
+{
+    if (m_file.is_open())
+    {
+        m_file.close();
+        std::remove(m_path.c_str());
+    }
+}
+
+bool GeometryStore::Write(const std::vector<float>& vertices,
+                          const std::vector<unsigned int>& indices,
+                          Entry& entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.is_open())
+    {
+        Logger::LogError("GeometryStore: Could not open " + m_path);
+        return false;
+    }
+
+    // Most meshes have few enough vertices to halve the size of the indices
+    const auto maxIndex = std::max_element(indices.begin(), indices.end());
+    const bool shortIndices = maxIndex == indices.end() || *maxIndex <= UINT16_MAX;
+
+    m_file.clear();
+    m_file.seekp(m_end);
+    m_file.write(reinterpret_cast<const char*>(vertices.data()),
+        sizeof(float) * vertices.size());
+
+    if (shortIndices)
+    {
+        std::vector<uint16_t> shortened(indices.begin(), indices.end());
+        m_file.write(reinterpret_cast<const char*>(shortened.data()),
+            sizeof(uint16_t) * shortened.size());
+    }
+    else
+    {
+        m_file.write(reinterpret_cast<const char*>(indices.data()),
+            sizeof(unsigned int) * indices.size());
+    }
+
+    if (!m_file.good())
+    {
+        Logger::LogError("GeometryStore: Could not write to " + m_path);
+        return false;
+    }
+
+    entry.offset = m_end;
+    entry.vertices = static_cast<unsigned int>(vertices.size());
+    entry.indices = static_cast<unsigned int>(indices.size());
+    entry.shortIndices = shortIndices;
+    m_end = static_cast<long long>(m_file.tellp());
+    return true;
+}
+
+bool GeometryStore::Read(const Entry& entry,
+                         std::vector<float>& vertices,
+                         std::vector<unsigned int>& indices)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (entry.offset < 0)
+    {
+        return false;
+    }
+
+    vertices.resize(entry.vertices);
+    indices.resize(entry.indices);
+
+    m_file.clear();
+    m_file.seekg(entry.offset);
+    m_file.read(reinterpret_cast<char*>(vertices.data()),
+        sizeof(float) * vertices.size());
+
+    if (entry.shortIndices)
+    {
+        std::vector<uint16_t> shortened(entry.indices);
+        m_file.read(reinterpret_cast<char*>(shortened.data()),
+            sizeof(uint16_t) * shortened.size());
+        std::copy(shortened.begin(), shortened.end(), indices.begin());
+    }
+    else
+    {
+        m_file.read(reinterpret_cast<char*>(indices.data()),
+            sizeof(unsigned int) * indices.size());
+    }
+
+    if (!m_file.good())
+    {
+        Logger::LogError("GeometryStore: Could not read from " + m_path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - geometry_store.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+* Compact file owned by the scene holding the geometry of meshes
+* which do not keep it in memory once uploaded to the gpu
+*/
+class GeometryStore : boost::noncopyable
+{
+public:
+
+    /**
+    * Location of geometry within the store
+    */
+    struct Entry
+    {
+        long long offset = -1;          ///< Bytes from the start of the file, -1 if not stored
+        unsigned int vertices = 0;      ///< Number of vertex components
+        unsigned int indices = 0;       ///< Number of indices
+        bool shortIndices = false;      ///< Whether the indices are stored as 16 bits
+    };
+
+    /**
+    * Constructor
+    * @param path The path of the file to write, overwritten if it exists
+    */
+    GeometryStore(const std::string& path);
+
+    /**
+    * Destructor, removes the file
+    */
+    ~GeometryStore();
+
+    /**
+    * Adds geometry to the end of the store
+    * @param vertices The vertex components to store
+    * @param indices The indices to store
+    * @param entry Set to the location of the geometry
+    * @return whether the geometry was written
+    */
+    bool Write(const std::vector<float>& vertices,
+               const std::vector<unsigned int>& indices,
+               Entry& entry);
+
+    /**
+    * Reads geometry from the store
+    * @param entry The location of the geometry
+    * @param vertices Filled with the vertex components
+    * @param indices Filled with the indices
+    * @return whether the geometry was read
+    */
+    bool Read(const Entry& entry,
+              std::vector<float>& vertices,
+              std::vector<unsigned int>& indices);
+
+private:
+
+    std::string m_path;     ///< The path of the file
+    std::fstream m_file;    ///< The file holding the geometry
+    long long m_end = 0;    ///< Bytes written to the file
+    std::mutex m_mutex;     ///< For sole access to the file
+};
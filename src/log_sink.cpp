@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - log_sink.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "log_sink.h"
+#include <iostream>
+#include <Windows.h>
+
+namespace
+{
+    /**
+    * @return the prefix to write before a message of the given severity
+    */
+    const char* GetPrefix(Logger::Level level)
+    {
+        return level == Logger::Error ? "ERROR: \t" : "INFO: \t";
+    }
+}
+
+void ConsoleLogSink::Write(Logger::Level level, const char* message)
+{
+    std::cout << GetPrefix(level) << message << '\n';
+}
+
+void ConsoleLogSink::Flush()
+{
+    std::cout.flush();
+}
+
+void DebuggerLogSink::Write(Logger::Level level, const char* message)
+{
+    OutputDebugStringA(message);
+    OutputDebugStringA("\n");
+}
+
+FileLogSink::FileLogSink(const std::string& path) :
+    m_file(path, std::ios::out | std::ios::trunc)
+{
+}
+
+void FileLogSink::Write(Logger::Level level, const char* message)
+{
+    m_file << GetPrefix(level) << message << '\n';
+}
+
+void FileLogSink::Flush()
+{
+    m_file.flush();
+}
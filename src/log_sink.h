@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - log_sink.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "logger.h"
+
+#include <boost/noncopyable.hpp>
+#include <fstream>
+
+/**
+* Destination for messages drained from the logger
+* @note only called while the logger holds sole access to its sinks
+*/
+class LogSink : boost::noncopyable
+{
+public:
+
+    /**
+    * Destructor
+    */
+    virtual ~LogSink() {}
+
+    /**
+    * Writes a single message
+    * @param level The severity of the message
+    * @param message The message without a trailing newline
+    */
+    virtual void Write(Logger::Level level, const char* message) = 0;
+
+    /**
+    * Flushes any buffered messages, called after each batch is written
+    */
+    virtual void Flush() {}
+};
+
+/**
+* Writes messages to the console
+*/
+class ConsoleLogSink : public LogSink
+{
+public:
+
+    virtual void Write(Logger::Level level, const char* message) override;
+    virtual void Flush() override;
+};
+
+/**
+* Writes messages to the attached debugger
+*/
+class DebuggerLogSink : public LogSink
+{
+public:
+
+    virtual void Write(Logger::Level level, const char* message) override;
+};
+
+/**
+* Writes messages to a file
+*/
+class FileLogSink : public LogSink
+{
+public:
+
+    /**
+    * Constructor
+    * @param path The path of the file to write, overwritten if it exists
+    */
+    FileLogSink(const std::string& path);
+
+    virtual void Write(Logger::Level level, const char* message) override;
+    virtual void Flush() override;
+
+private:
+
+    std::ofstream m_file; ///< The file to write to
+};
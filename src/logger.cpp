@@ -3,52 +3,425 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 
 #include "logger.h"
-#include <iostream>
-#include <Windows.h>
+#include "log_sink.h"
+
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <array>
+#include <vector>
+#include <cstring>
+#include <cstdio>
 
-std::mutex Logger::sm_logMutex;
+/**
+* A message waiting to be written
+*/
+struct LogRecord
+{
+    static const int TEXT_SIZE = 1024;  ///< Longer messages bypass the queue
 
-void Logger::LogInfo(const std::string& info)
+    Logger::Level level = Logger::Info; ///< The severity of the message
+    char text[TEXT_SIZE];               ///< Null terminated message
+};
+
+/**
+* Bounded lock-free queue of messages that any thread may push to or pop from.
+* Each cell holds a sequence number saying whether it is free to push or pop
+*/
+class LogQueue : boost::noncopyable
+{
+public:
+
+    static const unsigned int CAPACITY = 256; ///< Maximum messages waiting, must be a power of two
+
+    /**
+    * Constructor
+    */
+    LogQueue()
+    {
+        for (unsigned int i = 0; i < CAPACITY; ++i)
+        {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+    * Reserves a record and fills it in place
+    * @param fill Called to write the reserved record
+    * @return whether there was room for the message
+    */
+    template <typename Fill> bool Push(Fill fill)
+    {
+        unsigned int position = m_pushPosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = m_cells[position % CAPACITY];
+            const unsigned int sequence = cell.sequence.load(std::memory_order_acquire);
+            const int difference = static_cast<int>(sequence - position);
+
+            if (difference == 0)
+            {
+                if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    fill(cell.record);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_pushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+    * Removes the oldest message
+    * @param record Filled with the message
+    * @return whether there was a message to remove
+    */
+    bool Pop(LogRecord& record)
+    {
+        unsigned int position = m_popPosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell = m_cells[position % CAPACITY];
+            const unsigned int sequence = cell.sequence.load(std::memory_order_acquire);
+            const int difference = static_cast<int>(sequence - (position + 1));
+
+            if (difference == 0)
+            {
+                if (m_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    record = cell.record;
+                    cell.sequence.store(position + CAPACITY, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = m_popPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+    * @return the position after the last message reserved
+    */
+    unsigned int PushPosition() const
+    {
+        return m_pushPosition.load(std::memory_order_acquire);
+    }
+
+    /**
+    * @return whether all messages reserved before the position have been removed
+    */
+    bool PoppedTo(unsigned int position) const
+    {
+        return static_cast<int>(m_popPosition.load(std::memory_order_acquire) - position) >= 0;
+    }
+
+private:
+
+    /**
+    * A record within the ring
+    */
+    struct Cell
+    {
+        std::atomic<unsigned int> sequence { 0 };  ///< Position the cell can next be pushed or popped at
+        LogRecord record;                          ///< The message held
+    };
+
+    std::array<Cell, CAPACITY> m_cells;                ///< Ring of messages
+    std::atomic<unsigned int> m_pushPosition { 0 };    ///< Position of the next message to push
+    std::atomic<unsigned int> m_popPosition { 0 };     ///< Position of the next message to pop
+};
+
+/**
+* Internal data for the logger
+*/
+struct LoggerData : boost::noncopyable
+{
+    /**
+    * Constructor, starts the background thread
+    */
+    LoggerData();
+
+    /**
+    * Destructor, writes any messages left
+    */
+    ~LoggerData();
+
+    /**
+    * Drains the queue until stopped
+    */
+    void Run();
+
+    /**
+    * Stops the background thread and writes any messages left
+    */
+    void Stop();
+
+    /**
+    * Writes all queued messages to the sinks
+    * @note requires sole access to the sinks
+    * @return whether any messages were written
+    */
+    bool Drain();
+
+    /**
+    * Handles the result of pushing a message to the queue. Info is dropped
+    * if the queue is full while errors are never dropped
+    * @param level The severity of the message
+    * @param queued Whether the message was pushed
+    * @return whether the message is handled or must be written now
+    */
+    bool Queued(Logger::Level level, bool queued);
+
+    /**
+    * Writes a message on the calling thread after any queued messages
+    * @param level The severity of the message
+    * @param message The message to write
+    */
+    void WriteNow(Logger::Level level, const char* message);
+
+    /**
+    * Writes a message to all sinks
+    * @note requires sole access to the sinks
+    */
+    void Write(Logger::Level level, const char* message);
+
+    /**
+    * Flushes all sinks
+    * @note requires sole access to the sinks
+    */
+    void FlushSinks();
+
+    LogQueue queue;                              ///< Messages waiting to be written
+    std::atomic<int> dropped { 0 };              ///< Messages dropped as the queue was full
+    std::atomic<bool> running { true };          ///< Whether the background thread is draining
+    std::mutex sinkMutex;                        ///< For getting sole access to the sinks
+    std::vector<std::unique_ptr<LogSink>> sinks; ///< Destinations to write messages to
+    std::mutex wakeMutex;                        ///< For waiting on the wake condition
+    std::condition_variable wake;                ///< Wakes the background thread early
+    std::thread thread;                          ///< Background thread draining the queue
+};
+
+LoggerData::LoggerData()
 {
     #ifdef USE_CONSOLE
-        std::lock_guard<std::mutex> lock(sm_logMutex);
-        std::cout << "INFO: \t" << info << std::endl;
+        sinks.push_back(std::make_unique<ConsoleLogSink>());
     #endif
-        OutputDebugStringA((info + "\n").c_str());
+        sinks.push_back(std::make_unique<DebuggerLogSink>());
+
+    thread = std::thread(&LoggerData::Run, this);
+}
+
+LoggerData::~LoggerData()
+{
+    Stop();
+}
+
+void LoggerData::Run()
+{
+    while (running)
+    {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        if (Drain())
+        {
+            FlushSinks();
+        }
+    }
+}
+
+void LoggerData::Stop()
+{
+    if (thread.joinable())
+    {
+        running = false;
+        wake.notify_one();
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    Drain();
+    FlushSinks();
+}
+
+bool LoggerData::Drain()
+{
+    bool written = false;
+    LogRecord record;
+    while (queue.Pop(record))
+    {
+        Write(record.level, record.text);
+        written = true;
+    }
+
+    const int droppedMessages = dropped.exchange(0);
+    if (droppedMessages > 0)
+    {
+        char message[64];
+        snprintf(message, sizeof(message), "Logger: %d messages dropped", droppedMessages);
+        Write(Logger::Error, message);
+        written = true;
+    }
+    return written;
+}
+
+bool LoggerData::Queued(Logger::Level level, bool queued)
+{
+    if (queued)
+    {
+        wake.notify_one();
+        return true;
+    }
+    else if (level == Logger::Info)
+    {
+        ++dropped;
+        return true;
+    }
+    return false;
+}
+
+void LoggerData::WriteNow(Logger::Level level, const char* message)
+{
+    std::lock_guard<std::mutex> lock(sinkMutex);
+
+    // Waits on messages still being filled by other threads to keep the order
+    const unsigned int position = queue.PushPosition();
+    Drain();
+    while (!queue.PoppedTo(position))
+    {
+        std::this_thread::yield();
+        Drain();
+    }
+
+    Write(level, message);
+    FlushSinks();
+}
+
+void LoggerData::Write(Logger::Level level, const char* message)
+{
+    for (auto& sink : sinks)
+    {
+        sink->Write(level, message);
+    }
+}
+
+void LoggerData::FlushSinks()
+{
+    for (auto& sink : sinks)
+    {
+        sink->Flush();
+    }
+}
+
+LoggerData& Logger::Data()
+{
+    static LoggerData data;
+    return data;
+}
+
+void Logger::Log(Level level, const std::string& message)
+{
+    auto& data = Data();
+    if (data.running && message.size() < LogRecord::TEXT_SIZE)
+    {
+        const bool queued = data.queue.Push([&](LogRecord& record)
+        {
+            record.level = level;
+            memcpy(record.text, message.c_str(), message.size() + 1);
+        });
+
+        if (data.Queued(level, queued))
+        {
+            return;
+        }
+    }
+
+    data.WriteNow(level, message.c_str());
+}
+
+void Logger::Log(Level level, const char* format, va_list args)
+{
+    auto& data = Data();
+    if (data.running)
+    {
+        const bool queued = data.queue.Push([&](LogRecord& record)
+        {
+            record.level = level;
+            vsnprintf(record.text, sizeof(record.text), format, args);
+        });
+
+        if (data.Queued(level, queued))
+        {
+            return;
+        }
+    }
+
+    char buffer[LogRecord::TEXT_SIZE];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    data.WriteNow(level, buffer);
+}
+
+void Logger::LogInfo(const std::string& info)
+{
+    Log(Info, info);
 }
 
 void Logger::LogError(const std::string& error)
 {
-    #ifdef USE_CONSOLE
-        std::lock_guard<std::mutex> lock(sm_logMutex);
-        std::cout << "ERROR: \t" <<  error << std::endl;
-    #endif
-        OutputDebugStringA((error + "\n").c_str());
+    Log(Error, error);
 }
 
 void Logger::LogInfo(const char* info, ...)
 {
-    char buffer[1024];
-    memset(buffer, '\0', sizeof(buffer));
-
     va_list args;
     va_start(args, info);
-    vsnprintf(buffer, sizeof(buffer), info, args);
+    Log(Info, info, args);
     va_end(args);
-
-    LogInfo(std::string(buffer, strlen(buffer)));
 }
 
 void Logger::LogError(const char* error, ...)
 {
-    char buffer[1024];
-    memset(buffer, '\0', sizeof(buffer));
-
     va_list args;
     va_start(args, error);
-    vsnprintf(buffer, sizeof(buffer), error, args);
+    Log(Error, error, args);
     va_end(args);
+}
 
-    LogError(std::string(buffer, strlen(buffer)));
+void Logger::AddSink(std::unique_ptr<LogSink> sink)
+{
+    auto& data = Data();
+    std::lock_guard<std::mutex> lock(data.sinkMutex);
+    data.sinks.push_back(std::move(sink));
+}
+
+void Logger::Flush()
+{
+    auto& data = Data();
+    std::lock_guard<std::mutex> lock(data.sinkMutex);
+    data.Drain();
+    data.FlushSinks();
+}
+
+void Logger::Shutdown()
+{
+    Data().Stop();
 }
@@ -4,12 +4,29 @@
 
 #pragma once
 #include <string>
-#include <mutex>
+#include <memory>
+#include <cstdarg>
 
+class LogSink;
+struct LoggerData;
+
+/**
+* Queues messages from any thread without locking. A background
+* thread drains the queue and writes the messages to each sink
+*/
 class Logger
 {
 public:
 
+    /**
+    * Severity of a message
+    */
+    enum Level
+    {
+        Info,
+        Error
+    };
+
     /**
     * Logs info to the outputstream
     * @param info The information to log
@@ -24,7 +41,36 @@ public:
     static void LogError(const std::string& error);
     static void LogError(const char* error, ...);
 
+    /**
+    * Adds a destination to write all messages to
+    * @param sink The sink to add
+    */
+    static void AddSink(std::unique_ptr<LogSink> sink);
+
+    /**
+    * Writes all queued messages on the calling thread
+    * @note safe to call from crash and failure paths
+    */
+    static void Flush();
+
+    /**
+    * Writes all queued messages and stops the background thread.
+    * Any messages logged afterwards are written on the calling thread
+    */
+    static void Shutdown();
+
 private:
 
-    static std::mutex sm_logMutex; ///< For getting sole access to the console
+    /**
+    * Queues a message
+    * @param level The severity of the message
+    * @param message The message to queue
+    */
+    static void Log(Level level, const std::string& message);
+    static void Log(Level level, const char* format, va_list args);
+
+    /**
+    * @return the queue and sinks shared by all threads
+    */
+    static LoggerData& Data();
 };
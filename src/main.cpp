@@ -6,6 +6,8 @@
 #include "application.h"
 #include "cache.h"
 #include "random_generator.h"
+#include "logger.h"
+#include "flight_recorder.h"
 
 #include "qt/qt_gui.h"
 
@@ -72,6 +74,7 @@ void qtmain(int argc, char *argv[], std::shared_ptr<Cache> cache)
 int main(int argc, char *argv[])
 {
     Random::Initialise();
+    Logger::AddSink(std::make_unique<FlightRecorderLogSink>());
 
     HWND hWnd;
     HINSTANCE hInstance;
@@ -89,13 +92,17 @@ int main(int argc, char *argv[])
         game->Run();
     
         thread.join();
-    
+
+        Logger::Shutdown();
         return EXIT_SUCCESS;
     }
-    
+
+    Logger::Flush();
+
     #ifdef USE_CONSOLE
     std::cin.get(); // pause the console
     #endif
 
+    Logger::Shutdown();
     return EXIT_FAILURE;
 };
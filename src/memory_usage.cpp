@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - memory_usage.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "memory_usage.h"
+#include "logger.h"
+
+#include <boost/noncopyable.hpp>
+#include <fstream>
+#include <atomic>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<unsigned int> allocations { 0 };  ///< Heap allocations made by tracked threads
+    thread_local bool trackAllocations = false;   ///< Whether the calling thread is tracked
+
+    /**
+    * @return the name of the category to display
+    */
+    const char* GetCategoryName(Memory::Category category)
+    {
+        switch (category)
+        {
+        case Memory::MeshVertices:
+            return "Mesh Vertices";
+        case Memory::MeshIndices:
+            return "Mesh Indices";
+        case Memory::Instances:
+            return "Instances";
+        case Memory::TexturePixels:
+            return "Texture Pixels";
+        case Memory::SceneArena:
+            return "Scene Arena";
+        case Memory::Scratch:
+            return "Scratch";
+        case Memory::ShaderText:
+            return "Shader Text";
+        case Memory::GpuBuffers:
+            return "GPU Buffers";
+        case Memory::GpuTextures:
+            return "GPU Textures";
+        default:
+            return "None";
+        }
+    }
+}
+
+/**
+* Internal data for the memory totals
+*/
+struct MemoryData : boost::noncopyable
+{
+    std::array<std::atomic<long long>, Memory::Categories> current; ///< Bytes currently allocated
+    std::array<std::atomic<long long>, Memory::Categories> peak;    ///< Most bytes allocated at once
+};
+
+MemoryData& Memory::Data()
+{
+    static MemoryData data;
+    return data;
+}
+
+void Memory::Add(Category category, long long bytes)
+{
+    if (bytes == 0)
+    {
+        return;
+    }
+
+    auto& data = Data();
+    const long long current = data.current[category].fetch_add(
+        bytes, std::memory_order_relaxed) + bytes;
+
+    long long peak = data.peak[category].load(std::memory_order_relaxed);
+    while (current > peak && !data.peak[category].compare_exchange_weak(
+        peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+long long Memory::GetCurrent(Category category)
+{
+    return Data().current[category].load(std::memory_order_relaxed);
+}
+
+long long Memory::GetPeak(Category category)
+{
+    return Data().peak[category].load(std::memory_order_relaxed);
+}
+
+std::string Memory::GetSummary()
+{
+    const double megabyte = 1024.0 * 1024.0;
+    long long currentTotal = 0;
+    long long peakTotal = 0;
+
+    std::string summary("Memory: Current / Peak MB");
+    char line[128];
+
+    for (int i = 0; i < Categories; ++i)
+    {
+        const auto category = static_cast<Category>(i);
+        const long long current = GetCurrent(category);
+        const long long peak = GetPeak(category);
+        currentTotal += current;
+        peakTotal += peak;
+
+        snprintf(line, sizeof(line), "\n%s: %.2f / %.2f",
+            GetCategoryName(category), current / megabyte, peak / megabyte);
+        summary += line;
+    }
+
+    // The total peak is the sum of the peaks which may not have occurred at once
+    snprintf(line, sizeof(line), "\nTotal: %.2f / %.2f",
+        currentTotal / megabyte, peakTotal / megabyte);
+    summary += line;
+    return summary;
+}
+
+bool Memory::WriteReport(const std::string& path)
+{
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        Logger::LogError("Memory: Could not open " + path);
+        return false;
+    }
+
+    file << "Category,Current Bytes,Peak Bytes\n";
+    for (int i = 0; i < Categories; ++i)
+    {
+        const auto category = static_cast<Category>(i);
+        file << GetCategoryName(category) << ","
+             << GetCurrent(category) << ","
+             << GetPeak(category) << "\n";
+    }
+
+    Logger::LogInfo("Memory: Report written to " + path);
+    return true;
+}
+
+void Memory::TrackAllocations()
+{
+    trackAllocations = true;
+}
+
+unsigned int Memory::GetAllocations()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void Memory::CountAllocation()
+{
+    if (trackAllocations)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* operator new(size_t size)
+{
+    Memory::CountAllocation();
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+MemoryUsage::MemoryUsage(Memory::Category category) :
+    m_category(category)
+{
+}
+
+MemoryUsage::MemoryUsage(const MemoryUsage& usage) :
+    m_category(usage.m_category)
+{
+    Set(usage.m_bytes);
+}
+
+MemoryUsage& MemoryUsage::operator=(const MemoryUsage& usage)
+{
+    if (this != &usage)
+    {
+        Set(0);
+        m_category = usage.m_category;
+        Set(usage.m_bytes);
+    }
+    return *this;
+}
+
+MemoryUsage::~MemoryUsage()
+{
+    Set(0);
+}
+
+void MemoryUsage::Set(size_t bytes)
+{
+    if (bytes != m_bytes)
+    {
+        Memory::Add(m_category, static_cast<long long>(bytes) - static_cast<long long>(m_bytes));
+        m_bytes = bytes;
+    }
+}
+
+void MemoryUsage::Add(size_t bytes)
+{
+    Set(m_bytes + bytes);
+}
+
+size_t MemoryUsage::Bytes() const
+{
+    return m_bytes;
+}
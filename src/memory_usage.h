@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - memory_usage.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <string>
+
+struct MemoryData;
+
+/**
+* Bytes allocated by each subsystem on the CPU and GPU. Totals are
+* updated without locking so can be changed from any thread
+*/
+class Memory
+{
+public:
+
+    /**
+    * Subsystems which allocations are accounted to
+    */
+    enum Category
+    {
+        MeshVertices,
+        MeshIndices,
+        Instances,
+        TexturePixels,
+        SceneArena,
+        Scratch,
+        ShaderText,
+        GpuBuffers,
+        GpuTextures,
+        Categories
+    };
+
+    /**
+    * Adds to the bytes allocated for a subsystem
+    * @param category The subsystem allocated for
+    * @param bytes The amount allocated, negative if freed
+    */
+    static void Add(Category category, long long bytes);
+
+    /**
+    * @return the bytes currently allocated for a subsystem
+    */
+    static long long GetCurrent(Category category);
+
+    /**
+    * @return the most bytes allocated at once for a subsystem
+    */
+    static long long GetPeak(Category category);
+
+    /**
+    * @return the current and peak megabytes for each subsystem
+    */
+    static std::string GetSummary();
+
+    /**
+    * Writes the current and peak bytes for each subsystem
+    * @param path The path to write to
+    * @return whether the file could be written
+    */
+    static bool WriteReport(const std::string& path);
+
+    /**
+    * Counts heap allocations made by the calling thread from now on
+    */
+    static void TrackAllocations();
+
+    /**
+    * @return the heap allocations made by all tracked threads
+    */
+    static unsigned int GetAllocations();
+
+    /**
+    * Counts a heap allocation if the calling thread is tracked
+    * @note called by the global operator new
+    */
+    static void CountAllocation();
+
+private:
+
+    /**
+    * @return the totals shared by all threads
+    */
+    static MemoryData& Data();
+};
+
+/**
+* Bytes held by a single owner, accounted to a subsystem
+* until changed or the owner is destroyed
+*/
+class MemoryUsage
+{
+public:
+
+    /**
+    * Constructor
+    * @param category The subsystem to account to
+    */
+    explicit MemoryUsage(Memory::Category category);
+
+    /**
+    * Copy constructor, accounts for the copied bytes
+    */
+    MemoryUsage(const MemoryUsage& usage);
+
+    /**
+    * Assignment operator, accounts for the copied bytes
+    */
+    MemoryUsage& operator=(const MemoryUsage& usage);
+
+    /**
+    * Destructor, releases the bytes held
+    */
+    ~MemoryUsage();
+
+    /**
+    * Sets the bytes held
+    * @param bytes The amount now held
+    */
+    void Set(size_t bytes);
+
+    /**
+    * Adds to the bytes held
+    * @param bytes The amount allocated
+    */
+    void Add(size_t bytes);
+
+    /**
+    * @return the bytes held
+    */
+    size_t Bytes() const;
+
+private:
+
+    Memory::Category m_category;  ///< The subsystem to account to
+    size_t m_bytes = 0;           ///< The bytes currently held
+};
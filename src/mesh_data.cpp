@@ -7,6 +7,7 @@
 #include "random_generator.h"
 #include "logger.h"
 #include "utils.h"
+#include "metrics.h"
 
 MeshData::MeshData(const std::string& name, 
                    const std::string& shaderName,
@@ -14,6 +15,11 @@ MeshData::MeshData(const std::string& name,
     : m_name(name)
     , m_shaderName(shaderName)
     , m_shaderIndex(shaderID)
+    , m_visibleMetric(Metrics::AddGauge(name + " Visible"))
+    , m_culledMetric(Metrics::AddGauge(name + " Culled"))
+    , m_vertexMemory(Memory::MeshVertices)
+    , m_indexMemory(Memory::MeshIndices)
+    , m_instanceMemory(Memory::Instances)
 {
     m_textureIDs.resize(TextureSlot::Max);
     m_textureIDs.assign(TextureSlot::Max, -1);
@@ -74,6 +80,50 @@ bool MeshData::BackfaceCull() const
     return m_backfacecull;
 }
 
+void MeshData::ReleaseGeometry(GeometryStore& store)
+{
+    if (!m_resident || m_vertices.empty())
+    {
+        return;
+    }
+
+    // Geometry is never edited once released so is only stored once
+    if (m_stored.offset < 0 && !store.Write(m_vertices, m_indices, m_stored))
+    {
+        return;
+    }
+
+    std::vector<float>().swap(m_vertices);
+    std::vector<unsigned int>().swap(m_indices);
+    m_vertexMemory.Set(0);
+    m_indexMemory.Set(0);
+    m_resident = false;
+}
+
+bool MeshData::FetchGeometry(GeometryStore& store)
+{
+    if (m_resident)
+    {
+        return true;
+    }
+
+    if (!store.Read(m_stored, m_vertices, m_indices))
+    {
+        Logger::LogError("Mesh: " + m_name + " Failed to fetch geometry");
+        return false;
+    }
+
+    m_vertexMemory.Set(m_vertices.capacity() * sizeof(float));
+    m_indexMemory.Set(m_indices.capacity() * sizeof(unsigned int));
+    m_resident = true;
+    return true;
+}
+
+bool MeshData::IsGeometryResident() const
+{
+    return m_resident;
+}
+
 const std::vector<float>& MeshData::Vertices() const
 {
     return m_vertices;
@@ -136,6 +186,31 @@ bool MeshData::ShouldRender(const Instance& instance,
     return centerToMesh.Length() <= (m_radius * scale) + bounds.radius;
 }
 
+void MeshData::Publish()
+{
+    m_renderInstances = m_instances;
+    m_renderTextureIDs = m_textureIDs;
+
+    m_vertexMemory.Set(m_vertices.capacity() * sizeof(float));
+    m_indexMemory.Set(m_indices.capacity() * sizeof(unsigned int));
+    m_instanceMemory.Set((m_instances.capacity() + 
+        m_renderInstances.capacity()) * sizeof(Instance));
+
+    // Set with the snapshot so each exported frame holds a single tick
+    Metrics::Set(m_visibleMetric, m_visibleInstances);
+    Metrics::Set(m_culledMetric, m_culledInstances);
+}
+
+const std::vector<MeshData::Instance>& MeshData::RenderInstances() const
+{
+    return m_renderInstances;
+}
+
+const std::vector<int>& MeshData::RenderTextureIDs() const
+{
+    return m_renderTextureIDs;
+}
+
 void MeshData::PostTick()
 {
     for (auto& instance : m_instances)
@@ -153,6 +228,7 @@ void MeshData::Tick(const Float3& cameraPosition,
         SetTexture(TextureSlot::Caustics, causticsTexture);
     }
    
+    m_culledInstances = 0;
     m_visibleInstances = 0;
     for (auto& instance : m_instances)
     {
@@ -170,6 +246,10 @@ void MeshData::Tick(const Float3& cameraPosition,
             {
                 ++m_visibleInstances;
             }
+            else
+            {
+                ++m_culledInstances;
+            }
 
             UpdateTransforms(instance);
         }
@@ -181,10 +261,9 @@ bool MeshData::UsesCaustics() const
     return m_textureIDs[TextureSlot::Caustics] != -1;
 }
 
-std::string MeshData::GetRenderedInstances() const
+int MeshData::GetVisibleInstances() const
 {
-    return std::to_string(m_visibleInstances) + " / " +
-        std::to_string(m_instances.size());
+    return m_visibleInstances;
 }
 
 void MeshData::AddInstances(int amount)
@@ -7,6 +7,8 @@
 #include "float3.h"
 #include "matrix.h"
 #include "render_data.h"
+#include "memory_usage.h"
+#include "geometry_store.h"
 
 #include <boost/noncopyable.hpp>
 
@@ -68,6 +70,12 @@ public:
     */
     void PostTick();
 
+    /**
+    * Copies the simulated state into the snapshot read by the render engines
+    * @note must not be called while the mesh is ticking or rendering
+    */
+    void Publish();
+
     /**
     * Initialises the mesh data
     */
@@ -98,8 +106,28 @@ public:
     */
     void BackfaceCull(bool value);
 
+    /**
+    * Drops the vertices and indices from memory, keeping them in the store
+    * @param store The store to keep the geometry in
+    * @note render engines must hold their own copy of the geometry
+    */
+    void ReleaseGeometry(GeometryStore& store);
+
+    /**
+    * Reads the vertices and indices back into memory if released
+    * @param store The store the geometry is kept in
+    * @return whether the geometry is in memory
+    */
+    bool FetchGeometry(GeometryStore& store);
+
+    /**
+    * @return whether the vertices and indices are held in memory
+    */
+    bool IsGeometryResident() const;
+
     /**
     * @return The vertices constructing this mesh
+    * @note empty if the geometry has been released
     */
     const std::vector<float>& Vertices() const;
 
@@ -131,9 +159,9 @@ public:
     void SetTexture(TextureSlot::Slot slot, int ID);
 
     /**
-    * @return a description of what instances are rendered
+    * @return the number of instances rendered
     */
-    std::string GetRenderedInstances() const;
+    int GetVisibleInstances() const;
 
     /**
     * @return The instances of this mesh
@@ -145,6 +173,16 @@ public:
     */
     const std::vector<Instance>& Instances() const;
 
+    /**
+    * @return The instances of this mesh as of the last publish
+    */
+    const std::vector<Instance>& RenderInstances() const;
+
+    /**
+    * @return IDs for each texture used as of the last publish
+    */
+    const std::vector<int>& RenderTextureIDs() const;
+
     /**
     * Gets the instance at the index
     * @param index The index of the instance to get
@@ -186,6 +224,7 @@ protected:
     std::vector<float> m_vertices;           ///< The vertices constructing this mesh
     std::vector<unsigned int> m_indices;     ///< The indices constructing this mesh
     std::vector<Instance> m_instances;       ///< Current instances of this mesh
+    std::vector<Instance> m_renderInstances; ///< Instances of this mesh as of the last publish
     int m_vertexComponentCount = 0;          ///< Number of components that make up a vertex
 
 private:
@@ -217,9 +256,18 @@ private:
     int m_shaderIndex = -1;           ///< Unique Index of the mesh shader to use
     std::string m_shaderName;         ///< The name of the shader to render with
     std::vector<int> m_textureIDs;    ///< IDs for each texture used
+    std::vector<int> m_renderTextureIDs; ///< IDs for each texture used as of the last publish
     std::vector<int> m_colourIDs;     ///< Possible colour texture for instances
     int m_visibleInstances = 0;       ///< Number of instances visible this tick
+    int m_culledInstances = 0;        ///< Number of instances culled this tick
+    int m_visibleMetric = -1;         ///< Metric for the instances visible this tick
+    int m_culledMetric = -1;          ///< Metric for the instances culled this tick
     int m_initialInstances = 0;       ///< The number of instances on load
     bool m_skybox = false;            ///< Whether this mesh is a skybox
     float m_radius = 0.0f;            ///< The radius of the sphere surrounding the mesh
+    MemoryUsage m_vertexMemory;       ///< Bytes held by the vertices
+    MemoryUsage m_indexMemory;        ///< Bytes held by the indices
+    GeometryStore::Entry m_stored;    ///< Location of the geometry in the store
+    bool m_resident = true;           ///< Whether the geometry is held in memory
+    MemoryUsage m_instanceMemory;     ///< Bytes held by the current and published instances
 };
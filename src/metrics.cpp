@@ -0,0 +1,310 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - metrics.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "metrics.h"
+#include "logger.h"
+
+#include <boost/noncopyable.hpp>
+#include <boost/algorithm/string.hpp>
+#include <fstream>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+    /**
+    * @return the name of the pass to display
+    */
+    const char* GetPassName(Metrics::Pass pass)
+    {
+        switch (pass)
+        {
+        case Metrics::Scene:
+            return "Scene";
+        case Metrics::PreEffects:
+            return "Pre Effects";
+        case Metrics::Blur:
+            return "Blur";
+        case Metrics::Post:
+            return "Post";
+        default:
+            return "None";
+        }
+    }
+
+    /**
+    * @return the name of the counter to display
+    */
+    const char* GetCounterName(Metrics::Counter counter)
+    {
+        switch (counter)
+        {
+        case Metrics::DrawCalls:
+            return "Draw Calls";
+        case Metrics::ShaderSwitches:
+            return "Shader Switches";
+        case Metrics::TextureBinds:
+            return "Texture Binds";
+        case Metrics::UniformSends:
+            return "Uniform Sends";
+        default:
+            return "None";
+        }
+    }
+
+    /**
+    * @return the ID of a counter for a pass
+    */
+    int GetPassCounterID(int pass, int counter)
+    {
+        return (pass * Metrics::Counters) + counter;
+    }
+}
+
+/**
+* A named counter or gauge
+*/
+struct MetricsEntry
+{
+    std::string name;                  ///< Unique name of the value
+    bool counter = false;              ///< Whether the value is reset each frame
+    std::atomic<int> value { 0 };      ///< The value currently being recorded
+    int frame = 0;                     ///< The value recorded for the last frame
+};
+
+/**
+* A file each frame is written to
+*/
+struct MetricsExport
+{
+    std::ofstream file;                ///< The file to write to
+    bool json = false;                 ///< Whether to write json or csv
+    int columns = 0;                   ///< Number of values written as csv
+    bool empty = true;                 ///< Whether no frames have been written yet
+};
+
+/**
+* Internal data for the metrics
+*/
+struct MetricsData : boost::noncopyable
+{
+    static const int CAPACITY = 512;   ///< Maximum counters and gauges
+
+    /**
+    * Constructor, adds the counters for each pass
+    */
+    MetricsData();
+
+    std::array<MetricsEntry, CAPACITY> entries;          ///< All counters and gauges
+    std::atomic<int> count { 0 };                        ///< Number of entries added
+    std::atomic<int> pass { Metrics::Scene };            ///< The pass calls are counted for
+    std::mutex addMutex;                                 ///< For adding entries from any thread
+    std::vector<std::unique_ptr<MetricsExport>> exports; ///< Files each frame is written to
+    int frame = 0;                                       ///< Number of frames recorded
+};
+
+MetricsData::MetricsData()
+{
+    for (int pass = 0; pass < Metrics::Passes; ++pass)
+    {
+        for (int counter = 0; counter < Metrics::Counters; ++counter)
+        {
+            auto& entry = entries[GetPassCounterID(pass, counter)];
+            entry.name = std::string(GetPassName(static_cast<Metrics::Pass>(pass))) + " " +
+                GetCounterName(static_cast<Metrics::Counter>(counter));
+            entry.counter = true;
+        }
+    }
+    count = Metrics::Passes * Metrics::Counters;
+}
+
+MetricsData& Metrics::Data()
+{
+    static MetricsData data;
+    return data;
+}
+
+int Metrics::AddCounter(const std::string& name)
+{
+    return Register(name, true);
+}
+
+int Metrics::AddGauge(const std::string& name)
+{
+    return Register(name, false);
+}
+
+int Metrics::Register(const std::string& name, bool counter)
+{
+    auto& data = Data();
+    std::lock_guard<std::mutex> lock(data.addMutex);
+
+    const int count = data.count.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i)
+    {
+        if (data.entries[i].name == name)
+        {
+            return i;
+        }
+    }
+
+    if (count == MetricsData::CAPACITY)
+    {
+        Logger::LogError("Metrics: Could not add " + name);
+        return -1;
+    }
+
+    data.entries[count].name = name;
+    data.entries[count].counter = counter;
+    data.count.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void Metrics::Add(int ID, int amount)
+{
+    if (ID >= 0)
+    {
+        Data().entries[ID].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::Set(int ID, int value)
+{
+    if (ID >= 0)
+    {
+        Data().entries[ID].value.store(value, std::memory_order_relaxed);
+    }
+}
+
+int Metrics::Get(int ID)
+{
+    return ID >= 0 ? Data().entries[ID].frame : 0;
+}
+
+void Metrics::SetPass(Pass pass)
+{
+    Data().pass.store(pass, std::memory_order_relaxed);
+}
+
+void Metrics::Count(Counter counter, int amount)
+{
+    auto& data = Data();
+    const int pass = data.pass.load(std::memory_order_relaxed);
+    data.entries[GetPassCounterID(pass, counter)].value.fetch_add(
+        amount, std::memory_order_relaxed);
+}
+
+void Metrics::EndFrame()
+{
+    auto& data = Data();
+    const int count = data.count.load(std::memory_order_acquire);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto& entry = data.entries[i];
+        entry.frame = entry.counter ?
+            entry.value.exchange(0, std::memory_order_relaxed) :
+            entry.value.load(std::memory_order_relaxed);
+    }
+
+    for (auto& output : data.exports)
+    {
+        if (output->json)
+        {
+            output->file << (output->empty ? "\n" : ",\n") << "{\"Frame\":" << data.frame;
+            for (int i = 0; i < count; ++i)
+            {
+                output->file << ",\"" << data.entries[i].name << "\":" << data.entries[i].frame;
+            }
+            output->file << "}";
+        }
+        else
+        {
+            output->file << data.frame;
+            for (int i = 0; i < output->columns; ++i)
+            {
+                output->file << "," << data.entries[i].frame;
+            }
+            output->file << "\n";
+        }
+        output->empty = false;
+    }
+
+    ++data.frame;
+}
+
+std::string Metrics::GetPassSummary()
+{
+    auto& data = Data();
+    std::string summary("Pass Calls: Draw / Shader / Texture / Uniform");
+
+    for (int pass = 0; pass < Passes; ++pass)
+    {
+        summary += "\n";
+        summary += GetPassName(static_cast<Pass>(pass));
+        summary += ": ";
+
+        for (int counter = 0; counter < Counters; ++counter)
+        {
+            summary += counter == 0 ? "" : " / ";
+            summary += std::to_string(data.entries[GetPassCounterID(pass, counter)].frame);
+        }
+    }
+    return summary;
+}
+
+bool Metrics::StartExport(const std::string& path)
+{
+    auto output = std::make_unique<MetricsExport>();
+    output->file.open(path, std::ios::out | std::ios::trunc);
+    if (!output->file.is_open())
+    {
+        Logger::LogError("Metrics: Could not open " + path);
+        return false;
+    }
+
+    auto& data = Data();
+    output->json = boost::iends_with(path, ".json");
+    output->columns = data.count.load(std::memory_order_acquire);
+
+    if (output->json)
+    {
+        output->file << "[";
+    }
+    else
+    {
+        // Names must not contain commas, any added later are not written
+        output->file << "Frame";
+        for (int i = 0; i < output->columns; ++i)
+        {
+            output->file << "," << data.entries[i].name;
+        }
+        output->file << "\n";
+    }
+
+    Logger::LogInfo("Metrics: Exporting to " + path);
+    data.exports.push_back(std::move(output));
+    return true;
+}
+
+void Metrics::StopExport()
+{
+    auto& data = Data();
+    for (auto& output : data.exports)
+    {
+        if (output->json)
+        {
+            output->file << "\n]\n";
+        }
+    }
+    data.exports.clear();
+}
+
+bool Metrics::IsExporting()
+{
+    return !Data().exports.empty();
+}
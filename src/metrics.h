@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - metrics.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <string>
+
+struct MetricsData;
+
+/**
+* Registry of named counters and gauges recorded each frame. Counters are
+* summed and reset each frame while gauges keep the last value set. Values
+* are updated without locking so can be called from hot code on any thread
+*/
+class Metrics
+{
+public:
+
+    /**
+    * Render passes which count their calls separately
+    */
+    enum Pass
+    {
+        Scene,
+        PreEffects,
+        Blur,
+        Post,
+        Passes
+    };
+
+    /**
+    * Calls counted for each render pass
+    */
+    enum Counter
+    {
+        DrawCalls,
+        ShaderSwitches,
+        TextureBinds,
+        UniformSends,
+        Counters
+    };
+
+    /**
+    * Adds a value summed and reset each frame
+    * @param name The unique name of the counter
+    * @return the ID of the counter or the existing ID if already added
+    */
+    static int AddCounter(const std::string& name);
+
+    /**
+    * Adds a value which keeps the last value set
+    * @param name The unique name of the gauge
+    * @return the ID of the gauge or the existing ID if already added
+    */
+    static int AddGauge(const std::string& name);
+
+    /**
+    * Adds to the value of a counter or gauge
+    * @param ID The ID of the counter or gauge
+    * @param amount The amount to add
+    */
+    static void Add(int ID, int amount = 1);
+
+    /**
+    * Sets the value of a counter or gauge
+    * @param ID The ID of the counter or gauge
+    * @param value The value to set
+    */
+    static void Set(int ID, int value);
+
+    /**
+    * @param ID The ID of the counter or gauge
+    * @return the value recorded for the last frame
+    * @note only used by the application thread
+    */
+    static int Get(int ID);
+
+    /**
+    * Sets the render pass any calls are counted for
+    * @param pass The pass being rendered
+    */
+    static void SetPass(Pass pass);
+
+    /**
+    * Adds to a call counted for the current render pass
+    * @param counter The call to add to
+    * @param amount The amount to add
+    */
+    static void Count(Counter counter, int amount = 1);
+
+    /**
+    * Records the values for the frame, resets all counters
+    * and writes the frame to any exported files
+    * @note the frame and exports are only used by the application thread
+    */
+    static void EndFrame();
+
+    /**
+    * @return the calls counted for each pass during the last frame
+    */
+    static std::string GetPassSummary();
+
+    /**
+    * Starts writing each frame to a file
+    * @param path The path to write to, a .json extension writes json otherwise csv
+    * @return whether the file could be opened
+    */
+    static bool StartExport(const std::string& path);
+
+    /**
+    * Stops writing to all exported files
+    */
+    static void StopExport();
+
+    /**
+    * @return whether any frames are being exported
+    */
+    static bool IsExporting();
+
+private:
+
+    /**
+    * Adds a counter or gauge
+    * @param name The unique name of the value
+    * @param counter Whether the value is reset each frame
+    * @return the ID of the value
+    */
+    static int Register(const std::string& name, bool counter);
+
+    /**
+    * @return the values shared by all threads
+    */
+    static MetricsData& Data();
+};
@@ -23,6 +23,7 @@
 #include "terrain.h"
 #include "light.h"
 #include "logger.h"
+#include "memory_usage.h"
 
 /**
 * Callbacks for pre-rendering elements
@@ -28,7 +28,7 @@ void GlEmitter::Render(const glm::vec3& cameraPosition,
 {
     glm::mat4 scale, rotate, translate;
 
-    for (const auto& instance : m_emitter.Instances())
+    for (const auto& instance : m_emitter.RenderInstances())
     {
         if (instance.render)
         {
@@ -9,13 +9,16 @@
 #include "opengl_texture.h"
 #include "opengl_target.h"
 #include "opengl_emitter.h"
+#include "opengl_ring_buffer.h"
+#include "shader_compile_job.h"
+#include "worker_thread.h"
 #include "scene_interface.h"
+#include "metrics.h"
 
 #include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/regex.hpp>
 
 #include <array>
-#include <fstream>
+#include <chrono>
 #include <sstream>
 
 /**
@@ -38,6 +41,8 @@ struct OpenglData
     GlRenderTarget preEffectsTarget;     ///< Render target for pre-rendering effects
     GlRenderTarget blurTarget;           ///< Render target for blurring the scene
     GlQuad quad;                         ///< Quad to render the final post processed scene onto
+    GlRingBuffer uploads;                ///< Ring buffer for streaming dynamic data
+    WorkerThread assembler;              ///< Generates shader assembly off the render thread
     glm::vec3 cameraPosition;            ///< Position of the camera
     glm::vec3 cameraUp;                  ///< The up vector of the camera
     glm::mat4 projection;                ///< Projection matrix
@@ -51,6 +56,7 @@ struct OpenglData
     bool useDiffuseTextures = true;      ///< Whether to render diffuse textures
     int selectedShader = -1;             ///< Currently active shader for rendering
     float fadeAmount = 0.0f;             ///< the amount to fade the scene by
+    float presentTime = 0.0f;            ///< Milliseconds spent presenting the last frame
                               
     std::unique_ptr<GlQuadMesh> shadows;              ///< Shadow instances
     std::vector<std::unique_ptr<GlTexture>> textures; ///< Textures shared by all meshes
@@ -67,6 +73,7 @@ OpenglData::OpenglData()
     , preEffectsTarget("PreEffectsTarget", EFFECTS_TEXTURES, false)
     , blurTarget("BlurTarget", BLUR_TEXTURES, false, true)
     , backBuffer("BackBuffer")
+    , uploads("UploadRing", UPLOAD_FRAME_BYTES)
 {
 }
 
@@ -77,6 +84,9 @@ OpenglData::~OpenglData()
 
 void OpenglData::Release()
 {
+    // The analyzer may still be writing the assembly files and cache
+    assembler.Wait();
+
     selectedShader = -1;
     fadeAmount = 0.0f;
 
@@ -120,6 +130,7 @@ void OpenglData::Release()
     preEffectsTarget.Release();
     blurTarget.Release();
     quad.Release();
+    uploads.Release();
 
     wglMakeCurrent(nullptr, nullptr);
     if(hrc)
@@ -229,6 +240,13 @@ bool OpenglEngine::Initialize()
         return false;
     }
 
+    // Create the ring buffer for dynamic uploads
+    if(!m_data->uploads.Initialise())
+    {
+        Logger::LogError("OpenGL: Upload ring buffer failed to initialise");
+        return false;
+    }
+
     // Initialise the opengl environment
     glClearColor(0.22f, 0.49f, 0.85f, 0.0f);
     glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
@@ -274,14 +292,14 @@ bool OpenglEngine::InitialiseScene(const IScene& scene)
     for(const auto& texture : scene.Textures())
     {
         m_data->textures.push_back(std::unique_ptr<GlTexture>(
-            new GlTexture(*texture)));
+            new GlTexture(*texture, scene.Assets())));
     }
 
     m_data->shaders.reserve(scene.Shaders().size());
     for(const auto& shader : scene.Shaders())
     {
         m_data->shaders.push_back(std::unique_ptr<GlShader>(
-            new GlShader(*shader)));
+            new GlShader(*shader, scene.Assets(), m_data->assembler)));
     }
 
     m_data->meshes.reserve(scene.Meshes().size());
@@ -406,11 +424,16 @@ void OpenglEngine::Render(const IScene& scene, float timer)
     RenderPreEffects(scene.Post());
     RenderBlur(scene.Post());
     RenderPostProcessing(scene.Post());
+    const auto presentStart = std::chrono::high_resolution_clock::now();
     SwapBuffers(m_data->hdc); 
+    m_data->presentTime = static_cast<float>(std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - presentStart).count());
+    m_data->uploads.EndFrame();
 }
 
 void OpenglEngine::RenderSceneMap(const IScene& scene, float timer)
 {
+    Metrics::SetPass(Metrics::Scene);
     m_data->sceneTarget.SetActive();
 
     if (m_data->isWireframe)
@@ -502,6 +525,7 @@ void OpenglEngine::RenderEmitters(const IScene& scene)
 
 void OpenglEngine::RenderPreEffects(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::PreEffects);
     EnableBackfaceCull(false);
     EnableAlphaBlending(false, false);
 
@@ -523,6 +547,7 @@ void OpenglEngine::RenderPreEffects(const PostProcessing& post)
 
 void OpenglEngine::RenderBlur(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::Blur);
     EnableAlphaBlending(false, false);
     EnableBackfaceCull(false);
 
@@ -558,6 +583,7 @@ void OpenglEngine::RenderBlur(const PostProcessing& post)
 
 void OpenglEngine::RenderPostProcessing(const PostProcessing& post)
 {
+    Metrics::SetPass(Metrics::Post);
     m_data->useDiffuseTextures = post.UseDiffuseTextures();
 
     EnableAlphaBlending(false, false);
@@ -681,7 +707,7 @@ bool OpenglEngine::UpdateShader(const MeshData& mesh,
             }
         }
     
-        SendTextures(mesh.TextureIDs());
+        SendTextures(mesh.RenderTextureIDs());
         EnableBackfaceCull(mesh.BackfaceCull());
         EnableAlphaBlending(alphaBlend, false);
         return true;
@@ -794,6 +820,7 @@ bool OpenglEngine::SendTexture(const std::string& sampler, int ID)
 
 void OpenglEngine::SetSelectedShader(int index)
 {
+    Metrics::Count(Metrics::ShaderSwitches);
     m_data->selectedShader = index;
     m_data->shaders[index]->SetActive();
 }
@@ -839,9 +866,9 @@ std::string OpenglEngine::GetShaderText(int index) const
     return m_data->shaders[index]->GetText();
 }
 
-std::string OpenglEngine::GetShaderAssembly(int index)
+bool OpenglEngine::GetShaderAssembly(int index, std::string& assembly)
 {
-    return m_data->shaders[index]->GetAssembly();
+    return m_data->shaders[index]->GetAssembly(assembly);
 }
 
 void OpenglEngine::SetFade(float value)
@@ -849,32 +876,15 @@ void OpenglEngine::SetFade(float value)
     m_data->fadeAmount = value;
 }
 
-void OpenglEngine::WriteToShader(const Shader& shader,
-                                 const std::string& text)
+std::unique_ptr<ShaderCompileJob> OpenglEngine::CreateCompileJob(int index,
+                                                                 const std::string& text)
 {
-    auto WriteToFile = [](const std::string& contents, const std::string& filepath)
-    {
-        std::ofstream file(filepath.c_str(), std::ios_base::out | std::ios_base::trunc);
-        if (!file.is_open())
-        {
-            Logger::LogError("Could not open " + filepath);
-        }
-        else
-        {
-            file << contents << std::endl;
-            file.close();
-        }
-    };
-
-    // GLSL uses two files that both must start with GLSL_HEADER
-    // Note first component in split regex vector is whitespace or empty
-
-    std::vector<std::string> components;
-    boost::algorithm::split_regex(components, 
-        text, boost::regex(GlShader::GetShaderHeader()));
+    return m_data->shaders[index]->CreateCompileJob(text);
+}
 
-    WriteToFile(GlShader::GetShaderHeader() + components[1], shader.GLSLVertexFile());
-    WriteToFile(GlShader::GetShaderHeader() + components[2], shader.GLSLFragmentFile());
+std::unique_ptr<ShaderCompileJob> OpenglEngine::CreateReloadJob(int index)
+{
+    return m_data->shaders[index]->CreateReloadJob();
 }
 
 void OpenglEngine::EnableAlphaBlending(bool enable, bool multiply)
@@ -934,7 +944,7 @@ void OpenglEngine::ToggleWireframe()
 void OpenglEngine::ReloadTexture(int index)
 {
     const auto& name = m_data->textures[index]->Name();
-    m_data->textures[index]->ReloadPixels() ?
+    m_data->textures[index]->ReloadPixels(m_data->uploads) ?
         Logger::LogInfo("Texture: " + name + " reload successful") :
         Logger::LogError("Texture: " + name + " reload failed");
 }
@@ -942,8 +952,23 @@ void OpenglEngine::ReloadTexture(int index)
 void OpenglEngine::ReloadTerrain(int index)
 {
     const auto& name = m_data->terrain[index]->GetTerrain().Name();
-    if (!m_data->terrain[index]->Reload())
+    if (!m_data->terrain[index]->Reload(m_data->uploads))
     {
         Logger::LogError("Terrain: " + name + " reload failed");
     }
 }
+
+int OpenglEngine::GetBytesUploaded() const
+{
+    return m_data->uploads.GetBytesUploaded();
+}
+
+float OpenglEngine::GetPresentTime() const
+{
+    return m_data->presentTime;
+}
+
+bool OpenglEngine::RequiresGeometry() const
+{
+    return false;
+}
@@ -3,6 +3,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 
 #include "opengl_mesh.h"
+#include "opengl_ring_buffer.h"
+#include "metrics.h"
 
 GlMeshBuffer::GlMeshBuffer(const std::string& name,
                            const std::vector<float>& vertices,
@@ -10,6 +12,7 @@ GlMeshBuffer::GlMeshBuffer(const std::string& name,
     : m_name(name)
     , m_vertices(vertices)
     , m_indices(indices)
+    , m_bufferMemory(Memory::GpuBuffers)
 {
 }
 
@@ -86,21 +89,25 @@ void GlMeshBuffer::Release()
         glDeleteBuffers(1, &m_vboID);
         glDeleteBuffers(1, &m_iboID);
         glDeleteBuffers(1, &m_vaoID);
+        m_bufferMemory.Set(0);
         m_initialised = false;
     }
 }
 
 bool GlMeshBuffer::FillBuffers()
 {
+    m_vertexBytes = sizeof(float) * m_vertices.size();
+    m_indexBytes = sizeof(DWORD) * m_indices.size();
+    m_indexCount = static_cast<int>(m_indices.size());
+
     glBindVertexArray(m_vaoID);
 
     glBindBuffer(GL_ARRAY_BUFFER, m_vboID);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float)*m_vertices.size(), 
-        &m_vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, m_vertexBytes, &m_vertices[0], GL_STATIC_DRAW);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iboID);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(DWORD)*m_indices.size(), 
-        &m_indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexBytes, &m_indices[0], GL_STATIC_DRAW);
+    m_bufferMemory.Set(m_vertexBytes + m_indexBytes);
 
     return !HasCallFailed();
 }
@@ -109,7 +116,7 @@ bool GlMeshData::Initialise()
 {
     m_updateInstances = true;
     m_world.clear();
-    m_world.resize(m_meshdata.Instances().size());
+    m_world.resize(m_meshdata.RenderInstances().size());
     return GlMeshBuffer::Initialise();
 }
 
@@ -144,7 +151,8 @@ void GlMeshBuffer::PreRender()
 void GlMeshBuffer::Render()
 {
     assert(m_initialised);
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, 0);
+    Metrics::Count(Metrics::DrawCalls);
 }
 
 const MeshData& GlMeshData::GetData() const
@@ -167,14 +175,23 @@ const Terrain& GlMesh::GetTerrain() const
     return static_cast<const Terrain&>(GetData());
 }
 
-bool GlMeshBuffer::Reload()
+bool GlMeshBuffer::Reload(GlRingBuffer& ring)
 {
-    return FillBuffers();
+    // Buffers can only be streamed into if their size hasn't changed
+    const int vertexBytes = sizeof(float) * m_vertices.size();
+    const int indexBytes = sizeof(DWORD) * m_indices.size();
+    if (vertexBytes != m_vertexBytes || indexBytes != m_indexBytes)
+    {
+        return FillBuffers();
+    }
+
+    return ring.UploadBuffer(GL_ARRAY_BUFFER, m_vboID, &m_vertices[0], vertexBytes) &&
+           ring.UploadBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iboID, &m_indices[0], indexBytes);
 }
 
 void GlMeshData::Render()
 {
-    const auto& instances = m_meshdata.Instances();
+    const auto& instances = m_meshdata.RenderInstances();
     for (unsigned int i = 0; i < instances.size(); ++i)
     {
         const auto& instance = instances[i];
@@ -6,6 +6,7 @@
 
 #include "opengl_common.h"
 class Mesh;
+class GlRingBuffer;
 
 /**
 * Base data for any polygons to be rendered
@@ -52,9 +53,10 @@ public:
 
     /**
     * Reloads the mesh
+    * @param ring The ring buffer to stream the data through
     * @return whether reloading was successful
     */
-    bool Reload();
+    bool Reload(GlRingBuffer& ring);
 
 protected:
 
@@ -71,9 +73,13 @@ protected:
     GLuint m_vboID = 0;                         ///< Unique ID for the Vertex Buffer Object
     GLuint m_iboID = 0;                         ///< Unique ID for the Index Buffer Object
     bool m_initialised = false;                 ///< Whether the vertex buffer object is initialised or not
+    int m_vertexBytes = 0;                      ///< Size of the allocated vertex buffer
+    int m_indexBytes = 0;                       ///< Size of the allocated index buffer
+    int m_indexCount = 0;                       ///< Number of indices in the index buffer
     std::string m_name;                         ///< Name of the mesh
-    const std::vector<float>& m_vertices;       ///< Vertex buffer data
-    const std::vector<unsigned int>& m_indices; ///< Index buffer data
+    const std::vector<float>& m_vertices;       ///< Vertex buffer data, only read while uploading
+    const std::vector<unsigned int>& m_indices; ///< Index buffer data, only read while uploading
+    MemoryUsage m_bufferMemory;                 ///< Bytes held by the vertex and index buffers
 };
 
 /**
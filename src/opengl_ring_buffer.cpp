@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - opengl_ring_buffer.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "opengl_ring_buffer.h"
+
+namespace
+{
+    const int ALIGNMENT = 16;                ///< Byte alignment of each allocation
+    const GLuint64 FENCE_TIMEOUT = 1000000;  ///< Nanoseconds to wait on a fence before retrying
+}
+
+GlRingBuffer::GlRingBuffer(const std::string& name, int frameBytes)
+    : m_name(name)
+    , m_frameBytes(frameBytes)
+    , m_bufferMemory(Memory::GpuBuffers)
+{
+    m_fences.fill(nullptr);
+}
+
+GlRingBuffer::~GlRingBuffer()
+{
+    Release();
+}
+
+void GlRingBuffer::Release()
+{
+    for (auto& fence : m_fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (m_initialised)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_id);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &m_id);
+        m_bufferMemory.Set(0);
+        m_initialised = false;
+    }
+
+    m_mapped = nullptr;
+    m_section = 0;
+    m_offset = 0;
+    m_bytesUploaded = 0;
+    m_lastBytesUploaded = 0;
+    m_sectionReady = false;
+}
+
+bool GlRingBuffer::Initialise()
+{
+    if (!GLEW_ARB_buffer_storage)
+    {
+        Logger::LogInfo("OpenGL: " + m_name + " persistent mapping unsupported, using direct uploads");
+        return true;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(m_frameBytes) * UPLOAD_FRAMES;
+
+    glGenBuffers(1, &m_id);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_id);
+    glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+    m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    m_bufferMemory.Set(size);
+    m_initialised = true;
+
+    if (HasCallFailed() || !m_mapped)
+    {
+        Logger::LogError("OpenGL: " + m_name + " failed to map buffer");
+        Release();
+        return false;
+    }
+    return true;
+}
+
+void GlRingBuffer::EndFrame()
+{
+    if (m_initialised && m_offset > 0)
+    {
+        m_fences[m_section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_section = (m_section + 1) % UPLOAD_FRAMES;
+        m_sectionReady = false;
+        m_offset = 0;
+    }
+
+    m_lastBytesUploaded = m_bytesUploaded;
+    m_bytesUploaded = 0;
+}
+
+void GlRingBuffer::WaitForSection()
+{
+    auto& fence = m_fences[m_section];
+    if (fence)
+    {
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED)
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        }
+
+        if (result == GL_WAIT_FAILED)
+        {
+            Logger::LogError("OpenGL: " + m_name + " fence wait failed");
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    m_sectionReady = true;
+}
+
+int GlRingBuffer::Stage(const void* data, int bytes)
+{
+    const int start = (m_offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (!m_initialised || start + bytes > m_frameBytes)
+    {
+        return -1;
+    }
+
+    if (!m_sectionReady)
+    {
+        WaitForSection();
+    }
+
+    const int offset = m_section * m_frameBytes + start;
+    memcpy(m_mapped + offset, data, bytes);
+    m_offset = start + bytes;
+    return offset;
+}
+
+bool GlRingBuffer::UploadBuffer(GLenum target, GLuint id, const void* data, int bytes)
+{
+    const int offset = Stage(data, bytes);
+    if (offset >= 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, m_id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, 0, bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    else
+    {
+        glBindBuffer(target, id);
+        glBufferSubData(target, 0, bytes, data);
+    }
+
+    m_bytesUploaded += bytes;
+    return !HasCallFailed();
+}
+
+bool GlRingBuffer::UploadTexture(GLuint id, int size, const void* pixels)
+{
+    const int bytes = size * size * 4;
+    const int offset = Stage(pixels, bytes);
+
+    glBindTexture(GL_TEXTURE_2D, id);
+    if (offset >= 0)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_id);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA,
+            GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(static_cast<size_t>(offset)));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    m_bytesUploaded += bytes;
+    return !HasCallFailed();
+}
+
+int GlRingBuffer::GetBytesUploaded() const
+{
+    return m_lastBytesUploaded;
+}
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - opengl_ring_buffer.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "opengl_common.h"
+
+#include <array>
+
+/**
+* Persistently mapped buffer split into a section per frame in flight.
+* Dynamic data is written into the current section and copied on the gpu
+* into its destination, with a fence guarding each section from being
+* overwritten before the gpu has finished reading from it
+*/
+class GlRingBuffer : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param name The name of the ring buffer
+    * @param frameBytes The size of a single frame section
+    */
+    GlRingBuffer(const std::string& name, int frameBytes);
+
+    /**
+    * Destructor
+    */
+    ~GlRingBuffer();
+
+    /**
+    * Releases the ring buffer
+    */
+    void Release();
+
+    /**
+    * Initialises the ring buffer
+    * @note if persistent mapping is not supported all uploads
+    *       will fall back to directly updating the destination
+    * @return whether initialisation succeeded
+    */
+    bool Initialise();
+
+    /**
+    * Fences the current section and moves to the next
+    * @note should be called once all commands for the frame are submitted
+    */
+    void EndFrame();
+
+    /**
+    * Uploads data into an existing buffer
+    * @param target The type of buffer to upload to
+    * @param id The buffer to upload to
+    * @param data The data to upload
+    * @param bytes The size of the data in bytes
+    * @return whether the upload was successful
+    */
+    bool UploadBuffer(GLenum target, GLuint id, const void* data, int bytes);
+
+    /**
+    * Uploads pixels into an existing 2D RGBA texture
+    * @param id The texture to upload to
+    * @param size The dimensions of the texture
+    * @param pixels The pixels to upload
+    * @return whether the upload was successful
+    */
+    bool UploadTexture(GLuint id, int size, const void* pixels);
+
+    /**
+    * @return the amount of bytes uploaded during the last frame
+    */
+    int GetBytesUploaded() const;
+
+private:
+
+    /**
+    * Copies the data into the current section
+    * @param data The data to copy
+    * @param bytes The size of the data in bytes
+    * @return the offset into the buffer or -1 if the data could not fit
+    */
+    int Stage(const void* data, int bytes);
+
+    /**
+    * Waits for the gpu to finish reading the current section
+    */
+    void WaitForSection();
+
+private:
+
+    std::string m_name;                         ///< Name of the ring buffer
+    GLuint m_id = 0;                            ///< Unique id for the buffer
+    unsigned char* m_mapped = nullptr;          ///< Persistently mapped memory of the buffer
+    std::array<GLsync, UPLOAD_FRAMES> m_fences; ///< Fence for each frame section
+    int m_frameBytes = 0;                       ///< Size of a single frame section
+    int m_section = 0;                          ///< Section currently being written to
+    int m_offset = 0;                           ///< Offset into the current section
+    int m_bytesUploaded = 0;                    ///< Bytes uploaded for the current frame
+    int m_lastBytesUploaded = 0;                ///< Bytes uploaded for the last frame
+    bool m_sectionReady = false;                ///< Whether the current section can be written to
+    bool m_initialised = false;                 ///< Whether the buffer is initialised
+    MemoryUsage m_bufferMemory;                 ///< Bytes held by the buffer
+};
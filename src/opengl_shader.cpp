@@ -4,8 +4,15 @@
 
 #include "opengl_shader.h"
 #include "opengl_target.h"
+#include "shader_cache.h"
+#include "asset_cache.h"
+#include "shader_compile_job.h"
+#include "metrics.h"
+#include "worker_thread.h"
 
 #include <boost/algorithm/string.hpp>
+#include <boost/algorithm/string/regex.hpp>
+#include <boost/regex.hpp>
 #include <boost/bimap.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -24,6 +31,33 @@ namespace
     const std::string VERTEX_MODEL("glsl_vs");
     const std::string FRAGMENT_MODEL("glsl_fs");
     const std::string GLSL_HEADER("#version");
+    const std::string ANALYZER("Assets\\Compiliers\\GPUShaderAnalyzer.exe");
+
+    /**
+    * @return whether the driver can save and load program binaries
+    */
+    bool SupportsProgramBinaries()
+    {
+        GLint formats = 0;
+        if (GLEW_ARB_get_program_binary)
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        return formats > 0;
+    }
+
+    /**
+    * @return identification of the driver, binaries are only valid for the driver that created them
+    */
+    std::string GetDriverID()
+    {
+        auto getString = [](GLenum name) -> std::string
+        {
+            const GLubyte* value = glGetString(name);
+            return value ? reinterpret_cast<const char*>(value) : "";
+        };
+        return getString(GL_VENDOR) + "|" + getString(GL_RENDERER) + "|" + getString(GL_VERSION);
+    }
 
     const int IN_POSITION_ID = 0;
     std::vector<std::string> ATTRIBUTE_MAP =
@@ -36,12 +70,15 @@ namespace
     };
 }
 
-GlShader::GlShader(const Shader& shader)
+GlShader::GlShader(const Shader& shader, AssetCache& assets, WorkerThread& assembler)
     : m_shader(shader)
+    , m_assets(assets)
+    , m_assembler(assembler)
     , m_vsFilepath(shader.GLSLVertexFile())
     , m_fsFilepath(shader.GLSLFragmentFile())
     , m_vaFilepath(shader.GLSLVertexAsmFile())
     , m_faFilepath(shader.GLSLFragmentAsmFile())
+    , m_textMemory(Memory::ShaderText)
 {
 }
 
@@ -55,8 +92,6 @@ void GlShader::Release()
     m_uniforms.clear();
     m_attributes.clear();
     m_samplers.clear();
-    m_vertexAsm.clear();
-    m_fragmentAsm.clear();
 
     if(m_program != -1)
     {
@@ -99,6 +134,30 @@ std::string GlShader::CompileShader()
         return FS + errorBuffer;
     }
 
+    return CompileShader(vertexText, fragmentText);
+}
+
+std::string GlShader::CompileShader(const std::string& vertexText, 
+                                    const std::string& fragmentText)
+{
+    const unsigned long long cacheKey =
+        ShaderCache::GenerateKey(GetDriverID(), vertexText + fragmentText);
+
+    std::string errorBuffer;
+    if (LoadProgramBinary(cacheKey))
+    {
+        m_vertexText = vertexText;
+        m_fragmentText = fragmentText;
+        m_textMemory.Set(m_vertexText.capacity() + m_fragmentText.capacity());
+
+        errorBuffer = BindShaderAttributes();
+        if(!errorBuffer.empty())
+        {
+            return errorBuffer;
+        }
+        return FindShaderUniforms();
+    }
+
     GLint vertex = glCreateShader(GL_VERTEX_SHADER);
     std::string vertexErrors = CompileShader(vertex, vertexText);
     if(!vertexErrors.empty())
@@ -122,31 +181,44 @@ std::string GlShader::CompileShader()
             vertexErrors + (fragmentErrors.empty() ? "" : "\n"+fragmentErrors);
     }
 
-    Release();
-    m_program = glCreateProgram();
-    m_vs = vertex;
-    m_fs = fragment;
-    m_vertexText = vertexText;
-    m_fragmentText = fragmentText;
+    // Linked separately so the program in use is kept if linking fails
+    GLint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    errorBuffer = HasCallFailed() ? VS + "Failed to attach" : "";
 
-    glAttachShader(m_program, m_vs);
-    if(HasCallFailed())
+    if(errorBuffer.empty())
     {
-        return VS + "Failed to attach";
+        glAttachShader(program, fragment);
+        errorBuffer = HasCallFailed() ? FS + "Failed to attach" : "";
     }
 
-    glAttachShader(m_program, m_fs);
-    if(HasCallFailed())
+    if(errorBuffer.empty())
     {
-        return FS + "Failed to attach";
+        if (SupportsProgramBinaries())
+        {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        errorBuffer = LinkShaderProgram(program);
     }
 
-    errorBuffer = LinkShaderProgram();
     if(!errorBuffer.empty())
     {
+        glDeleteProgram(program);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
         return errorBuffer;
     }
 
+    Release();
+    m_program = program;
+    m_vs = vertex;
+    m_fs = fragment;
+    m_vertexText = vertexText;
+    m_fragmentText = fragmentText;
+    m_textMemory.Set(m_vertexText.capacity() + m_fragmentText.capacity());
+
+    SaveProgramBinary(cacheKey);
+
     errorBuffer = BindShaderAttributes();
     if(!errorBuffer.empty())
     {
@@ -162,6 +234,131 @@ std::string GlShader::CompileShader()
     return std::string();
 }
 
+class GlShader::CompileJob : public ShaderCompileJob
+{
+public:
+
+    /**
+    * Constructor
+    * @param shader The shader to recompile
+    * @param text The new text holding the vertex and fragment shaders
+    */
+    CompileJob(GlShader& shader, const std::string& text)
+        : m_shader(shader)
+        , m_text(text)
+        , m_vsFilepath(shader.m_vsFilepath)
+        , m_fsFilepath(shader.m_fsFilepath)
+    {
+    }
+
+    /**
+    * Constructor for reloading the regenerated files
+    * @param shader The shader to recompile
+    */
+    explicit CompileJob(GlShader& shader)
+        : m_shader(shader)
+        , m_vsFilepath(shader.m_vsFilepath)
+        , m_fsFilepath(shader.m_fsFilepath)
+        , m_reload(true)
+    {
+    }
+
+    /**
+    * Splits the text into the vertex and fragment shaders and writes them
+    * or reads the regenerated text when reloading
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Prepare() override
+    {
+        if (m_reload)
+        {
+            // Only reads through the asset cache which is safe off the render thread
+            std::string errorBuffer = m_shader.LoadShaderText(m_vsFilepath, m_vertexText);
+            if(!errorBuffer.empty())
+            {
+                return VS + errorBuffer;
+            }
+            errorBuffer = m_shader.LoadShaderText(m_fsFilepath, m_fragmentText);
+            return errorBuffer.empty() ? errorBuffer : FS + errorBuffer;
+        }
+
+        // GLSL uses two files that both must start with GLSL_HEADER
+        // Note first component in split regex vector is whitespace or empty
+        std::vector<std::string> components;
+        boost::algorithm::split_regex(components, m_text, boost::regex(GLSL_HEADER));
+        if(components.size() < 3)
+        {
+            return "Could not find vertex and fragment shaders";
+        }
+
+        m_vertexText = GLSL_HEADER + components[1] + "\n";
+        m_fragmentText = GLSL_HEADER + components[2] + "\n";
+
+        std::string errorBuffer = WriteToFile(m_vsFilepath, m_vertexText);
+        if(!errorBuffer.empty())
+        {
+            return VS + errorBuffer;
+        }
+
+        errorBuffer = WriteToFile(m_fsFilepath, m_fragmentText);
+        if(!errorBuffer.empty())
+        {
+            return FS + errorBuffer;
+        }
+
+        return std::string();
+    }
+
+    /**
+    * Compiles and links the written text, swapping the program on success
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Finish() override
+    {
+        return m_shader.CompileShader(m_vertexText, m_fragmentText);
+    }
+
+private:
+
+    /**
+    * Writes the text to the shader file
+    * @note text mode so edits keep the line endings the linker generates with
+    * @param path The path of the shader file
+    * @param text The text to write
+    * @return Error message if failed or empty if succeeded
+    */
+    static std::string WriteToFile(const std::string& path, const std::string& text)
+    {
+        std::ofstream file(path.c_str(), std::ios_base::out|std::ios_base::trunc);
+
+        if(!file.is_open())
+        {
+            return "Could not open file " + path;
+        }
+
+        file << text;
+        return std::string();
+    }
+
+    GlShader& m_shader;          ///< The shader to swap once compiled
+    std::string m_text;          ///< The new text for both shaders
+    std::string m_vsFilepath;    ///< Path to the vertex shader file
+    std::string m_fsFilepath;    ///< Path to the fragment shader file
+    std::string m_vertexText;    ///< Text for the vertex shader once split
+    std::string m_fragmentText;  ///< Text for the fragment shader once split
+    bool m_reload = false;       ///< Whether to read the files rather than write them
+};
+
+std::unique_ptr<ShaderCompileJob> GlShader::CreateCompileJob(const std::string& text)
+{
+    return std::make_unique<CompileJob>(*this, text);
+}
+
+std::unique_ptr<ShaderCompileJob> GlShader::CreateReloadJob()
+{
+    return std::make_unique<CompileJob>(*this);
+}
+
 std::string GlShader::CompileShader(GLint index, const std::string& text)
 {
     const char* source = text.c_str();
@@ -192,39 +389,87 @@ std::string GlShader::CompileShader(GLint index, const std::string& text)
 
 std::string GlShader::LoadShaderText(const std::string& path, std::string& text)
 {
-    std::ifstream file(path, std::ios::in|std::ios::binary|std::ios::ate);
-    if(file.is_open())
-    {
-        // Read all from file directly into a string
-        const int size = static_cast<int>(file.tellg());
-        file.seekg(0, std::ios::beg);
-        text.resize(size);
-        file.read(&text[0], text.size());
-        assert(!text.empty());
-        file.close();
-    }
-    else
+    const auto cached = m_assets.GetText(path);
+    if(!cached)
     {
-       return "Could not open file " + path;
+        return "Could not open file " + path;
     }
+
+    text = *cached;
+    assert(!text.empty());
     return std::string();
 }
 
-std::string GlShader::LinkShaderProgram()
+std::string GlShader::LinkShaderProgram(GLint program)
 {
     GLint linkSuccess = GL_FALSE;
-    glLinkProgram(m_program);
-    glGetProgramiv(m_program, GL_LINK_STATUS, &linkSuccess);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
     if(linkSuccess == GL_FALSE)
     {
         const int bufferSize = 1024;
         std::string errors(bufferSize, '\0');
-        glGetProgramInfoLog(m_program, bufferSize, 0, &errors[0]);
+        glGetProgramInfoLog(program, bufferSize, 0, &errors[0]);
         return std::string(errors.begin(), errors.begin() + errors.find('\0'));
     }
     return std::string();
 }
 
+bool GlShader::LoadProgramBinary(unsigned long long key)
+{
+    if (!SupportsProgramBinaries())
+    {
+        return false;
+    }
+
+    unsigned int format = 0;
+    std::vector<char> binary;
+    if (!ShaderCache::Load(m_shader.GLSLBinaryFile(), key, format, binary))
+    {
+        return false;
+    }
+
+    // The driver may still reject a binary with a matching key
+    // after an update, in which case fall back to compiling
+    GLint program = glCreateProgram();
+    glProgramBinary(program, format, &binary[0], static_cast<GLsizei>(binary.size()));
+
+    GLint linkSuccess = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkSuccess);
+    if (glGetError() != GL_NO_ERROR || linkSuccess == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    Release();
+    m_program = program;
+    return true;
+}
+
+void GlShader::SaveProgramBinary(unsigned long long key)
+{
+    if (!SupportsProgramBinaries())
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+
+    GLenum format = 0;
+    std::vector<char> binary(length);
+    glGetProgramBinary(m_program, length, &length, &format, &binary[0]);
+    if (!HasCallFailed())
+    {
+        ShaderCache::Save(m_shader.GLSLBinaryFile(), key, format, &binary[0], length);
+    }
+}
+
 std::string GlShader::LoadAssemblyText(const std::string& path, std::string& text)
 {
     std::ifstream file(path.c_str(), std::ios::in|std::ios::ate|std::ios::_Nocreate);
@@ -253,25 +498,20 @@ std::string GlShader::LoadAssemblyText(const std::string& path, std::string& tex
         <= minimumLines ? text : std::string();
 }
 
-std::string GlShader::GenerateAssembly()
+std::string GlShader::GenerateAssembly(const AssemblyPaths& paths, Assembly& assembly)
 {
-    if(!m_vertexAsm.empty() && !m_fragmentAsm.empty())
-    {
-        return std::string();
-    }
-
     // Opengl 3.0 currently has no output of shader asm 
     // Use cmd.exe to chain both calls to ShaderAnalyzer in one process
     // GPUShaderAnalyzer.exe Diffuse_glsl_vert.fx -I Diffuse_glsl_vert.asm -ASIC IL -profile glsl_vs -function main
     // GPUShaderAnalyzer.exe Diffuse_glsl_frag.fx -I Diffuse_glsl_frag.asm -ASIC IL -profile glsl_fs -function main
 
-    const std::string process("Assets\\Compiliers\\GPUShaderAnalyzer.exe ");
+    const std::string process(ANALYZER + " ");
     const std::string console("C:\\windows\\system32\\cmd.exe");
 
-    const std::string vertex(m_vsFilepath + " -I " + m_vaFilepath 
+    const std::string vertex(paths.vertexShader + " -I " + paths.vertexAssembly 
         + " -ASIC IL -profile " + VERTEX_MODEL + " -function " + ENTRY_NAME);
 
-    const std::string fragment(m_fsFilepath + " -I " + m_faFilepath 
+    const std::string fragment(paths.fragmentShader + " -I " + paths.fragmentAssembly 
         + " -ASIC IL -profile " + FRAGMENT_MODEL + " -function " + ENTRY_NAME);
 
     const std::string command = "/C " + process + vertex + " && " + process + fragment + 
@@ -298,13 +538,13 @@ std::string GlShader::GenerateAssembly()
         return "Process failed: " + command;
     }
 
-    std::string errorBuffer = LoadAssemblyText(m_vaFilepath, m_vertexAsm);
+    std::string errorBuffer = LoadAssemblyText(paths.vertexAssembly, assembly.vertex);
     if(!errorBuffer.empty())
     {
         return VS + "ShaderAnalyzer: " + errorBuffer;
     }
 
-    errorBuffer = LoadAssemblyText(m_faFilepath, m_fragmentAsm);
+    errorBuffer = LoadAssemblyText(paths.fragmentAssembly, assembly.fragment);
     if(!errorBuffer.empty())
     {
         return FS + "ShaderAnalyzer: " + errorBuffer;
@@ -313,6 +553,28 @@ std::string GlShader::GenerateAssembly()
     return std::string();
 }
 
+bool GlShader::LoadAssemblyCache(const std::string& path, Assembly& assembly)
+{
+    unsigned int vertexSize = 0;
+    std::vector<char> binary;
+    if (!ShaderCache::Load(path, assembly.key, vertexSize, binary) || vertexSize > binary.size())
+    {
+        return false;
+    }
+
+    // The format holds the length of the vertex assembly that starts the binary
+    assembly.vertex.assign(binary.begin(), binary.begin() + vertexSize);
+    assembly.fragment.assign(binary.begin() + vertexSize, binary.end());
+    return true;
+}
+
+void GlShader::SaveAssemblyCache(const std::string& path, const Assembly& assembly)
+{
+    const std::string binary = assembly.vertex + assembly.fragment;
+    ShaderCache::Save(path, assembly.key, static_cast<unsigned int>(assembly.vertex.size()),
+        binary.c_str(), static_cast<int>(binary.size()));
+}
+
 std::string GlShader::BindShaderAttributes()
 {
     std::string errorBuffer = BindVertexAttributes();
@@ -473,6 +735,7 @@ void GlShader::SendUniformMatrix(const std::string& name, const glm::mat4& matri
     if(itr != m_uniforms.end())
     {
         glUniformMatrix4fv(itr->second.location, 1, GL_FALSE, &matrix[0][0]);
+        Metrics::Count(Metrics::UniformSends);
 
         if (itr->second.type != GL_FLOAT_MAT4)
         {
@@ -541,6 +804,8 @@ void GlShader::SendUniformFloat(const std::string& name,
         Logger::LogError("Unknown uniform type " + name);
     }
 
+    Metrics::Count(Metrics::UniformSends);
+
     if(HasCallFailed())
     {
         Logger::LogError("Could not send uniform " + name);
@@ -633,6 +898,7 @@ void GlShader::SendTexture(const std::string& sampler, GLuint id, bool multisamp
             }
 
             glUniform1i(samplerItr->second.location, samplerItr->second.slot);
+            Metrics::Count(Metrics::TextureBinds);
 
             if (HasCallFailed())
             {
@@ -661,16 +927,72 @@ std::string GlShader::GetText() const
     return m_vertexText + "\n" + m_fragmentText;
 }
 
-std::string GlShader::GetAssembly()
+bool GlShader::GetAssembly(std::string& assembly)
 {
-    // Generating the assembly is a bottleneck for OpenGL
-    // as requires ShaderAnalyzer. Only generate when requested.
-    const std::string errors = GenerateAssembly();
-    if(!errors.empty())
+    const unsigned long long key = ShaderCache::GenerateKey(ANALYZER, m_vertexText + m_fragmentText);
+    if (m_assembly && m_assembly->key == key)
     {
-        Logger::LogError("OpenGL: " + m_shader.Name() + " " + errors);
+        if (!m_assembly->ready)
+        {
+            return false;
+        }
+        assembly = m_assembly->vertex + "\n" + m_assembly->fragment;
+        return true;
     }
-    return m_vertexAsm + "\n" + m_fragmentAsm;
+
+    // Text edited while generating waits rather than queueing analyzer runs
+    if (m_assembly && !m_assembly->ready)
+    {
+        return false;
+    }
+
+    auto job = std::make_shared<Assembly>();
+    job->key = key;
+    m_assembly = job;
+
+    AssemblyPaths paths;
+    paths.name = m_shader.Name();
+    paths.vertexShader = m_vsFilepath;
+    paths.fragmentShader = m_fsFilepath;
+    paths.vertexAssembly = m_vaFilepath;
+    paths.fragmentAssembly = m_faFilepath;
+    paths.cache = m_shader.GLSLAsmCacheFile();
+
+    if (LoadAssemblyCache(paths.cache, *job))
+    {
+        job->ready = true;
+        assembly = job->vertex + "\n" + job->fragment;
+        return true;
+    }
+
+    // Generating the assembly is a bottleneck for OpenGL as it requires
+    // ShaderAnalyzer. Runs on the engine's worker which finishes it before
+    // the engine is released, the job is shared so it can outlive this shader
+    std::mutex& fileMutex = m_shader.FileMutex();
+    m_assembler.Push([job, paths, &fileMutex]()
+    {
+        std::string errors;
+        {
+            // The watcher and recompiles can rewrite the shader files mid read
+            std::lock_guard<std::mutex> lock(fileMutex);
+            errors = GenerateAssembly(paths, *job);
+        }
+
+        if (errors.empty())
+        {
+            SaveAssemblyCache(paths.cache, *job);
+        }
+        else
+        {
+            // Failures are shown in place of the assembly and not cached
+            Logger::LogError("OpenGL: " + paths.name + " " + errors);
+            job->vertex = "Assembly generation failed: " + errors;
+            job->fragment.clear();
+        }
+        job->ready = true;
+    });
+
+    return false;
 }
 
 const std::string& GlShader::GetName() const
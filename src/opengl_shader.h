@@ -6,9 +6,14 @@
 
 #include "opengl_common.h"
 #include <unordered_map>
+#include <atomic>
+#include <memory>
 
 class Shader;
 class GlRenderTarget;
+class AssetCache;
+class ShaderCompileJob;
+class WorkerThread;
 
 /**
 * Holds information for an opengl shader
@@ -20,8 +25,10 @@ public:
     /**
     * Constructor
     * @param shader The shader data to create
+    * @param assets The cache of generated shader text
+    * @param assembler The worker to generate assembly on
     */
-    GlShader(const Shader& shader);
+    GlShader(const Shader& shader, AssetCache& assets, WorkerThread& assembler);
 
     /**
     * Destructor
@@ -39,6 +46,21 @@ public:
     */
     std::string CompileShader();
 
+    /**
+    * Creates a job to recompile the shader from new text
+    * @note the program in use is kept if recompilation fails
+    * @param text The new text holding the vertex and fragment shaders
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    std::unique_ptr<ShaderCompileJob> CreateCompileJob(const std::string& text);
+
+    /**
+    * Creates a job to recompile the shader from its regenerated files
+    * @note the program in use is kept if recompilation fails
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    std::unique_ptr<ShaderCompileJob> CreateReloadJob();
+
     /**
     * Sets the shader as activated for rendering
     */
@@ -108,9 +130,11 @@ public:
     std::string GetText() const;
 
     /**
-    * @return the assembly for the shader
+    * Gets the assembly for the shader, generating it in the background if needed
+    * @param assembly Filled with the assembly once ready
+    * @return whether the assembly is ready
     */
-    std::string GetAssembly();
+    bool GetAssembly(std::string& assembly);
 
     /**
     * @return the the name of the shader
@@ -124,6 +148,12 @@ public:
 
 private:
 
+    /**
+    * Splits and writes new shader text or reads regenerated text on a worker
+    * thread. Compiling requires the context so is left for the render thread
+    */
+    class CompileJob;
+
     /**
     * Sends a texture to the shader
     * @param sampler Name of the shader texture sampler to use
@@ -142,10 +172,38 @@ private:
     void ClearTexture(const std::string& sampler, bool multisample, bool cubemap);
 
     /**
-    * Generates the assembly instructions for the shader if needed
+    * Assembly generated for a single version of the shader text
+    * @note only read once ready as it is filled in by a worker thread
+    */
+    struct Assembly
+    {
+        std::atomic<bool> ready { false };   ///< Whether generation has finished
+        unsigned long long key = 0;          ///< Hash of the text the assembly is for
+        std::string vertex;                  ///< Assembly for the vertex shader
+        std::string fragment;                ///< Assembly for the fragment shader
+    };
+
+    /**
+    * Paths used to generate the assembly, copied for use by the worker thread
+    */
+    struct AssemblyPaths
+    {
+        std::string name;                    ///< Name of the shader
+        std::string vertexShader;            ///< Path to the vertex shader file
+        std::string fragmentShader;          ///< Path to the fragment shader file
+        std::string vertexAssembly;          ///< Path to the vertex assembly file
+        std::string fragmentAssembly;        ///< Path to the fragment assembly file
+        std::string cache;                   ///< Path to the cached assembly
+    };
+
+    /**
+    * Generates the assembly instructions for the shader
+    * @note blocks until the analyzer process has finished
+    * @param paths The paths to generate the assembly with
+    * @param assembly The assembly to fill in
     * @return Error message if failed or empty if succeeded
     */
-    std::string GenerateAssembly();
+    static std::string GenerateAssembly(const AssemblyPaths& paths, Assembly& assembly);
 
     /**
     * Retrieves the generated assembly text from a file
@@ -153,7 +211,22 @@ private:
     * @param text The container to fill with the text
     * @return Error message if failed or empty if succeeded
     */
-    std::string LoadAssemblyText(const std::string& path, std::string& text);
+    static std::string LoadAssemblyText(const std::string& path, std::string& text);
+
+    /**
+    * Loads previously generated assembly matching the assembly key
+    * @param path The path to the cached assembly
+    * @param assembly The assembly to fill in
+    * @return whether the assembly was loaded
+    */
+    static bool LoadAssemblyCache(const std::string& path, Assembly& assembly);
+
+    /**
+    * Saves the generated assembly
+    * @param path The path to the cached assembly
+    * @param assembly The assembly to save
+    */
+    static void SaveAssemblyCache(const std::string& path, const Assembly& assembly);
 
     /**
     * Loads the vertex and pixel shaders into strings
@@ -189,11 +262,35 @@ private:
     */
     std::string CompileShader(GLint index, const std::string& text);
 
+    /**
+    * Generates the shader for the engine from the given text
+    * @note the program in use is kept if compiling or linking fails
+    * @param vertexText The text for the vertex shader
+    * @param fragmentText The text for the fragment shader
+    * @return Error message if failed or empty if succeeded
+    */
+    std::string CompileShader(const std::string& vertexText, 
+                              const std::string& fragmentText);
+
     /**
     * Links together all shaders within the shader program
+    * @param program The shader program to link
     * @return Error message if failed or empty if succeeded
     */
-    std::string LinkShaderProgram();
+    std::string LinkShaderProgram(GLint program);
+
+    /**
+    * Creates the shader program from a cached binary if one is valid
+    * @param key The cache key generated from the shader text and driver
+    * @return whether the program was created from the cache
+    */
+    bool LoadProgramBinary(unsigned long long key);
+
+    /**
+    * Saves the linked shader program binary to the cache
+    * @param key The cache key generated from the shader text and driver
+    */
+    void SaveProgramBinary(unsigned long long key);
 
     /**
     * Sends the float to the shader
@@ -263,6 +360,8 @@ private:
 private:
 
     const Shader& m_shader;                   ///< Shader data and paths
+    AssetCache& m_assets;                     ///< Cache of generated shader text
+    WorkerThread& m_assembler;                ///< Worker to generate assembly on
     UniformMap m_uniforms;                    ///< Vertex and fragment non-attribute uniform data
     SamplerMap m_samplers;                    ///< Fragment shader sampler locations
     std::vector<AttributeData> m_attributes;  ///< Vertex shader input attributes
@@ -272,10 +371,10 @@ private:
     std::string m_faFilepath;                 ///< Path to the fragment assembly file
     std::string m_vertexText;                 ///< Text for the vertex shader
     std::string m_fragmentText;               ///< Text for the fragment shader
-    std::string m_vertexAsm;                  ///< Assembly for the vertex shader
-    std::string m_fragmentAsm;                ///< Assembly for the fragment shader
+    std::shared_ptr<Assembly> m_assembly;     ///< Assembly for the last requested text
     GLint m_program = -1;                     ///< Shader program
     GLint m_vs = -1;                          ///< GLSL Vertex Shader
     GLint m_fs = -1;                          ///< GLSL Fragment Shader
     GLsizei m_stride = 0;                     ///< Stride required for vertex attributes
+    MemoryUsage m_textMemory;                 ///< Bytes held by the shader text
 };
@@ -11,6 +11,7 @@
 GlRenderTarget::GlRenderTarget(const std::string& name)
     : m_isBackBuffer(true)
     , m_name(name)
+    , m_textureMemory(Memory::GpuTextures)
 {
 }
 
@@ -23,6 +24,7 @@ GlRenderTarget::GlRenderTarget(const std::string& name,
     , m_name(name)
     , m_count(textures)
     , m_readWrite(readWrite)
+    , m_textureMemory(Memory::GpuTextures)
 {
     m_attachments.resize(m_count);
     m_texturesMain.resize(m_count);
@@ -55,6 +57,7 @@ void GlRenderTarget::Release()
             glDeleteTextures(1, &texture);
         }
         glDeleteRenderbuffers(1, &m_renderBuffer);
+        m_textureMemory.Set(0);
     }
     m_initialised = false;
 }
@@ -123,6 +126,10 @@ bool GlRenderTarget::Initialise()
                 GL_DEPTH_COMPONENT24, WINDOW_WIDTH, WINDOW_HEIGHT);
         }
 
+        const int depthBytes = 4;
+        m_textureMemory.Add(WINDOW_WIDTH * WINDOW_HEIGHT * depthBytes *
+            (m_multisampled ? MULTISAMPLING_COUNT : 1));
+
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, 
             GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderBuffer);
 
@@ -174,6 +181,10 @@ bool GlRenderTarget::CreateTexture(GLuint& id, unsigned int type, bool highQuali
         return false;
     }
 
+    const int pixelBytes = m_multisampled && highQuality ? 16 : 4;
+    m_textureMemory.Add(WINDOW_WIDTH * WINDOW_HEIGHT * pixelBytes *
+        (m_multisampled ? MULTISAMPLING_COUNT : 1));
+
     return true;
 }
 
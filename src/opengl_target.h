@@ -105,4 +105,5 @@ private:
     std::vector<bool> m_highQuality;    ///< Whether to use high quality textures
     GLuint m_renderBuffer = 0;          ///< Unique ID of the buffer holding the depth information
     GLuint m_frameBuffer = 0;           ///< Unique ID of the frame buffer
+    MemoryUsage m_textureMemory;        ///< Bytes held by the attached textures and depth buffer
 };
@@ -3,13 +3,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////
 
 #include "opengl_texture.h"
+#include "opengl_ring_buffer.h"
+#include "asset_cache.h"
 
-#include "soil/SOIL.h"
-
-#include <boost/filesystem.hpp>
-
-GlTexture::GlTexture(const Texture& texture)
+GlTexture::GlTexture(const Texture& texture, AssetCache& assets)
     : m_texture(texture)
+    , m_assets(assets)
+    , m_textureMemory(Memory::GpuTextures)
 {
 }
 
@@ -23,6 +23,7 @@ void GlTexture::Release()
     if(m_initialised)
     {
         glDeleteTextures(1, &m_id);
+        m_textureMemory.Set(0);
         m_initialised = false;
     }
 }
@@ -74,34 +75,30 @@ void GlTexture::InitialiseFromFile()
 void GlTexture::InitialiseFromPixels()
 {
     const int size = m_texture.Size();
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 
-        size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, 
+        GL_RGBA, GL_UNSIGNED_BYTE, &m_texture.Pixels()[0]);
+    m_textureMemory.Add(size * size * 4);
 
     if(HasCallFailed())
     {
         Logger::LogError("OpenGL: Failed to load " + m_texture.Name());
     }
 
-    if (!ReloadPixels())
-    {
-        Logger::LogError("OpenGL: Failed " + 
-            m_texture.Name() + " reloading");
-    }
-
     SetFiltering();
 }
 
 void GlTexture::LoadTexture(GLenum type, const std::string& path)
 {
-    if (!boost::filesystem::exists(path))
+    const auto image = m_assets.GetImage(path);
+    if (!image)
     {
-        Logger::LogError("OpenGL: " + path + " doesn't exist");
+        Logger::LogError("OpenGL: Failed to load " + path + " texture");
+        return;
     }
 
-    int width, height;
-    unsigned char* image = SOIL_load_image(path.c_str(), &width, &height, 0, SOIL_LOAD_RGBA);
-    glTexImage2D(type, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    SOIL_free_image_data(image);
+    glTexImage2D(type, 0, GL_RGBA, image->width, image->height, 0,
+        GL_RGBA, GL_UNSIGNED_BYTE, &image->pixels[0]);
+    m_textureMemory.Add(image->width * image->height * 4);
 
     if(HasCallFailed())
     {
@@ -147,6 +144,9 @@ bool GlTexture::CreateMipMaps()
             Logger::LogError("OpenGL: Mipmap creation failed for " + m_texture.Name());
             return false;
         }
+
+        // A full mip chain adds a third to the size of the top level
+        m_textureMemory.Set(m_textureMemory.Bytes() * 4 / 3);
     }
     return true;
 }
@@ -162,18 +162,12 @@ bool GlTexture::IsCubeMap() const
     return m_texture.IsCubeMap();
 }
 
-bool GlTexture::ReloadPixels()
+bool GlTexture::ReloadPixels(GlRingBuffer& ring)
 {
     if (m_texture.IsRenderable())
     {
         assert(m_texture.HasPixels());
-
-        glBindTexture(GL_TEXTURE_2D, m_id);
-
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_texture.Size(), 
-            m_texture.Size(), GL_RGBA, GL_UNSIGNED_BYTE, &m_texture.Pixels()[0]);
-
-        return !HasCallFailed();        
+        return ring.UploadTexture(m_id, m_texture.Size(), &m_texture.Pixels()[0]);
     }
     return true;
 }
@@ -6,6 +6,9 @@
 
 #include "opengl_common.h"
 
+class GlRingBuffer;
+class AssetCache;
+
 /**
 * Holds an individual opengl texture
 */
@@ -16,8 +19,9 @@ public:
     /**
     * Constructor
     * @param texture Contains the texture data
+    * @param assets The decoded assets to upload from
     */
-    GlTexture(const Texture& texture);
+    GlTexture(const Texture& texture, AssetCache& assets);
 
     /**
     * Destructor
@@ -52,9 +56,10 @@ public:
 
     /**
     * Reloads the texture from pixels
+    * @param ring The ring buffer to stream the pixels through
     * @return whether reloading was successful
     */
-    bool ReloadPixels();
+    bool ReloadPixels(GlRingBuffer& ring);
 
 private:
 
@@ -85,7 +90,7 @@ private:
     void InitialiseFromPixels();
 
     /**
-    * Loads a texture from file
+    * Loads a texture from the decoded assets
     * @param type The type of texture to load
     * @param path The path to the texture
     */
@@ -94,6 +99,8 @@ private:
 private:
 
     const Texture& m_texture;       ///< Contains the texture data
+    AssetCache& m_assets;           ///< Decoded assets to upload from
     bool m_initialised = false;     ///< Whether this texture is initialised
     GLuint m_id = 0;                ///< Unique id for the texture
+    MemoryUsage m_textureMemory;    ///< Bytes held by the texture and its mipmaps
 };
@@ -5,6 +5,8 @@
 #include "attribute_model.h"
 #include "attribute.h"
 
+#include <algorithm>
+
 void AttributeModel::SetAttributes(const QVector<AttributeData>& attributeData)
 {
     beginResetModel();
@@ -16,9 +18,17 @@ void AttributeModel::SetAttributes(const QVector<AttributeData>& attributeData)
         m_attributes[data.index] = attribute;
         connect(attribute, &Attribute::ValueChanged, this, [this, index = data.index](float value)
             {
-                const auto modelIndex = this->index(index);
-                emit dataChanged(modelIndex, modelIndex, { Role::ValueRole });
-                emit AttributeValueChanged(index, value);
+                if (m_changingValues)
+                {
+                    m_firstChanged = m_firstChanged == -1 ? index : std::min(m_firstChanged, index);
+                    m_lastChanged = std::max(m_lastChanged, index);
+                }
+                else
+                {
+                    const auto modelIndex = this->index(index);
+                    emit dataChanged(modelIndex, modelIndex, { Role::ValueRole });
+                    emit AttributeValueChanged(index, value);
+                }
             });
     }
 
@@ -40,6 +50,22 @@ void AttributeModel::SetAttributeValue(int index, float value)
     m_attributes.at(index)->SetValue(value);
 }
 
+void AttributeModel::BeginValueChanges()
+{
+    m_changingValues = true;
+}
+
+void AttributeModel::EndValueChanges()
+{
+    m_changingValues = false;
+    if (m_firstChanged != -1)
+    {
+        emit dataChanged(index(m_firstChanged), index(m_lastChanged), { Role::ValueRole });
+        m_firstChanged = -1;
+        m_lastChanged = -1;
+    }
+}
+
 QHash<int, QByteArray> AttributeModel::roleNames() const
 {
     QHash<int, QByteArray> roles;
@@ -55,6 +55,13 @@ public:
     */
     void SetAttributeValue(int index, float value);
 
+    /**
+    * Starts setting values sent from the application. Views are notified once
+    * for all changed values when ended and the changes are not sent back
+    */
+    void BeginValueChanges();
+    void EndValueChanges();
+
     /**
     * Property setter/getter for the selected string index and item
     */
@@ -108,4 +115,7 @@ private:
 
     int m_selectedIndex = 0;           ///< Selected attribute index
     QVector<Attribute*> m_attributes;  ///< Attribute items for the model
+    bool m_changingValues = false;     ///< Whether values are being set from the application
+    int m_firstChanged = -1;           ///< First attribute changed while setting values
+    int m_lastChanged = -1;            ///< Last attribute changed while setting values
 };
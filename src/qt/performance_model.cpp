@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - performance_model.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "performance_model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /**
+    * @return whether the graph shows milliseconds rather than a count
+    */
+    bool IsTime(PerformanceModel::Graph graph)
+    {
+        return graph == PerformanceModel::Graph::FrameTime ||
+               graph == PerformanceModel::Graph::Simulation ||
+               graph == PerformanceModel::Graph::Submission ||
+               graph == PerformanceModel::Graph::GpuWait;
+    }
+}
+
+PerformanceModel::PerformanceModel(QObject* parent)
+    : QObject(parent)
+{
+    for (auto& graph : m_graphs)
+    {
+        graph.values.fill(0.0f);
+    }
+}
+
+float PerformanceModel::GetValue(Graph graph, const FrameStats& stats)
+{
+    switch (graph)
+    {
+    case Graph::FrameTime:
+        return stats.deltaTime * 1000.0f;
+    case Graph::Simulation:
+        return stats.times.simulation;
+    case Graph::Submission:
+        return stats.times.submission;
+    case Graph::GpuWait:
+        return stats.times.gpuWait;
+    case Graph::Instances:
+        return static_cast<float>(stats.sceneInstances);
+    case Graph::Particles:
+        return static_cast<float>(stats.aliveParticles);
+    case Graph::Patches:
+        return static_cast<float>(stats.patchesPlaced);
+    case Graph::Allocations:
+        return static_cast<float>(stats.allocations);
+    }
+    return 0.0f;
+}
+
+void PerformanceModel::AddFrames(const std::vector<FrameStats>& frames)
+{
+    if (frames.empty())
+    {
+        return;
+    }
+
+    for (const FrameStats& stats : frames)
+    {
+        for (int i = 0; i < static_cast<int>(Graph::Max); ++i)
+        {
+            m_graphs[i].values[m_next] = GetValue(static_cast<Graph>(i), stats);
+        }
+        m_next = (m_next + 1) % HISTORY;
+        m_count = std::min(m_count + 1, HISTORY);
+    }
+
+    for (int i = 0; i < static_cast<int>(Graph::Max); ++i)
+    {
+        UpdateReadout(static_cast<Graph>(i));
+    }
+
+    emit Updated();
+}
+
+void PerformanceModel::UpdateReadout(Graph graph)
+{
+    auto& history = m_graphs[static_cast<int>(graph)];
+
+    std::array<float, HISTORY> sorted;
+    const int first = m_count < HISTORY ? 0 : m_next;
+    for (int i = 0; i < m_count; ++i)
+    {
+        sorted[i] = history.values[(first + i) % HISTORY];
+    }
+    std::sort(sorted.begin(), sorted.begin() + m_count);
+
+    // Nearest rank of the sorted values
+    auto percentile = [&](float amount) -> float
+    {
+        const int rank = static_cast<int>(std::ceil(amount * m_count));
+        return sorted[std::max(0, std::min(rank, m_count) - 1)];
+    };
+
+    history.maximum = std::max(sorted[std::max(m_count - 1, 0)], 1.0f);
+    history.readout = IsTime(graph) ?
+        QString("95%: %1 / 99%: %2 ms").arg(percentile(0.95f), 0, 'f', 2).arg(percentile(0.99f), 0, 'f', 2) :
+        QString("95%: %1 / 99%: %2").arg(percentile(0.95f)).arg(percentile(0.99f));
+}
+
+QString PerformanceModel::graphName(Graph graph) const
+{
+    switch (graph)
+    {
+    case Graph::FrameTime:
+        return tr("Frame Time");
+    case Graph::Simulation:
+        return tr("Simulation");
+    case Graph::Submission:
+        return tr("Submission");
+    case Graph::GpuWait:
+        return tr("GPU Wait");
+    case Graph::Instances:
+        return tr("Instances");
+    case Graph::Particles:
+        return tr("Particles");
+    case Graph::Patches:
+        return tr("Patches Placed");
+    case Graph::Allocations:
+        return tr("Allocations");
+    }
+    Q_UNREACHABLE();
+    return QString();
+}
+
+QVariantList PerformanceModel::values(Graph graph) const
+{
+    const auto& history = m_graphs[static_cast<int>(graph)];
+    const int first = m_count < HISTORY ? 0 : m_next;
+
+    QVariantList values;
+    values.reserve(m_count);
+    for (int i = 0; i < m_count; ++i)
+    {
+        values.append(history.values[(first + i) % HISTORY]);
+    }
+    return values;
+}
+
+qreal PerformanceModel::maximum(Graph graph) const
+{
+    return m_graphs[static_cast<int>(graph)].maximum;
+}
+
+QString PerformanceModel::readout(Graph graph) const
+{
+    return m_graphs[static_cast<int>(graph)].readout;
+}
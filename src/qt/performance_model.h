@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - performance_model.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "telemetry.h"
+
+#include <QObject>
+#include <QVariantList>
+#include <array>
+
+/**
+* Model for graphs of the recent frames published through the telemetry
+*/
+class PerformanceModel : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    enum class Graph
+    {
+        FrameTime,
+        Simulation,
+        Submission,
+        GpuWait,
+        Instances,
+        Particles,
+        Patches,
+        Allocations,
+        Max
+    };
+    Q_ENUM(Graph)
+
+    /**
+    * Constructor
+    */
+    explicit PerformanceModel(QObject* parent = nullptr);
+
+    /**
+    * Adds the statistics of frames to the graphs
+    * @param frames The frames to add, oldest first
+    */
+    void AddFrames(const std::vector<FrameStats>& frames);
+
+    /**
+    * @return the name of the given graph
+    */
+    Q_INVOKABLE QString graphName(Graph graph) const;
+
+    /**
+    * @return the values held for the graph, oldest first
+    */
+    Q_INVOKABLE QVariantList values(Graph graph) const;
+
+    /**
+    * @return the largest value held for the graph
+    */
+    Q_INVOKABLE qreal maximum(Graph graph) const;
+
+    /**
+    * @return the 95th and 99th percentile of the values held for the graph
+    */
+    Q_INVOKABLE QString readout(Graph graph) const;
+
+signals:
+
+    void Updated();
+
+private:
+
+    /**
+    * @return the value for the graph from the statistics of a frame
+    */
+    static float GetValue(Graph graph, const FrameStats& stats);
+
+    /**
+    * Computes the maximum and percentiles for a graph
+    * @param graph The graph to update
+    */
+    void UpdateReadout(Graph graph);
+
+    static const int HISTORY = Telemetry::CAPACITY; ///< Number of frames held for each graph
+
+    /**
+    * Values held for a single graph
+    */
+    struct History
+    {
+        std::array<float, HISTORY> values;  ///< Ring of values, m_next is the oldest once full
+        float maximum = 1.0f;               ///< The largest value held
+        QString readout;                    ///< Percentiles of the values held
+    };
+
+    std::array<History, static_cast<int>(Graph::Max)> m_graphs; ///< Values held for each graph
+    int m_count = 0;                                            ///< Number of values held
+    int m_next = 0;                                             ///< Index to add the next value
+};
@@ -11,6 +11,7 @@
 #include "qt/attribute_model.h"
 #include "qt/attribute_filter_model.h"
 #include "qt/property_setter.h"
+#include "qt/performance_model.h"
 
 #include "logger.h"
 
@@ -19,6 +20,8 @@
 #include <QGuiApplication>
 #include <QQmlContext>
 #include <QQmlApplicationEngine>
+#include <QQuickWindow>
+#include <QScreen>
 #include <QTimer>
 #include <QQuickStyle>
 
@@ -57,13 +60,38 @@ void QtGui::Run(int argc, char *argv[])
     m_engine->load(QUrl("qrc:/TweakerWindow.qml"));
     m_engine->load(QUrl("qrc:/EditorWindow.qml"));
 
+    // Polls the cache at the display refresh while a window is shown. Changes reach
+    // the views through the models so a window only repaints when a value changed
+    auto pollEachRefresh = [this](QObject* object, void(QtGui::*update)())
+    {
+        if (auto window = qobject_cast<QQuickWindow*>(object))
+        {
+            const qreal refreshRate = window->screen() ? window->screen()->refreshRate() : 60.0;
+            auto timer = new QTimer(window);
+            timer->setInterval(static_cast<int>(1000.0 / refreshRate));
+            QObject::connect(timer, &QTimer::timeout, this, [this, window, update]()
+            {
+                if (window->isExposed())
+                {
+                    (this->*update)();
+                }
+            });
+            timer->start();
+        }
+    };
+
+    const auto windows = m_engine->rootObjects();
+    if (windows.size() == 2)
+    {
+        pollEachRefresh(windows[0], &QtGui::UpdateTweaker);
+        pollEachRefresh(windows[1], &QtGui::UpdateEditor);
+    }
+
+    // Polling stops while the windows are minimised so exiting is checked separately
     QTimer timer; 
-    timer.setInterval(10);
+    timer.setInterval(100);
     QObject::connect(&timer, &QTimer::timeout, this, [this, &timer]()
     { 
-        UpdateTweaker();
-        UpdateEditor();
-
         if (!m_cache->ApplicationRunning.Get())
         {
             timer.stop();
@@ -103,6 +131,26 @@ void QtGui::UpdateTweaker()
         UpdatePost();
         UpdateLight();
         break;
+    case Tweakable::GuiPage::Performance:
+        UpdatePerformance();
+        break;
+    }
+}
+
+template <size_t N>
+void QtGui::UpdateAttributes(AttributeModel* model, std::array<Lockable<float>, N>& values)
+{
+    if (model)
+    {
+        model->BeginValueChanges();
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (values[i].RequiresUpdate())
+            {
+                model->SetAttributeValue(i, values[i].GetUpdated());
+            }
+        }
+        model->EndValueChanges();
     }
 }
 
@@ -139,16 +187,7 @@ void QtGui::UpdatePost()
         }
     }
 
-    if (auto model = m_tweaker->PostAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Post::Max; ++i)
-        {
-            if (m_cache->Post[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Post[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->PostAttributeModel(), m_cache->Post);
 }
 
 void QtGui::UpdateScene()
@@ -162,21 +201,45 @@ void QtGui::UpdateScene()
         }
     }
 
-    if (auto model = m_tweaker->CameraAttributeModel())
+    UpdateAttributes(m_tweaker->CameraAttributeModel(), m_cache->Camera);
+
+    FrameStats stats;
+    if (m_cache->Stats.GetLatest(stats))
     {
-        for (int i = 0; i < Tweakable::Camera::Max; ++i)
-        {
-            if (m_cache->Camera[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Camera[i].GetUpdated());
-            }
-        }
+        m_tweaker->SetDeltaTime(stats.deltaTime);
+        m_tweaker->SetFramesPerSecond(stats.framesPerSec);
+        m_tweaker->SetBytesUploaded(stats.bytesUploaded);
     }
 
-    const float deltaTime = m_cache->DeltaTime.Get();
-    const int framesPerSec = m_cache->FramesPerSec.Get();
-    m_tweaker->SetDeltaTime(deltaTime);
-    m_tweaker->SetFramesPerSecond(framesPerSec);
+    if (m_cache->PassMetrics.RequiresUpdate())
+    {
+        m_tweaker->SetPassMetrics(QString::fromStdString(
+            m_cache->PassMetrics.GetUpdated()).split('\n'));
+    }
+
+    if (m_cache->MemoryTotals.RequiresUpdate())
+    {
+        m_tweaker->SetMemoryUsage(QString::fromStdString(
+            m_cache->MemoryTotals.GetUpdated()).split('\n'));
+    }
+
+    const FrameSummary summary = m_cache->Stats.Summarise();
+    m_tweaker->SetFrameTimes(QString("%1 / %2 / %3 ms")
+        .arg(summary.median, 0, 'f', 2)
+        .arg(summary.percentile95, 0, 'f', 2)
+        .arg(summary.percentile99, 0, 'f', 2));
+}
+
+void QtGui::UpdatePerformance()
+{
+    m_frames.clear();
+    m_framesRead = m_cache->Stats.GetSince(m_framesRead, m_frames);
+    m_tweaker->GetPerformanceModel()->AddFrames(m_frames);
+
+    if (m_cache->FrameBudget.RequiresUpdate())
+    {
+        m_tweaker->SetFrameBudget(m_cache->FrameBudget.GetUpdated());
+    }
 }
 
 void QtGui::UpdateTerrain()
@@ -190,26 +253,14 @@ void QtGui::UpdateTerrain()
         }
     }
 
-    if (auto model = m_tweaker->TerrainAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Terrain::Max; ++i)
-        {
-            if (m_cache->Terrain[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Terrain[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->TerrainAttributeModel(), m_cache->Terrain);
 
     if (m_cache->TerrainShader.RequiresUpdate())
     {
         m_tweaker->SetTerrainShader(QString::fromStdString(m_cache->TerrainShader.GetUpdated()));
     }
 
-    if (m_cache->TerrainInstances.RequiresUpdate())
-    {
-        m_tweaker->SetTerrainInstances(QString::fromStdString(m_cache->TerrainInstances.GetUpdated()));
-    }
+    m_tweaker->SetTerrainInstances(GetInstances(FrameStats::Terrain));
 }
 
 void QtGui::UpdateTextures()
@@ -223,16 +274,7 @@ void QtGui::UpdateTextures()
         }
     }
 
-    if (auto model = m_tweaker->TextureAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Texture::Max; ++i)
-        {
-            if (m_cache->Texture[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Texture[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->TextureAttributeModel(), m_cache->Texture);
 
     if (m_cache->TexturePath.RequiresUpdate())
     {
@@ -251,16 +293,7 @@ void QtGui::UpdateLight()
         }
     }
 
-    if (auto model = m_tweaker->LightAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Light::Max; ++i)
-        {
-            if (m_cache->Light[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Light[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->LightAttributeModel(), m_cache->Light);
 }
 
 void QtGui::UpdateMesh()
@@ -274,26 +307,14 @@ void QtGui::UpdateMesh()
         }
     }
 
-    if (auto model = m_tweaker->MeshAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Mesh::Max; ++i)
-        {
-            if (m_cache->Mesh[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Mesh[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->MeshAttributeModel(), m_cache->Mesh);
 
     if (m_cache->MeshShader.RequiresUpdate())
     {
         m_tweaker->SetMeshShader(QString::fromStdString(m_cache->MeshShader.GetUpdated()));
     }
 
-    if (m_cache->MeshInstances.RequiresUpdate())
-    {
-        m_tweaker->SetMeshInstances(QString::fromStdString(m_cache->MeshInstances.GetUpdated()));
-    }
+    m_tweaker->SetMeshInstances(GetInstances(FrameStats::Mesh));
 }
 
 void QtGui::UpdateEmitter()
@@ -307,21 +328,9 @@ void QtGui::UpdateEmitter()
         }
     }
 
-    if (auto model = m_tweaker->EmitterAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Emitter::Max; ++i)
-        {
-            if (m_cache->Emitter[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Emitter[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->EmitterAttributeModel(), m_cache->Emitter);
 
-    if (m_cache->EmitterInstances.RequiresUpdate())
-    {
-        m_tweaker->SetEmitterInstances(QString::fromStdString(m_cache->EmitterInstances.GetUpdated()));
-    }
+    m_tweaker->SetEmitterInstances(GetInstances(FrameStats::Emitter));
 }
 
 void QtGui::UpdateWater()
@@ -335,37 +344,33 @@ void QtGui::UpdateWater()
         }
     }
 
-    if (auto model = m_tweaker->WaterAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Water::Max; ++i)
-        {
-            if (m_cache->Water[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Water[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->WaterAttributeModel(), m_cache->Water);
 
-    if (auto model = m_tweaker->WaveAttributeModel())
-    {
-        for (int i = 0; i < Tweakable::Wave::Max; ++i)
-        {
-            if (m_cache->Wave[i].RequiresUpdate())
-            {
-                model->SetAttributeValue(i, m_cache->Wave[i].GetUpdated());
-            }
-        }
-    }
+    UpdateAttributes(m_tweaker->WaveAttributeModel(), m_cache->Wave);
 
     if (m_cache->WaveAmount.RequiresUpdate())
     {
         m_tweaker->SetWaveCount(m_cache->WaveAmount.GetUpdated());
     }
 
-    if (m_cache->WaterInstances.RequiresUpdate())
+    m_tweaker->SetWaterInstances(GetInstances(FrameStats::Water));
+}
+
+const QString& QtGui::GetInstances(FrameStats::Object object)
+{
+    FrameStats stats;
+    if (m_cache->Stats.GetLatest(stats))
     {
-        m_tweaker->SetWaterInstances(QString::fromStdString(m_cache->WaterInstances.GetUpdated()));
+        InstanceText& instances = m_instances[object];
+        if (instances.visible != stats.visibleInstances[object] ||
+            instances.total != stats.totalInstances[object])
+        {
+            instances.visible = stats.visibleInstances[object];
+            instances.total = stats.totalInstances[object];
+            instances.text = QString("%1 / %2").arg(instances.visible).arg(instances.total);
+        }
     }
+    return m_instances[object].text;
 }
 
 void QtGui::SetupConnections()
@@ -406,6 +411,14 @@ void QtGui::SetupConnections()
         [this]() { m_cache->ReloadPlacement.Set(true); });
     connect(m_tweaker.get(), &TweakerModel::RequestToggleWireframe, this,
         [this]() { m_cache->ToggleWireframe.Set(true); });
+    connect(m_tweaker.get(), &TweakerModel::RequestToggleMetricsExport, this,
+        [this]() { m_cache->ExportMetrics.Set(true); });
+    connect(m_tweaker.get(), &TweakerModel::RequestWriteMemoryReport, this,
+        [this]() { m_cache->WriteMemoryReport.Set(true); });
+    connect(m_tweaker.get(), &TweakerModel::RequestCaptureTrace, this,
+        [this]() { m_cache->CaptureTrace.Set(true); });
+    connect(m_tweaker.get(), &TweakerModel::FrameBudgetChanged, this,
+        [this]() { m_cache->FrameBudget.Set(static_cast<float>(m_tweaker->FrameBudget())); });
     connect(m_tweaker.get(), &TweakerModel::RequestTogglePauseEmission, this,
         [this]() { m_cache->PauseEmission.Set(true); });
     connect(m_tweaker.get(), &TweakerModel::RequestToggleLightsOnly, this,
@@ -413,83 +426,37 @@ void QtGui::SetupConnections()
     connect(m_tweaker.get(), &TweakerModel::RequestToggleLightsDiagnostics, this,
         [this]() { m_cache->LightDiagnostics.Set(true); });
 
-    for (int i = 0; i < Tweakable::Light::Max; ++i)
+    auto connectAttributes = [this](AttributeModel* model, TweakEvent::Object object)
     {
-        connect(m_tweaker->LightAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {  
-                m_cache->Light[attribute].Set(value); 
+        connect(model, &AttributeModel::AttributeValueChanged, this,
+            [this, object](int attribute, float value) {
+                SendTweak(object, attribute, value);
             });
-    }
-
-    for (int i = 0; i < Tweakable::Camera::Max; ++i)
-    {
-        connect(m_tweaker->CameraAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Camera[attribute].Set(value);
-            });
-    }
-
-    for (int i = 0; i < Tweakable::Mesh::Max; ++i)
-    {
-        connect(m_tweaker->MeshAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Mesh[attribute].Set(value);
-            });
-    }
-
-    for (int i = 0; i < Tweakable::Texture::Max; ++i)
-    {
-        connect(m_tweaker->TextureAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Texture[attribute].Set(value);
-                m_cache->ReloadTexture.Set(true);
-            });
-    }
-
-    for (int i = 0; i < Tweakable::Water::Max; ++i)
-    {
-        connect(m_tweaker->WaterAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Water[attribute].Set(value);
-            });
-    }
-
-    for (int i = 0; i < Tweakable::Wave::Max; ++i)
-    {
-        connect(m_tweaker->WaveAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Wave[attribute].Set(value);
-            });
-    }
-
-    for (int i = 0; i < Tweakable::Emitter::Max; ++i)
-    {
-        connect(m_tweaker->EmitterAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Emitter[attribute].Set(value);
-            });
-    }
+    };
+
+    connectAttributes(m_tweaker->LightAttributeModel(), TweakEvent::Light);
+    connectAttributes(m_tweaker->CameraAttributeModel(), TweakEvent::Camera);
+    connectAttributes(m_tweaker->MeshAttributeModel(), TweakEvent::Mesh);
+    connectAttributes(m_tweaker->TextureAttributeModel(), TweakEvent::Texture);
+    connectAttributes(m_tweaker->WaterAttributeModel(), TweakEvent::Water);
+    connectAttributes(m_tweaker->WaveAttributeModel(), TweakEvent::Wave);
+    connectAttributes(m_tweaker->EmitterAttributeModel(), TweakEvent::Emitter);
+    connectAttributes(m_tweaker->PostAttributeModel(), TweakEvent::Post);
+    connectAttributes(m_tweaker->TerrainAttributeModel(), TweakEvent::Terrain);
+}
 
-    for (int i = 0; i < Tweakable::Post::Max; ++i)
-    {
-        connect(m_tweaker->PostAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Post[attribute].Set(value);
-            });
-    }
+void QtGui::SendTweak(TweakEvent::Object object, int attribute, float value)
+{
+    TweakEvent event;
+    event.object = object;
+    event.attribute = attribute;
+    event.value = value;
 
-    for (int i = 0; i < Tweakable::Terrain::Max; ++i)
+    // If the application has fallen behind it reads all attributes from the cache
+    if (!m_cache->Tweaks.Push(event))
     {
-        connect(m_tweaker->TerrainAttributeModel(), &AttributeModel::AttributeValueChanged, this,
-            [this](int attribute, float value) {
-                m_cache->Terrain[attribute].Set(value);
-                if (attribute == Tweakable::Terrain::MaxHeight ||
-                    attribute == Tweakable::Terrain::MinHeight ||
-                    attribute == Tweakable::Terrain::Scale)
-                {
-                    m_cache->ReloadTerrain.Set(true);
-                }
-            });
+        m_cache->Attribute(object, attribute).Set(value);
+        m_cache->Tweaks.SetOverflowed();
     }
 }
 
@@ -497,6 +464,7 @@ void QtGui::RegisterQmlTypes()
 {
     const char* uri = "Application.Controls";
     qmlRegisterType<TweakerModel>(uri, 1, 0, "TabPage");
+    qmlRegisterType<PerformanceModel>(uri, 1, 0, "Graph");
     qmlRegisterType<Attribute>(uri, 1, 0, "Attribute");
     qmlRegisterType<StringListModel>(uri, 1, 0, "StringListModel");
     qmlRegisterType<AttributeModel>(uri, 1, 0, "AttributeModel");
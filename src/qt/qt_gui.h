@@ -7,8 +7,10 @@
 #include "cache.h"
 
 #include <QObject>
+#include <array>
 
 class TweakerModel;
+class AttributeModel;
 class EditorModel;
 class QtReloader;
 class QGuiApplication;
@@ -93,6 +95,19 @@ private:
     */
     void UpdatePost();
 
+    /**
+    * Updates the performance graphs with any new frames
+    */
+    void UpdatePerformance();
+
+    /**
+    * Sets any attribute values changed by the application into a model
+    * @param model The model to update
+    * @param values The cached values of the attributes
+    */
+    template <size_t N>
+    void UpdateAttributes(AttributeModel* model, std::array<Lockable<float>, N>& values);
+
     /**
     * Initializes connections between the models and application
     * @param editor The gui for editing shaders
@@ -100,6 +115,21 @@ private:
     */
     void SetupConnections();
 
+    /**
+    * Sends a change to an attribute to the application
+    * @param object The object the attribute belongs to
+    * @param attribute The attribute that changed
+    * @param value The new value of the attribute
+    */
+    void SendTweak(TweakEvent::Object object, int attribute, float value);
+
+    /**
+    * @param object The selected object to query
+    * @return the instances rendered of the object as of the latest frame
+    * @note the text is only rebuilt when the instances change
+    */
+    const QString& GetInstances(FrameStats::Object object);
+
     /**
     * Registers all classes to be used in QML
     */
@@ -114,4 +144,18 @@ private:
     std::unique_ptr<QtReloader> m_reloader;           ///< Allows reloading qml files
     std::shared_ptr<Cache> m_cache;                   ///< Shared data between the gui and application
     Tweakable::GuiPage::Page m_page;                  ///< Currently selected page of the gui
+    unsigned int m_framesRead = 0;                    ///< Frames published when the graphs were last updated
+    std::vector<FrameStats> m_frames;                 ///< Frames read for the graphs, kept to reuse memory
+
+    /**
+    * Instances of a selected object last displayed
+    */
+    struct InstanceText
+    {
+        int visible = -1;                             ///< Instances rendered
+        int total = -1;                               ///< Instances of the object
+        QString text;                                 ///< The instances as displayed
+    };
+
+    std::array<InstanceText, FrameStats::Max> m_instances; ///< Instances last displayed for each object
 };
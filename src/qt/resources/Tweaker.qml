@@ -24,6 +24,7 @@ Item {
             TabButton { text: TweakerModel.tabPageName(TabPage.Area)  }
             TabButton { text: TweakerModel.tabPageName(TabPage.Mesh)  }
             TabButton { text: TweakerModel.tabPageName(TabPage.Post)  }
+            TabButton { text: TweakerModel.tabPageName(TabPage.Performance) }
 
             onCurrentIndexChanged: {
                 TweakerModel.selectedPage = currentIndex
@@ -47,6 +48,8 @@ Item {
                         return meshComponent;
                     case TabPage.Post:
                         return postComponent;
+                    case TabPage.Performance:
+                        return performanceComponent;
                     }
                     return null;
                 }
@@ -75,6 +78,36 @@ Item {
                 Layout.fillWidth: true
             }
 
+            TweakerLabel {
+                headerText: qsTr("Frame Time 50/95/99%")
+                labelText: TweakerModel.frameTimes
+                Layout.fillWidth: true
+            }
+
+            TweakerLabel {
+                headerText: qsTr("Bytes Uploaded")
+                labelText: TweakerModel.bytesUploaded
+                Layout.fillWidth: true
+            }
+
+            Repeater {
+                model: TweakerModel.passMetrics
+                TweakerLabel {
+                    headerText: modelData.split(": ")[0]
+                    labelText: modelData.split(": ")[1]
+                    Layout.fillWidth: true
+                }
+            }
+
+            Repeater {
+                model: TweakerModel.memoryUsage
+                TweakerLabel {
+                    headerText: modelData.split(": ")[0]
+                    labelText: modelData.split(": ")[1]
+                    Layout.fillWidth: true
+                }
+            }
+
             TweakerListView {
                 model: TweakerModel.cameraAttributeModel
                 Layout.fillWidth: true
@@ -98,6 +131,18 @@ Item {
                 onClicked: TweakerModel.ReloadEngine()
                 Layout.fillWidth: true
             }
+
+            TweakerButton {
+                buttonText: qsTr("Toggle Metrics Export")
+                onClicked: TweakerModel.ToggleMetricsExport()
+                Layout.fillWidth: true
+            }
+
+            TweakerButton {
+                buttonText: qsTr("Write Memory Report")
+                onClicked: TweakerModel.WriteMemoryReport()
+                Layout.fillWidth: true
+            }
         }
     }
 
@@ -325,4 +370,49 @@ Item {
             }
         }
     }
+
+    Component {
+        id: performanceComponent
+        PageColumnLayout {
+            Repeater {
+                model: [Graph.FrameTime, Graph.Simulation, Graph.Submission, Graph.GpuWait,
+                    Graph.Instances, Graph.Particles, Graph.Patches, Graph.Allocations]
+
+                TweakerGraph {
+                    id: graph
+                    headerText: TweakerModel.performanceModel.graphName(modelData)
+                    values: TweakerModel.performanceModel.values(modelData)
+                    maximum: TweakerModel.performanceModel.maximum(modelData)
+                    readoutText: TweakerModel.performanceModel.readout(modelData)
+                    Layout.fillWidth: true
+
+                    Connections {
+                        target: TweakerModel.performanceModel
+                        onUpdated: {
+                            graph.maximum = TweakerModel.performanceModel.maximum(modelData)
+                            graph.values = TweakerModel.performanceModel.values(modelData)
+                            graph.readoutText = TweakerModel.performanceModel.readout(modelData)
+                        }
+                    }
+                }
+            }
+
+            TweakerSpinBox {
+                headerText: qsTr("Frame Budget (ms)")
+                value: TweakerModel.frameBudget
+                from: 1
+                to: 1000
+                Layout.fillWidth: true
+                onValueChanged: {
+                    TweakerModel.frameBudget = value
+                }
+            }
+
+            TweakerButton {
+                buttonText: qsTr("Capture Trace")
+                onClicked: TweakerModel.CaptureTrace()
+                Layout.fillWidth: true
+            }
+        }
+    }
 }
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - TweakerGraph.qml
+////////////////////////////////////////////////////////////////////////////////////////
+
+import QtQuick 2.9
+import QtQuick.Layouts 1.3
+import Application.Controls 1.0
+
+TweakerControl {
+    id: control
+    implicitHeight: 110
+
+    property alias headerText: header.text
+    property alias readoutText: readout.text
+    property var values: []
+    property real maximum: 1.0
+
+    onValuesChanged: canvas.requestPaint()
+
+    headerItem: ColumnLayout {
+        anchors.fill: parent
+        spacing: Theme.smallMargin
+
+        Text {
+            id: header
+            font.pixelSize: Theme.fontSize
+            Layout.fillWidth: true
+        }
+
+        Text {
+            id: readout
+            font.pixelSize: Theme.fontSize
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+        }
+
+        Item {
+            Layout.fillHeight: true
+        }
+    }
+
+    contentItem: Rectangle {
+        anchors.fill: parent
+        color: Theme.midlightColor
+        radius: Theme.radius
+
+        Canvas {
+            id: canvas
+            anchors.fill: parent
+            anchors.margins: Theme.smallMargin
+
+            onPaint: {
+                var ctx = getContext("2d");
+                ctx.clearRect(0, 0, width, height);
+
+                var count = control.values.length;
+                if (count < 2 || control.maximum <= 0) {
+                    return;
+                }
+
+                // Newest value is on the right
+                var step = width / (count - 1);
+                ctx.strokeStyle = Theme.darkColor;
+                ctx.lineWidth = 1;
+                ctx.beginPath();
+                for (var i = 0; i < count; ++i) {
+                    var y = height - (control.values[i] / control.maximum) * height;
+                    if (i === 0) {
+                        ctx.moveTo(0, y);
+                    } else {
+                        ctx.lineTo(i * step, y);
+                    }
+                }
+                ctx.stroke();
+            }
+        }
+    }
+}
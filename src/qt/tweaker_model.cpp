@@ -6,6 +6,7 @@
 #include "attribute_model.h"
 #include "attribute_filter_model.h"
 #include "stringlist_model.h"
+#include "performance_model.h"
 #include "logger.h"
 
 #include <QFileInfo>
@@ -18,6 +19,7 @@ namespace
     static_assert((int)GuiPage::Area  == (int)TweakerModel::TabPage::Area,  "Enums must match");
     static_assert((int)GuiPage::Post  == (int)TweakerModel::TabPage::Post,  "Enums must match");
     static_assert((int)GuiPage::Mesh  == (int)TweakerModel::TabPage::Mesh,  "Enums must match");
+    static_assert((int)GuiPage::Performance == (int)TweakerModel::TabPage::Performance, "Enums must match");
 
     template<typename T>
     AttributeModel::AttributeData createAttribute(typename T::Attribute attribute, 
@@ -59,6 +61,7 @@ TweakerModel::TweakerModel(QObject* parent)
     , m_postAttributeFilterModel(new AttributeFilterModel(this))
     , m_postCorrectionAttributeFilterModel(new AttributeFilterModel(this))
     , m_postFogAttributeFilterModel(new AttributeFilterModel(this))
+    , m_performanceModel(new PerformanceModel(this))
 {
     m_cameraAttributeModel->SetAttributes(
     {
@@ -424,6 +427,11 @@ StringListModel* TweakerModel::WavesModel() const
     return m_wavesModel;
 }
 
+PerformanceModel* TweakerModel::GetPerformanceModel() const
+{
+    return m_performanceModel;
+}
+
 void TweakerModel::SetWaveCount(int count)
 {
     if (m_waveCount != count)
@@ -438,10 +446,27 @@ int TweakerModel::WaveCount() const
     return m_waveCount;
 }
 
+void TweakerModel::SetFrameBudget(qreal budget)
+{
+    if (m_frameBudget != budget)
+    {
+        m_frameBudget = budget;
+        emit FrameBudgetChanged();
+    }
+}
+
+qreal TweakerModel::FrameBudget() const
+{
+    return m_frameBudget;
+}
+
 void TweakerModel::SetDeltaTime(float deltaTime)
 {
-    m_deltaTime = deltaTime;
-    emit DeltaTimeChanged();
+    if (m_deltaTime != deltaTime)
+    {
+        m_deltaTime = deltaTime;
+        emit DeltaTimeChanged();
+    }
 }
 
 QString TweakerModel::DeltaTime() const
@@ -449,6 +474,20 @@ QString TweakerModel::DeltaTime() const
     return QLocale().toString(m_deltaTime, 'f', 8);
 }
 
+void TweakerModel::SetFrameTimes(const QString& times)
+{
+    if (m_frameTimes != times)
+    {
+        m_frameTimes = times;
+        emit FrameTimesChanged();
+    }
+}
+
+const QString& TweakerModel::FrameTimes() const
+{
+    return m_frameTimes;
+}
+
 void TweakerModel::SetFramesPerSecond(int fps)
 {
     if (m_framesPerSecond != fps)
@@ -463,6 +502,48 @@ int TweakerModel::FramesPerSecond() const
     return m_framesPerSecond;
 }
 
+void TweakerModel::SetBytesUploaded(int bytes)
+{
+    if (m_bytesUploaded != bytes)
+    {
+        m_bytesUploaded = bytes;
+        emit BytesUploadedChanged();
+    }
+}
+
+int TweakerModel::BytesUploaded() const
+{
+    return m_bytesUploaded;
+}
+
+void TweakerModel::SetPassMetrics(const QStringList& metrics)
+{
+    if (m_passMetrics != metrics)
+    {
+        m_passMetrics = metrics;
+        emit PassMetricsChanged();
+    }
+}
+
+const QStringList& TweakerModel::PassMetrics() const
+{
+    return m_passMetrics;
+}
+
+void TweakerModel::SetMemoryUsage(const QStringList& usage)
+{
+    if (m_memoryUsage != usage)
+    {
+        m_memoryUsage = usage;
+        emit MemoryUsageChanged();
+    }
+}
+
+const QStringList& TweakerModel::MemoryUsage() const
+{
+    return m_memoryUsage;
+}
+
 void TweakerModel::SetMeshShader(const QString& shader)
 {
     if (m_meshShader != shader)
@@ -607,6 +688,21 @@ void TweakerModel::ToggleLightsDiagnostics()
     emit RequestToggleLightsDiagnostics();
 }
 
+void TweakerModel::ToggleMetricsExport()
+{
+    emit RequestToggleMetricsExport();
+}
+
+void TweakerModel::WriteMemoryReport()
+{
+    emit RequestWriteMemoryReport();
+}
+
+void TweakerModel::CaptureTrace()
+{
+    emit RequestCaptureTrace();
+}
+
 QString TweakerModel::tabPageName(TabPage page) const
 {
     switch (page)
@@ -619,6 +715,8 @@ QString TweakerModel::tabPageName(TabPage page) const
         return tr("Mesh");
     case TabPage::Post:
         return tr("Post");
+    case TabPage::Performance:
+        return tr("Performance");
     }
     Q_UNREACHABLE();
     return QString();
@@ -7,12 +7,14 @@
 #include "tweakable_enums.h"
 
 #include <QObject>
+#include <QStringList>
 
 using namespace Tweakable;
 
 class AttributeModel;
 class AttributeFilterModel;
 class StringListModel;
+class PerformanceModel;
 
 /**
 * Allows run-time editing of the scene
@@ -23,8 +25,13 @@ class TweakerModel : public QObject
 
     Q_PROPERTY(TabPage selectedPage READ SelectedPage WRITE SetSelectedPage NOTIFY SelectedPageChanged)
     Q_PROPERTY(int waveCount READ WaveCount WRITE SetWaveCount NOTIFY WaveCountChanged)
+    Q_PROPERTY(qreal frameBudget READ FrameBudget WRITE SetFrameBudget NOTIFY FrameBudgetChanged)
     Q_PROPERTY(int framesPerSecond READ FramesPerSecond NOTIFY FramesPerSecondChanged)
+    Q_PROPERTY(int bytesUploaded READ BytesUploaded NOTIFY BytesUploadedChanged)
+    Q_PROPERTY(QStringList passMetrics READ PassMetrics NOTIFY PassMetricsChanged)
+    Q_PROPERTY(QStringList memoryUsage READ MemoryUsage NOTIFY MemoryUsageChanged)
     Q_PROPERTY(QString deltaTime READ DeltaTime NOTIFY DeltaTimeChanged)
+    Q_PROPERTY(QString frameTimes READ FrameTimes NOTIFY FrameTimesChanged)
     Q_PROPERTY(QString waterInstances READ WaterInstances NOTIFY WaterInstancesChanged)
     Q_PROPERTY(QString emitterInstances READ EmitterInstances NOTIFY EmitterInstancesChanged)
     Q_PROPERTY(QString meshInstances READ MeshInstances NOTIFY MeshInstancesChanged)
@@ -42,6 +49,7 @@ class TweakerModel : public QObject
     Q_PROPERTY(StringListModel* waterModel READ WaterModel CONSTANT)
     Q_PROPERTY(StringListModel* lightsModel READ LightsModel CONSTANT)
     Q_PROPERTY(StringListModel* wavesModel READ WavesModel CONSTANT)
+    Q_PROPERTY(PerformanceModel* performanceModel READ GetPerformanceModel CONSTANT)
 
     Q_PROPERTY(AttributeModel* meshAttributeModel READ MeshAttributeModel CONSTANT)
     Q_PROPERTY(AttributeModel* waveAttributeModel READ WaveAttributeModel CONSTANT)
@@ -68,7 +76,8 @@ public:
         Scene,
         Area,
         Mesh,
-        Post
+        Post,
+        Performance
     };
     Q_ENUM(TabPage)
 
@@ -88,18 +97,48 @@ public:
     void SetWaveCount(int count);
     int WaveCount() const;
 
+    /**
+    * Property setter/getter for the milliseconds a frame can take before it is recorded
+    */
+    void SetFrameBudget(qreal budget);
+    qreal FrameBudget() const;
+
     /**
     * Property setter/getter for the time passed in seconds between ticks
     */
     void SetDeltaTime(float deltaTime);
     QString DeltaTime() const;
 
+    /**
+    * Property setter/getter for the frame time percentiles of the recent frames
+    */
+    void SetFrameTimes(const QString& times);
+    const QString& FrameTimes() const;
+
     /**
     * Property setter/getter for the frames per second for the application
     */
     void SetFramesPerSecond(int fps);
     int FramesPerSecond() const;
 
+    /**
+    * Property setter/getter for the bytes uploaded to the gpu during the last frame
+    */
+    void SetBytesUploaded(int bytes);
+    int BytesUploaded() const;
+
+    /**
+    * Property setter/getter for the calls counted for each render pass
+    */
+    void SetPassMetrics(const QStringList& metrics);
+    const QStringList& PassMetrics() const;
+
+    /**
+    * Property setter/getter for the memory used by each subsystem
+    */
+    void SetMemoryUsage(const QStringList& usage);
+    const QStringList& MemoryUsage() const;
+
     /**
     * Property setter/getter for the shader used for the selected mesh
     */
@@ -188,6 +227,11 @@ public:
     StringListModel* LightsModel() const;
     StringListModel* WavesModel() const;
 
+    /**
+    * @return the model for graphs of the recent frames
+    */
+    PerformanceModel* GetPerformanceModel() const;
+
     /**
     * QML Accessors for emitting signal requests
     */
@@ -200,13 +244,21 @@ public:
     Q_INVOKABLE void TogglePauseEmission();
     Q_INVOKABLE void ToggleLightsOnly();
     Q_INVOKABLE void ToggleLightsDiagnostics();
+    Q_INVOKABLE void ToggleMetricsExport();
+    Q_INVOKABLE void WriteMemoryReport();
+    Q_INVOKABLE void CaptureTrace();
 
 signals:
 
     void SelectedPageChanged();
     void DeltaTimeChanged();
+    void FrameTimesChanged();
     void FramesPerSecondChanged();
+    void BytesUploadedChanged();
+    void PassMetricsChanged();
+    void MemoryUsageChanged();
     void WaveCountChanged();
+    void FrameBudgetChanged();
     void WaterInstancesChanged();
     void EmitterInstancesChanged();
     void MeshInstancesChanged();
@@ -224,12 +276,20 @@ signals:
     void RequestTogglePauseEmission();
     void RequestToggleLightsOnly();
     void RequestToggleLightsDiagnostics();
+    void RequestToggleMetricsExport();
+    void RequestWriteMemoryReport();
+    void RequestCaptureTrace();
 
 private:
 
     float m_deltaTime = 0.0f;    ///< The time passed in seconds between ticks
     int m_framesPerSecond = 0;   ///< The frames per second for the application
+    int m_bytesUploaded = 0;     ///< The bytes uploaded to the gpu during the last frame
+    QStringList m_passMetrics;   ///< Calls counted for each render pass
+    QStringList m_memoryUsage;   ///< Memory used by each subsystem
     int m_waveCount = 0;         ///< The amount of waves for the selected water
+    qreal m_frameBudget = 0.0;   ///< Milliseconds a frame can take before it is recorded
+    QString m_frameTimes;        ///< Frame time percentiles of the recent frames
     QString m_waterInstances;    ///< Number of instances of the selected water
     QString m_emitterInstances;  ///< Number of instances of the selected emitter
     QString m_meshInstances;     ///< Number of instances of the selected mesh
@@ -250,6 +310,8 @@ private:
     StringListModel* m_terrainModel = nullptr;
     StringListModel* m_postMapsModel = nullptr;
 
+    PerformanceModel* m_performanceModel = nullptr; ///< Graphs of the recent frames
+
     ///< Models for tweakable attributes for a list
     AttributeModel* m_cameraAttributeModel = nullptr;
     AttributeModel* m_meshAttributeModel = nullptr;
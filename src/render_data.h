@@ -26,6 +26,8 @@ constexpr int BLUR_TEXTURES = 1;    ///< Number of textures attached to the effe
 constexpr int SCENE_ID = 0;         ///< ID of the texture displaying the scene
 constexpr int DEPTH_ID = 1;         ///< ID of the texture displaying the depth information
 constexpr int BLUR_ID = 0;          ///< ID of the texture displaying the blur
+constexpr int UPLOAD_FRAMES = 3;    ///< Number of frames in flight for dynamic uploads
+constexpr int UPLOAD_FRAME_BYTES = 4 * 1024 * 1024; ///< Bytes available per frame for dynamic uploads
 
 /**
 * Supported Render Engines
@@ -36,6 +38,7 @@ namespace RenderingEngine
     {
         OpenGL,
         DirectX,
+        Software,
         Max
     };
 }
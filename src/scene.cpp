@@ -7,6 +7,7 @@
 #include "scene_data.h"
 #include "scene_placer.h"
 #include "scene_builder.h"
+#include "shader_watcher.h"
 
 Scene::Scene() = default;
 Scene::~Scene() = default;
@@ -56,16 +57,24 @@ const MeshData& Scene::Shadows() const
     return *m_data->shadows;
 }
 
+AssetCache& Scene::Assets() const
+{
+    return *m_data->assets;
+}
+
 void Scene::SetPostMap(int index)
 {
     m_data->post->SetPostMap(static_cast<PostProcessing::Map>(index));
 }
 
 void Scene::Tick(float deltatime, const Camera& camera)
+{
+    Tick(deltatime, camera.Position(), camera.GetBounds());
+}
+
+void Scene::Tick(float deltatime, const Float3& position, const BoundingArea& bounds)
 {
     const int causticsTexture = m_data->caustics->GetFrame();
-    const Float3& position = camera.Position();
-    const BoundingArea& bounds = camera.GetBounds();
 
     m_data->diagnostics->Tick();
     m_data->caustics->Tick(deltatime);
@@ -93,6 +102,31 @@ void Scene::Tick(float deltatime, const Camera& camera)
     }
 }
 
+void Scene::Publish()
+{
+    m_data->shadows->Publish();
+
+    for (auto& emitter : m_data->emitters)
+    {
+        emitter->Publish();
+    }
+
+    for (auto& mesh : m_data->meshes)
+    {
+        mesh->Publish();
+    }
+
+    for (auto& terrain : m_data->terrain)
+    {
+        terrain->Publish();
+    }
+
+    for (auto& water : m_data->water)
+    {
+        water->Publish();
+    }
+}
+
 void Scene::PostTick()
 {
     m_data->shadows->PostTick();
@@ -132,8 +166,16 @@ bool Scene::Initialise(const Float3& camera)
             m_data->diagnostics->AddInstance(*light, scale);
         }
 
+        // Editing shaders is optional so the scene can run without watching
+        m_watcher = std::make_unique<ShaderWatcher>(*m_data);
+        m_watcher->Initialise();
+
         m_placer = std::make_unique<ScenePlacer>(*m_data);
-        return m_placer->Initialise(camera);
+        if (m_placer->Initialise(camera))
+        {
+            Publish();
+            return true;
+        }
     }
     return false;
 }
@@ -158,6 +200,26 @@ void Scene::Reload()
     ReloadPlacement();
 }
 
+void Scene::ReleaseGeometry()
+{
+    for (auto& mesh : m_data->meshes)
+    {
+        mesh->ReleaseGeometry(*m_data->geometry);
+    }
+    m_data->shadows->ReleaseGeometry(*m_data->geometry);
+}
+
+bool Scene::FetchGeometry()
+{
+    bool success = true;
+    for (auto& mesh : m_data->meshes)
+    {
+        success &= mesh->FetchGeometry(*m_data->geometry);
+    }
+    success &= m_data->shadows->FetchGeometry(*m_data->geometry);
+    return success;
+}
+
 void Scene::ReloadTexture(int ID)
 {
     m_data->textures[ID]->Reload();
@@ -167,3 +229,8 @@ void Scene::ReloadTerrain(int ID)
 {
     m_data->terrain[ID]->Reload();
 }
+
+std::vector<int> Scene::GetReloadedShaders()
+{
+    return m_watcher ? m_watcher->GetReloadedShaders() : std::vector<int>();
+}
@@ -13,7 +13,9 @@ class Camera;
 class SceneBuilder;
 class SceneModifier;
 class ScenePlacer;
+class ShaderWatcher;
 struct SceneData;
+struct BoundingArea;
 
 /**
 * Manager and owner of all objects and diagnostics
@@ -32,11 +34,25 @@ public:
     */
     void Tick(float deltatime, const Camera& camera);
 
+    /**
+    * Ticks the scene
+    * @param deltatime The time passed between ticks
+    * @param position The world position of the camera
+    * @param bounds Bounding area in front of the camera
+    */
+    void Tick(float deltatime, const Float3& position, const BoundingArea& bounds);
+
     /**
     * Post ticks the scene
     */
     void PostTick();
 
+    /**
+    * Copies the simulated state into the snapshot read by the render engines
+    * @note must not be called while the scene is ticking or rendering
+    */
+    void Publish();
+
     /**
     * @return the meshes in the scene
     */
@@ -82,6 +98,11 @@ public:
     */
     virtual const MeshData& Shadows() const override;
 
+    /**
+    * @return the decoded assets shared by all render engines
+    */
+    virtual AssetCache& Assets() const override;
+
     /**
     * Sets which post map will currently be rendered
     * @param index The index for the map to render
@@ -110,6 +131,18 @@ public:
     */
     void ReloadPlacement();
 
+    /**
+    * Drops the geometry of static meshes from memory once uploaded
+    * @note terrain and water keep their geometry as they are edited
+    */
+    void ReleaseGeometry();
+
+    /**
+    * Reads any released geometry back into memory
+    * @return whether all geometry is in memory
+    */
+    bool FetchGeometry();
+
     /**
     * Reloads the texture
     * @param ID The ID of the texture to reload
@@ -122,9 +155,16 @@ public:
     */
     void ReloadTerrain(int ID);
 
+    /**
+    * Takes the shaders regenerated from edited base shaders
+    * @return the index of each shader requiring recompilation
+    */
+    std::vector<int> GetReloadedShaders();
+
 private:
 
     std::unique_ptr<SceneData> m_data;         ///< Elements of the scene
     std::unique_ptr<SceneBuilder> m_builder;   ///< Creates meshes, lighting and shader data
     std::unique_ptr<ScenePlacer> m_placer;    ///< Updates the scene depending on the camera
+    std::unique_ptr<ShaderWatcher> m_watcher; ///< Regenerates shaders when base shaders are edited
 };          
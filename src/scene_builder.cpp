@@ -5,8 +5,12 @@
 #include "scene_builder.h"
 #include "scene_data.h"
 #include "fragmentlinker.h"
+#include "software_worker_pool.h"
+#include "shader_validator.h"
 #include "logger.h"
 
+#include <chrono>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/assign.hpp>
 
@@ -84,23 +88,28 @@ bool SceneBuilder::InitialiseShaders()
     bool success = true;
     m_data.shaders.resize(ShaderIndex::Max);
 
-    FragmentLinker linker;
-    linker.Initialise(Water::Wave::MAX, m_data.lights.size(), m_data.post->GetBlurWeights());
-
-    success &= InitialiseShader(linker, "post_effects", Shader::None, ShaderIndex::Post);
-    success &= InitialiseShader(linker, "pre_effects", Shader::None, ShaderIndex::Pre);
-    success &= InitialiseShader(linker, "blur_vertical", Shader::None, ShaderIndex::BlurVertical);
-    success &= InitialiseShader(linker, "blur_horizontal", Shader::None, ShaderIndex::BlurHorizontal);
-    success &= InitialiseShader(linker, "water", Shader::None, ShaderIndex::Water);
-    success &= InitialiseShader(linker, "particle", Shader::None, ShaderIndex::Particle);
-    success &= InitialiseShader(linker, "diagnostic", Shader::None, ShaderIndex::Diagnostic);
-    success &= InitialiseShader(linker, "shadow", Shader::None, ShaderIndex::Shadow);
-    success &= InitialiseShader(linker, "bump", Shader::Bump);
-    success &= InitialiseShader(linker, "specular", Shader::Specular);
-    success &= InitialiseShader(linker, "diffusecaustics", Shader::Caustics);
-    success &= InitialiseShader(linker, "flat", Shader::Flat);
-    success &= InitialiseShader(linker, "bumpcaustics", Shader::Caustics|Shader::Bump);
-    success &= InitialiseShader(linker, "bumpspecular", Shader::Specular |Shader::Bump);
+    success &= InitialiseShader("post_effects", Shader::None, ShaderIndex::Post);
+    success &= InitialiseShader("pre_effects", Shader::None, ShaderIndex::Pre);
+    success &= InitialiseShader("blur_vertical", Shader::None, ShaderIndex::BlurVertical);
+    success &= InitialiseShader("blur_horizontal", Shader::None, ShaderIndex::BlurHorizontal);
+    success &= InitialiseShader("water", Shader::None, ShaderIndex::Water);
+    success &= InitialiseShader("particle", Shader::None, ShaderIndex::Particle);
+    success &= InitialiseShader("diagnostic", Shader::None, ShaderIndex::Diagnostic);
+    success &= InitialiseShader("shadow", Shader::None, ShaderIndex::Shadow);
+    success &= InitialiseShader("bump", Shader::Bump);
+    success &= InitialiseShader("specular", Shader::Specular);
+    success &= InitialiseShader("diffusecaustics", Shader::Caustics);
+    success &= InitialiseShader("flat", Shader::Flat);
+    success &= InitialiseShader("bumpcaustics", Shader::Caustics|Shader::Bump);
+    success &= InitialiseShader("bumpspecular", Shader::Specular |Shader::Bump);
+    success &= GenerateShaders();
+
+    // Invalid shaders are reported but left for the engines to compile
+    ShaderValidator validator;
+    if (validator.Initialise())
+    {
+        validator.Validate(m_data.shaders);
+    }
     return success;
 }
 
@@ -443,31 +452,76 @@ bool SceneBuilder::InitialiseCaustics()
     return true;
 }
 
-bool SceneBuilder::InitialiseShader(FragmentLinker& linker,
-                                    const std::string& name, 
+bool SceneBuilder::InitialiseShader(const std::string& name, 
                                     unsigned int components,
                                     int index)
 {
     if (index == -1)
     {
-        index = m_data.shaders.size();
         m_data.shaders.push_back(std::make_unique<Shader>(name, components, true));
     }
     else
     {
         m_data.shaders[index] = std::make_unique<Shader>(name, components, false);
     }
+    return true;
+}
 
-    if (!linker.GenerateShader(*m_data.shaders[index]))
+bool SceneBuilder::GenerateShaders()
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    const auto totalStart = Clock::now();
+
+    FragmentLinker linker;
+    if (!linker.Initialise(Water::Wave::MAX, m_data.lights.size(), m_data.post->GetBlurWeights()))
     {
-        Logger::LogError("Could not generate shader " + name);
+        Logger::LogError("Could not initialise fragment linker");
         return false;
     }
-    else
+
+    // Each shader writes only its own generated files so the output
+    // does not depend on the order the workers finish in
+    const int count = static_cast<int>(m_data.shaders.size());
+    std::vector<char> generated(count, 0);
+    std::vector<double> times(count, 0.0);
+
+    SwWorkerPool workers;
+    workers.Initialise();
+    workers.Run(count, [&](int index)
     {
-        Logger::LogInfo("Shader: " + name + " loaded");
-        return true;
+        const auto start = Clock::now();
+        generated[index] = linker.GenerateShader(*m_data.shaders[index]) ? 1 : 0;
+        times[index] = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    });
+    const int threads = workers.GetThreadCount();
+    workers.Release();
+
+    bool success = linker.SaveManifest();
+
+    // Logged once all are generated to keep the log in shader order
+    for (int i = 0; i < count; ++i)
+    {
+        const std::string& name = m_data.shaders[i]->Name();
+        if (generated[i])
+        {
+            Logger::LogInfo("Shader: " + name + " loaded in " + 
+                std::to_string(times[i]) + "ms");
+        }
+        else
+        {
+            Logger::LogError("Could not generate shader " + name);
+            success = false;
+        }
     }
+
+    const double totalTime = std::chrono::duration<double, std::milli>(
+        Clock::now() - totalStart).count();
+
+    Logger::LogInfo("Shaders: " + std::to_string(count) + " generated in " +
+        std::to_string(totalTime) + "ms across " + 
+        std::to_string(threads) + " threads");
+
+    return success;
 }
 
 bool SceneBuilder::InitialiseTexture(const std::string& name, 
@@ -533,7 +587,7 @@ bool SceneBuilder::InitialiseEmitter(const std::string& name,
         emitter.AddTexture(texture);
     }
 
-    return emitter.Initialise(data);
+    return emitter.Initialise(data, *m_data.arena);
 }
 
 Terrain& SceneBuilder::InitialiseTerrain(const std::string& name,
@@ -12,7 +12,6 @@ class Light;
 class Shader;
 class Terrain;
 class MeshData;
-class FragmentLinker;
 struct EmitterData;
 struct SceneData;
 
@@ -145,18 +144,22 @@ private:
                                float spacing,
                                int size);
     /**
-    * Initialises a shader
-    * @param linker the generator for shaders
+    * Initialises a shader to be generated
     * @param name the filename of the shader
     * @param components What the shader is made up of
     * @param index The index to add the shader at
     * @return Whether the initialization was successful
     */
-    bool InitialiseShader(FragmentLinker& linker,
-                          const std::string& name, 
+    bool InitialiseShader(const std::string& name, 
                           unsigned int components,
                           int index = -1);
 
+    /**
+    * Generates all initialised shaders across a pool of workers
+    * @return Whether all shaders were generated successfully
+    */
+    bool GenerateShaders();
+
     /**
     * Initialises the caustics animation
     * @return Whether the initialization was successful
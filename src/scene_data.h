@@ -14,6 +14,9 @@
 #include "postprocessing.h"
 #include "diagnostic.h"
 #include "mesh_group.h"
+#include "asset_cache.h"
+#include "arena.h"
+#include "geometry_store.h"
 
 /**
 * Internal data for the scene
@@ -24,10 +27,16 @@ struct SceneData
     * Constructor
     */
     SceneData() :
-        post(std::make_unique<PostProcessing>())
+        arena(std::make_unique<Arena>(Memory::SceneArena, ARENA_BLOCK_SIZE)),
+        post(std::make_unique<PostProcessing>()),
+        assets(std::make_unique<AssetCache>()),
+        geometry(std::make_unique<GeometryStore>("GeometryStore.bin"))
     {
     }
 
+    static const size_t ARENA_BLOCK_SIZE = 1024 * 1024;  ///< Bytes of each scene arena block
+
+    std::unique_ptr<Arena> arena;                      ///< Load time data living as long as the scene
     std::vector<std::unique_ptr<Shader>> shaders;      ///< All shaders in the scene
     std::vector<std::unique_ptr<Mesh>> meshes;         ///< All meshes in the scene
     std::vector<std::unique_ptr<Light>> lights;        ///< All lights in the scene
@@ -39,6 +48,8 @@ struct SceneData
     std::unique_ptr<Diagnostic> diagnostics;           ///< Scene diagnostics
     std::unique_ptr<PostProcessing> post;              ///< Data for post processing
     std::unique_ptr<MeshData> shadows;                 ///< Shadow instances
+    std::unique_ptr<AssetCache> assets;                ///< Decoded assets shared by the engines
+    std::unique_ptr<GeometryStore> geometry;           ///< Geometry of meshes released from memory
     std::vector<unsigned int> proceduralTextures;      ///< Indices of all editable textures
     std::vector<MeshGroup> foliage;                    ///< Available foliage for placing in scene
     std::vector<InstanceKey> rocks;                    ///< Avaliable rocks for placing in scene
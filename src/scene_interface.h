@@ -16,6 +16,7 @@ class Terrain;
 class Texture;
 class PostProcessing;
 class Emitter;
+class AssetCache;
 
 /**
 * Allows access to the elements of the scene
@@ -70,4 +71,9 @@ public:
     * @return the shadow instances for meshes
     */
     virtual const MeshData& Shadows() const = 0;
+
+    /**
+    * @return the decoded assets shared by all render engines
+    */
+    virtual AssetCache& Assets() const = 0;
 };           
@@ -6,6 +6,9 @@
 #include "scene_data.h"
 #include "random_generator.h"
 #include "logger.h"
+#include "metrics.h"
+#include "flight_recorder.h"
+#include "arena.h"
 
 namespace
 {
@@ -21,6 +24,7 @@ ScenePlacer::ScenePlacer(SceneData& data)
     , m_meshMinScale(0.75f)
     , m_meshMaxScale(2.0f)
     , m_rockOffset(1.0f)
+    , m_replacedMetric(Metrics::AddCounter("Patches Re-placed"))
 {
     const int patchAmount = 81;
     const int minPatchAmount = 9;
@@ -33,7 +37,6 @@ ScenePlacer::ScenePlacer(SceneData& data)
 
     m_patchData.resize(patchAmount);
     m_patches.resize(patchAmount);
-    m_previous.resize(patchAmount);
 
     m_patchPerRow = static_cast<int>(
         std::sqrt(static_cast<double>(patchAmount)));
@@ -113,15 +116,17 @@ void ScenePlacer::Update(const Float3& cameraPosition)
 
 void ScenePlacer::ShiftPatches(const Int2& direction)
 {
+    FlightRecorder::Record(FlightRecorder::PatchShift, "%d, %d", direction.x, direction.y);
+
     const int maxIndex = m_patchPerRow - 1;
-    m_previous = m_patches;
+    const ScratchVector<int> previous(m_patches.begin(), m_patches.end());
 
     if (direction.x > 0)
     {
         // Shift the bottom row to the top
         for (int c = 0; c < m_patchPerRow; ++c)
         {
-            m_patches[Index(0, c)] = m_previous[Index(maxIndex, c)];
+            m_patches[Index(0, c)] = previous[Index(maxIndex, c)];
         }
 
         // Move all other rows down
@@ -129,7 +134,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         {
             for (int c = 0; c < m_patchPerRow; ++c)
             {
-                m_patches[Index(r+1, c)] = m_previous[Index(r, c)];
+                m_patches[Index(r+1, c)] = previous[Index(r, c)];
             }
         }
 
@@ -144,7 +149,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         // Shift the top row to the bottom
         for (int c = 0; c < m_patchPerRow; ++c)
         {
-            m_patches[Index(maxIndex, c)] = m_previous[Index(0, c)];
+            m_patches[Index(maxIndex, c)] = previous[Index(0, c)];
         }
 
         // Move all other rows up
@@ -152,7 +157,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         {
             for (int c = 0; c < m_patchPerRow; ++c)
             {
-                m_patches[Index(r-1, c)] = m_previous[Index(r, c)];
+                m_patches[Index(r-1, c)] = previous[Index(r, c)];
             }
         }
 
@@ -167,7 +172,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         // Shift the right row to the left
         for (int r = 0; r < m_patchPerRow; ++r)
         {
-            m_patches[Index(r, 0)] = m_previous[Index(r, maxIndex)];
+            m_patches[Index(r, 0)] = previous[Index(r, maxIndex)];
         }
 
         // Move all other rows right
@@ -175,7 +180,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         {
             for (int c = 0; c < m_patchPerRow-1; ++c)
             {
-                m_patches[Index(r, c+1)] = m_previous[Index(r, c)];
+                m_patches[Index(r, c+1)] = previous[Index(r, c)];
             }
         }
 
@@ -190,7 +195,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         // Shift the left row to the right
         for (int r = 0; r < m_patchPerRow; ++r)
         {
-            m_patches[Index(r, maxIndex)] = m_previous[Index(r, 0)];
+            m_patches[Index(r, maxIndex)] = previous[Index(r, 0)];
         }
 
         // Move all other rows left
@@ -198,7 +203,7 @@ void ScenePlacer::ShiftPatches(const Int2& direction)
         {
             for (int c = maxIndex; c > 0; --c)
             {
-                m_patches[Index(r, c-1)] = m_previous[Index(r, c)];
+                m_patches[Index(r, c-1)] = previous[Index(r, c)];
             }
         }
 
@@ -214,6 +219,8 @@ void ScenePlacer::UpdatePatch(int row,
                               int column,
                               const Int2& direction)
 {
+    Metrics::Add(m_replacedMetric);
+
     // Look at one pace in opposite direction
     const int backIndex = Index(row-direction.x, column-direction.y);
     const auto& backInstance = m_ocean.GetInstance(m_patches[backIndex]);
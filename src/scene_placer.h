@@ -172,7 +172,7 @@ private:
     float m_shadowOffset = 0.2f;      ///< Height above terrain to place shadows
     float m_shadowScale = 4.0f;       ///< Scale of shadows in comparison to mesh
     std::vector<int> m_patches;       ///< The current ordering of the patches; holds the instance ID
-    std::vector<int> m_previous;      ///< Buffer for reorganising the patches; holds the instance ID
     std::vector<Patch> m_patchData;   ///< Holds patch data; key is the instance ID held in m_patches
     Int2 m_patchInside;               ///< The patch the camera is currently inside
+    int m_replacedMetric = -1;        ///< Metric for the patches re-placed each frame
 };
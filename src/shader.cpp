@@ -12,13 +12,19 @@
 namespace
 {
     const std::string ASM_EXTENSION(".as");
+    const std::string BINARY_EXTENSION(".bin");
     const std::string SHADER_EXTENSION(".fx");
     const std::string GLSL_VERTEX("_glsl_vert");
     const std::string GLSL_FRAGMENT("_glsl_frag");
     const std::string HLSL_SHADER("_hlsl");
+    const std::string HLSL_VERTEX("_hlsl_vert");
+    const std::string HLSL_PIXEL("_hlsl_pixel");
+    const std::string GLSL_PROGRAM("_glsl");
     const std::string SHADER_PATH(ASSETS_PATH + "Shaders//");
     const std::string GENERATED_PATH(SHADER_PATH + "Generated//");
     const std::string BASE_SHADER("shader");
+    const std::string MANIFEST_FILE("manifest.txt");
+    const std::string VALIDATION_FILE("validation.txt");
 }
 
 Shader::Shader(const std::string& name, 
@@ -135,3 +141,43 @@ std::string Shader::HLSLShaderAsmFile() const
 {
     return GENERATED_PATH + m_name + HLSL_SHADER + ASM_EXTENSION;
 }
+
+std::string Shader::BaseShaderPath()
+{
+    return SHADER_PATH;
+}
+
+std::string Shader::GeneratedManifestFile()
+{
+    return GENERATED_PATH + MANIFEST_FILE;
+}
+
+std::string Shader::GeneratedValidationFile()
+{
+    return GENERATED_PATH + VALIDATION_FILE;
+}
+
+std::string Shader::GLSLBinaryFile() const
+{
+    return GENERATED_PATH + m_name + GLSL_PROGRAM + BINARY_EXTENSION;
+}
+
+std::string Shader::GLSLAsmCacheFile() const
+{
+    return GENERATED_PATH + m_name + GLSL_PROGRAM + ASM_EXTENSION + BINARY_EXTENSION;
+}
+
+std::string Shader::HLSLVertexBinaryFile() const
+{
+    return GENERATED_PATH + m_name + HLSL_VERTEX + BINARY_EXTENSION;
+}
+
+std::string Shader::HLSLPixelBinaryFile() const
+{
+    return GENERATED_PATH + m_name + HLSL_PIXEL + BINARY_EXTENSION;
+}
+
+std::mutex& Shader::FileMutex() const
+{
+    return m_fileMutex;
+}
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <mutex>
 
 /**
 * Shader used to render a mesh
@@ -56,6 +57,21 @@ public:
     */
     static Component StringAsComponent(const std::string& component);
 
+    /**
+    * @return The full path of the folder holding the base shaders
+    */
+    static std::string BaseShaderPath();
+
+    /**
+    * @return The full path of the manifest describing the generated shaders
+    */
+    static std::string GeneratedManifestFile();
+
+    /**
+    * @return The full path of the results of validating the generated shaders
+    */
+    static std::string GeneratedValidationFile();
+
     /**
     * Determines whether the shader has the component
     * @param component The component to query for text
@@ -123,10 +139,37 @@ public:
     */
     std::string HLSLShaderAsmFile() const;
 
+    /**
+    * @return The full path of the cached GLSL program binary
+    */
+    std::string GLSLBinaryFile() const;
+
+    /**
+    * @return The full path of the cached GLSL vertex and fragment assembly
+    */
+    std::string GLSLAsmCacheFile() const;
+
+    /**
+    * @return The full path of the cached HLSL vertex shader bytecode
+    */
+    std::string HLSLVertexBinaryFile() const;
+
+    /**
+    * @return The full path of the cached HLSL pixel shader bytecode
+    */
+    std::string HLSLPixelBinaryFile() const;
+
+    /**
+    * @return the mutex to hold while writing or reading the generated files
+    * @note the files are rewritten by both the shader watcher and recompiles
+    */
+    std::mutex& FileMutex() const;
+
 private:
 
     const unsigned int m_components;     ///< Sections that make up this shader
     int m_index = -1;                    ///< Unique index of the shader
     std::string m_name;                  ///< name of the shader
     bool m_fromFragments = false;        ///< whether this shader is generated from the base shader
+    mutable std::mutex m_fileMutex;      ///< Guards the generated files
 };
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_cache.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "shader_cache.h"
+#include "logger.h"
+
+#include <fstream>
+
+namespace
+{
+    const unsigned int CACHE_VERSION = 1;                          ///< Changing invalidates all entries
+    const unsigned long long FNV_OFFSET = 14695981039346656037ull; ///< FNV-1a 64 bit offset basis
+    const unsigned long long FNV_PRIME = 1099511628211ull;         ///< FNV-1a 64 bit prime
+
+    /**
+    * Header at the start of each cache entry
+    */
+    struct CacheHeader
+    {
+        unsigned int version = 0;     ///< Version of the cache the entry was saved with
+        unsigned int format = 0;      ///< Driver specific format of the binary
+        unsigned long long key = 0;   ///< Hash of the shader text and driver
+        unsigned int size = 0;        ///< Size of the binary in bytes
+    };
+
+    /**
+    * Continues an FNV-1a hash over the given text
+    */
+    unsigned long long Hash(unsigned long long hash, const std::string& text)
+    {
+        for (const char c : text)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+unsigned long long ShaderCache::GenerateKey(const std::string& driver, const std::string& text)
+{
+    // Hash the length of the driver to separate it from the text
+    return Hash(Hash(Hash(FNV_OFFSET, driver), std::to_string(driver.size())), text);
+}
+
+bool ShaderCache::Load(const std::string& path,
+                       unsigned long long key,
+                       unsigned int& format,
+                       std::vector<char>& binary)
+{
+    std::ifstream file(path, std::ios::in|std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    CacheHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file.good() ||
+        header.version != CACHE_VERSION ||
+        header.key != key ||
+        header.size == 0)
+    {
+        return false;
+    }
+
+    binary.resize(header.size);
+    file.read(&binary[0], binary.size());
+    if (file.gcount() != static_cast<std::streamsize>(header.size))
+    {
+        binary.clear();
+        return false;
+    }
+
+    format = header.format;
+    return true;
+}
+
+bool ShaderCache::Save(const std::string& path,
+                       unsigned long long key,
+                       unsigned int format,
+                       const void* binary,
+                       int size)
+{
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::out|std::ios::binary|std::ios::trunc);
+    if (!file.is_open())
+    {
+        Logger::LogError("Could not write shader cache " + path);
+        return false;
+    }
+
+    CacheHeader header;
+    header.version = CACHE_VERSION;
+    header.format = format;
+    header.key = key;
+    header.size = static_cast<unsigned int>(size);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(static_cast<const char*>(binary), size);
+    return file.good();
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_cache.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+* On disk cache of compiled shader binaries. Each entry is keyed by a hash
+* of the final shader text and the driver that compiled it, so any change
+* to either invalidates the entry and it is rebuilt on the next compile
+*/
+class ShaderCache
+{
+public:
+
+    /**
+    * Generates the key for a cache entry
+    * @param driver Identification of the driver compiling the shader
+    * @param text The final text of the shader
+    * @return the key for the entry
+    */
+    static unsigned long long GenerateKey(const std::string& driver, const std::string& text);
+
+    /**
+    * Loads a binary from the cache
+    * @param path The path to the cache entry
+    * @param key The key the entry must match to be valid
+    * @param format The driver specific format of the binary
+    * @param binary The binary to fill in
+    * @return whether a valid binary was loaded
+    */
+    static bool Load(const std::string& path,
+                     unsigned long long key,
+                     unsigned int& format,
+                     std::vector<char>& binary);
+
+    /**
+    * Saves a binary to the cache, replacing any previous entry
+    * @param path The path to the cache entry
+    * @param key The key to store the entry with
+    * @param format The driver specific format of the binary
+    * @param binary The binary to save
+    * @param size The size of the binary in bytes
+    * @return whether saving was successful
+    */
+    static bool Save(const std::string& path,
+                     unsigned long long key,
+                     unsigned int format,
+                     const void* binary,
+                     int size);
+};
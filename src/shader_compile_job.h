@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_compile_job.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <string>
+
+/**
+* Recompiles a shader in two stages so the render thread only waits on
+* creating the final program. The shader in use is kept until the new
+* program has been successfully created
+*/
+class ShaderCompileJob : boost::noncopyable
+{
+public:
+
+    /**
+    * Destructor
+    */
+    virtual ~ShaderCompileJob() {}
+
+    /**
+    * Writes and compiles the shader text without using the device
+    * @note called on a worker thread
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Prepare() = 0;
+
+    /**
+    * Creates the new program and swaps it with the shader in use
+    * @note called on the render thread only once preparing has succeeded
+    * @return Error message if failed or empty if succeeded
+    */
+    virtual std::string Finish() = 0;
+};
@@ -0,0 +1,398 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_validator.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "shader_validator.h"
+#include "software_worker_pool.h"
+#include "shader_cache.h"
+#include "render_data.h"
+#include "shader.h"
+#include "logger.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace
+{
+    const unsigned int RESULTS_VERSION = 1;                ///< Changing validates all shaders again
+    const std::string SPIRV_EXTENSION(".spv");             ///< Extension for emitted SPIR-V
+    const std::string SPIRV_SOURCE_EXTENSION(".glsl");     ///< Extension for the source SPIR-V is emitted from
+    const std::string LOG_EXTENSION(".log");               ///< Extension for compiler output
+    const std::string VERTEX_STAGE("vert");                ///< Compiler stage for vertex shaders
+    const std::string FRAGMENT_STAGE("frag");              ///< Compiler stage for fragment shaders
+    const std::string SPIRV_VERSION("#version 330");       ///< Lowest version SPIR-V can be emitted for
+
+#ifdef _WIN32
+    const std::string COMPILER("Assets\\Compiliers\\glslangValidator.exe");
+    const std::string SDK_COMPILER("\\Bin\\glslangValidator.exe");
+#else
+    const std::string COMPILER(ASSETS_PATH + "Compiliers//glslangValidator");
+    const std::string SDK_COMPILER("/bin/glslangValidator");
+#endif
+
+    /**
+    * SPIR-V opcodes used for statistics
+    */
+    const unsigned int SPIRV_MAGIC = 0x07230203;
+    const unsigned int SPIRV_HEADER_WORDS = 5;
+    const unsigned int OP_EXT_INST = 12;
+    const unsigned int OP_FUNCTION = 54;
+    const unsigned int OP_FUNCTION_END = 56;
+    const unsigned int OP_SAMPLE_FIRST = 87;     ///< OpImageSampleImplicitLod
+    const unsigned int OP_SAMPLE_LAST = 97;      ///< OpImageDrefGather
+    const unsigned int OP_ARITHMETIC_FIRST = 126; ///< OpSNegate
+    const unsigned int OP_ARITHMETIC_LAST = 152;  ///< OpSMulExtended
+    const unsigned int OP_BRANCH_FIRST = 249;    ///< OpBranch
+    const unsigned int OP_BRANCH_LAST = 251;     ///< OpSwitch
+
+    /**
+    * Reads the whole file as text
+    */
+    bool ReadFile(const std::string& path, std::string& text)
+    {
+        std::ifstream file(path.c_str(), std::ios_base::in|std::ios_base::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        std::stringstream stream;
+        stream << file.rdbuf();
+        text = stream.str();
+        return true;
+    }
+}
+
+bool ShaderValidator::Initialise()
+{
+    m_compiler.clear();
+
+    if (boost::filesystem::exists(COMPILER))
+    {
+        m_compiler = COMPILER;
+    }
+    else if (const char* sdk = std::getenv("VULKAN_SDK"))
+    {
+        const std::string compiler = std::string(sdk) + SDK_COMPILER;
+        if (boost::filesystem::exists(compiler))
+        {
+            m_compiler = compiler;
+        }
+    }
+
+    if (m_compiler.empty())
+    {
+        Logger::LogInfo("Shader Validator: glslangValidator not found, skipping validation");
+        return false;
+    }
+
+    LoadResults();
+    return true;
+}
+
+bool ShaderValidator::Validate(const std::vector<std::unique_ptr<Shader>>& shaders)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    struct Job
+    {
+        std::string path;
+        const std::string* stage;
+        const std::string* name;
+    };
+
+    std::vector<Job> jobs;
+    for (const auto& shader : shaders)
+    {
+        jobs.push_back({ shader->GLSLVertexFile(), &VERTEX_STAGE, &shader->Name() });
+        jobs.push_back({ shader->GLSLFragmentFile(), &FRAGMENT_STAGE, &shader->Name() });
+    }
+
+    std::vector<char> valid(jobs.size(), 0);
+
+    // Each job is a separate compiler process so the pool mostly waits
+    SwWorkerPool workers;
+    workers.Initialise();
+    workers.Run(static_cast<int>(jobs.size()), [&](int index)
+    {
+        const Job& job = jobs[index];
+        valid[index] = Validate(job.path, *job.stage, *job.name) ? 1 : 0;
+    });
+    workers.Release();
+
+    SaveResults();
+
+    int failed = 0;
+    for (char result : valid)
+    {
+        failed += result ? 0 : 1;
+    }
+
+    const double time = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+
+    Logger::LogInfo("Shader Validator: " + std::to_string(jobs.size() - failed) + "/" +
+        std::to_string(jobs.size()) + " shaders valid in " + std::to_string(time) + "ms");
+
+    return failed == 0;
+}
+
+bool ShaderValidator::Validate(const std::string& path,
+                               const std::string& stage,
+                               const std::string& shaderName)
+{
+    std::string text;
+    if (!ReadFile(path, text))
+    {
+        Logger::LogError("Shader Validator: Could not open " + path);
+        return false;
+    }
+
+    const std::string spirvPath = boost::filesystem::path(path).replace_extension(SPIRV_EXTENSION).string();
+    const unsigned long long key = ShaderCache::GenerateKey(m_compiler, text);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto itr = m_results.find(path);
+        if (itr != m_results.end() && itr->second.key == key)
+        {
+            if (!itr->second.valid)
+            {
+                Logger::LogError("Shader Validator: " + shaderName + " " + stage + " is unchanged and invalid");
+            }
+            return itr->second.valid;
+        }
+    }
+
+    Result result;
+    result.key = key;
+
+    std::string errors;
+    const std::string output = spirvPath + LOG_EXTENSION;
+    result.valid = RunCompiler("-S " + stage + " \"" + path + "\"", output, errors);
+
+    if (!result.valid)
+    {
+        Logger::LogError("Shader Validator: " + shaderName + " " + stage + "\n" + errors);
+    }
+    else
+    {
+        // SPIR-V for OpenGL requires a later version than the shaders are written for
+        std::string spirvText = text;
+        boost::replace_first(spirvText, GetVersion(text), SPIRV_VERSION);
+
+        const std::string spirvSource = spirvPath + SPIRV_SOURCE_EXTENSION;
+        std::ofstream file(spirvSource.c_str(), std::ios_base::out|std::ios_base::binary|std::ios_base::trunc);
+        file.write(spirvText.c_str(), spirvText.size());
+        file.close();
+
+        if (RunCompiler("-G --aml --amb -S " + stage + " -o \"" + spirvPath + "\" \"" + spirvSource + "\"", output, errors) &&
+            ReadStatistics(spirvPath, result.statistics))
+        {
+            const auto& statistics = result.statistics;
+            Logger::LogInfo("Shader Validator: " + shaderName + " " + stage + " " +
+                std::to_string(statistics.instructions) + " instructions, " +
+                std::to_string(statistics.arithmetic) + " arithmetic, " +
+                std::to_string(statistics.samples) + " samples, " +
+                std::to_string(statistics.branches) + " branches");
+        }
+        else
+        {
+            Logger::LogInfo("Shader Validator: " + shaderName + " " + stage + " could not emit SPIR-V\n" + errors);
+        }
+
+        boost::system::error_code error;
+        boost::filesystem::remove(spirvSource, error);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results[path] = result;
+    m_resultsChanged = true;
+    return result.valid;
+}
+
+bool ShaderValidator::RunCompiler(const std::string& arguments,
+                                  const std::string& output,
+                                  std::string& errors) const
+{
+    const std::string command = "\"" + m_compiler + "\" " + arguments + " > \"" + output + "\" 2>&1";
+
+#ifdef _WIN32
+    // Use cmd.exe to redirect the output without showing a console per process
+    const std::string console("C:\\windows\\system32\\cmd.exe");
+    std::string commandLine = "/S /C \"" + command + "\"";
+
+    PROCESS_INFORMATION pi;
+    STARTUPINFO si = { sizeof(STARTUPINFO) };
+    si.dwFlags = STARTF_USESHOWWINDOW;
+    si.wShowWindow = SW_HIDE;
+
+    if (!CreateProcess(console.c_str(), &commandLine[0], 0, 0, FALSE, CREATE_NO_WINDOW, 0, 0, &si, &pi))
+    {
+        errors = "Process failed: " + command;
+        return false;
+    }
+
+    DWORD exitCode = 1;
+    ::WaitForSingleObject(pi.hProcess, INFINITE);
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    const bool success = exitCode == 0;
+#else
+    const bool success = std::system(command.c_str()) == 0;
+#endif
+
+    errors.clear();
+    if (!success)
+    {
+        ReadFile(output, errors);
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::remove(output, error);
+    return success;
+}
+
+std::string ShaderValidator::GetVersion(const std::string& text)
+{
+    const auto start = text.find("#version");
+    if (start == std::string::npos)
+    {
+        return std::string();
+    }
+    return text.substr(start, text.find_first_of("\r\n", start) - start);
+}
+
+bool ShaderValidator::ReadStatistics(const std::string& path, Statistics& statistics)
+{
+    std::ifstream file(path.c_str(), std::ios_base::in|std::ios_base::binary|std::ios_base::ate);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    std::vector<unsigned int> words(static_cast<unsigned int>(file.tellg()) / sizeof(unsigned int));
+    file.seekg(0, std::ios::beg);
+    file.read(reinterpret_cast<char*>(words.data()), words.size() * sizeof(unsigned int));
+
+    if (words.size() < SPIRV_HEADER_WORDS || words[0] != SPIRV_MAGIC)
+    {
+        return false;
+    }
+
+    statistics = Statistics();
+    bool inFunction = false;
+
+    // Each instruction starts with its word count in the high 16 bits
+    unsigned int index = SPIRV_HEADER_WORDS;
+    while (index < words.size())
+    {
+        const unsigned int opcode = words[index] & 0xFFFF;
+        const unsigned int count = words[index] >> 16;
+        if (count == 0)
+        {
+            return false;
+        }
+        index += count;
+
+        if (opcode == OP_FUNCTION || opcode == OP_FUNCTION_END)
+        {
+            inFunction = opcode == OP_FUNCTION;
+            continue;
+        }
+        if (!inFunction)
+        {
+            continue;
+        }
+
+        ++statistics.instructions;
+        if (opcode == OP_EXT_INST || (opcode >= OP_ARITHMETIC_FIRST && opcode <= OP_ARITHMETIC_LAST))
+        {
+            ++statistics.arithmetic;
+        }
+        else if (opcode >= OP_SAMPLE_FIRST && opcode <= OP_SAMPLE_LAST)
+        {
+            ++statistics.samples;
+        }
+        else if (opcode >= OP_BRANCH_FIRST && opcode <= OP_BRANCH_LAST)
+        {
+            ++statistics.branches;
+        }
+    }
+    return true;
+}
+
+void ShaderValidator::LoadResults()
+{
+    m_results.clear();
+    m_resultsChanged = false;
+
+    std::ifstream file(Shader::GeneratedValidationFile().c_str(), std::ios_base::in);
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    unsigned int version = 0;
+    file >> version;
+    if (version != RESULTS_VERSION)
+    {
+        return;
+    }
+
+    std::string path;
+    Result result;
+    while (file >> path >> result.key >> result.valid
+                >> result.statistics.instructions
+                >> result.statistics.arithmetic
+                >> result.statistics.samples
+                >> result.statistics.branches)
+    {
+        m_results[path] = result;
+    }
+}
+
+void ShaderValidator::SaveResults()
+{
+    if (!m_resultsChanged)
+    {
+        return;
+    }
+
+    // Sorted to keep the results stable between runs
+    const std::map<std::string, Result> sorted(m_results.begin(), m_results.end());
+
+    std::string results = std::to_string(RESULTS_VERSION) + "\n";
+    for (const auto& entry : sorted)
+    {
+        const Result& result = entry.second;
+        results += entry.first + " " +
+            std::to_string(result.key) + " " +
+            std::to_string(result.valid) + " " +
+            std::to_string(result.statistics.instructions) + " " +
+            std::to_string(result.statistics.arithmetic) + " " +
+            std::to_string(result.statistics.samples) + " " +
+            std::to_string(result.statistics.branches) + "\n";
+    }
+
+    const std::string path = Shader::GeneratedValidationFile();
+    std::ofstream file(path.c_str(), std::ios_base::out|std::ios_base::trunc);
+    if (!file.is_open())
+    {
+        Logger::LogError("Could not open " + path);
+        return;
+    }
+
+    file.write(results.c_str(), results.size());
+    m_resultsChanged = false;
+}
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_validator.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Shader;
+
+/**
+* Validates generated GLSL shaders with the reference compiler before any
+* context compiles them and emits SPIR-V with instruction statistics.
+* Results are cached by a hash of the shader text so only edited shaders
+* are passed to the compiler again
+*/
+class ShaderValidator : boost::noncopyable
+{
+public:
+
+    /**
+    * Finds the reference compiler
+    * @return whether the compiler was found
+    */
+    bool Initialise();
+
+    /**
+    * Validates all generated GLSL shaders across a pool of workers
+    * @param shaders The shaders to validate
+    * @return whether all shaders were valid
+    */
+    bool Validate(const std::vector<std::unique_ptr<Shader>>& shaders);
+
+private:
+
+    /**
+    * Instruction counts for the functions of a SPIR-V module
+    */
+    struct Statistics
+    {
+        int instructions = 0;   ///< All instructions within functions
+        int arithmetic = 0;     ///< Arithmetic and extended instructions
+        int samples = 0;        ///< Texture sampling instructions
+        int branches = 0;       ///< Branching instructions
+    };
+
+    /**
+    * Result of validating a single generated shader
+    */
+    struct Result
+    {
+        unsigned long long key = 0;   ///< Hash of the shader text and compiler
+        bool valid = false;           ///< Whether the shader compiled
+        Statistics statistics;        ///< Instruction counts of the SPIR-V
+    };
+
+    /**
+    * Validates a single generated shader
+    * @param path The path to the generated shader
+    * @param stage The reference compiler name for the shader stage
+    * @param shaderName The name of the shader for logging
+    * @return whether the shader was valid
+    */
+    bool Validate(const std::string& path,
+                  const std::string& stage,
+                  const std::string& shaderName);
+
+    /**
+    * Runs the reference compiler
+    * @param arguments The arguments to pass to the compiler
+    * @param output The path to write compiler output to
+    * @param errors Filled with the output of the compiler on failure
+    * @return whether the compiler succeeded
+    */
+    bool RunCompiler(const std::string& arguments,
+                     const std::string& output,
+                     std::string& errors) const;
+
+    /**
+    * @param text The text of the shader
+    * @return the version directive of the shader
+    */
+    static std::string GetVersion(const std::string& text);
+
+    /**
+    * Counts the instructions within the SPIR-V module
+    * @param path The path to the SPIR-V module
+    * @param statistics The counts to fill in
+    * @return whether the module could be read
+    */
+    static bool ReadStatistics(const std::string& path, Statistics& statistics);
+
+    /**
+    * Reads the results of previous validations
+    */
+    void LoadResults();
+
+    /**
+    * Saves the results of all validations
+    */
+    void SaveResults();
+
+private:
+
+    std::string m_compiler;                                ///< Path to the reference compiler
+    std::unordered_map<std::string, Result> m_results;     ///< Results by generated shader path
+    std::mutex m_mutex;                                    ///< Guards the results
+    bool m_resultsChanged = false;                         ///< Whether the results require saving
+};
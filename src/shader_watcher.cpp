@@ -0,0 +1,340 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_watcher.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "shader_watcher.h"
+#include "fragmentlinker.h"
+#include "scene_data.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const int POLL_TIME = 100;    ///< Milliseconds between checking whether to stop watching
+    const int SETTLE_TIME = 50;   ///< Milliseconds without changes before regenerating
+    const int BUFFER_SIZE = 4096; ///< Bytes for reading change notifications
+}
+
+/**
+* Platform specific state for watching the base shader folder
+*/
+struct WatcherData
+{
+#ifdef _WIN32
+    HANDLE directory = INVALID_HANDLE_VALUE;  ///< Handle to the base shader folder
+    OVERLAPPED overlapped;                    ///< State of the pending change request
+    std::vector<DWORD> buffer;                ///< Change notifications, DWORD aligned
+    bool pending = false;                     ///< Whether a change request is pending
+
+    /**
+    * Requests any changes to the folder to be written to the buffer
+    */
+    bool RequestChanges()
+    {
+        pending = ReadDirectoryChangesW(directory, &buffer[0],
+            static_cast<DWORD>(buffer.size() * sizeof(DWORD)), FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE|FILE_NOTIFY_CHANGE_FILE_NAME,
+            nullptr, &overlapped, nullptr) != 0;
+        return pending;
+    }
+#else
+    int inotify = -1;                         ///< Inotify instance for the base shader folder
+    std::vector<char> buffer;                 ///< Change notifications
+#endif
+};
+
+ShaderWatcher::ShaderWatcher(const SceneData& data)
+    : m_data(data)
+    , m_running(false)
+{
+}
+
+ShaderWatcher::~ShaderWatcher()
+{
+    Release();
+}
+
+bool ShaderWatcher::Initialise()
+{
+    Release();
+
+    m_linker = std::make_unique<FragmentLinker>();
+    if (!m_linker->Initialise(Water::Wave::MAX, m_data.lights.size(), m_data.post->GetBlurWeights()))
+    {
+        Logger::LogError("Shader Watcher: Could not initialise fragment linker");
+        return false;
+    }
+
+    m_dependencies.clear();
+    for (unsigned int i = 0; i < m_data.shaders.size(); ++i)
+    {
+        const auto& shader = *m_data.shaders[i];
+        for (const std::string& path : { shader.GLSLVertexBase(),
+                                         shader.GLSLFragmentBase(),
+                                         shader.HLSLShaderBase() })
+        {
+            const std::string filename = boost::to_lower_copy(
+                boost::filesystem::path(path).filename().string());
+
+            auto& dependency = m_dependencies[filename];
+            dependency.path = path;
+            if (dependency.shaders.empty() || dependency.shaders.back() != static_cast<int>(i))
+            {
+                dependency.shaders.push_back(i);
+            }
+        }
+    }
+
+    const std::string folder = Shader::BaseShaderPath();
+    m_watcher = std::make_unique<WatcherData>();
+
+#ifdef _WIN32
+    m_watcher->directory = CreateFile(folder.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS|FILE_FLAG_OVERLAPPED, nullptr);
+
+    if (m_watcher->directory == INVALID_HANDLE_VALUE)
+    {
+        Logger::LogError("Shader Watcher: Could not open " + folder);
+        m_watcher.reset();
+        return false;
+    }
+
+    ZeroMemory(&m_watcher->overlapped, sizeof(m_watcher->overlapped));
+    m_watcher->overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    m_watcher->buffer.resize(BUFFER_SIZE / sizeof(DWORD));
+
+    if (!m_watcher->overlapped.hEvent || !m_watcher->RequestChanges())
+    {
+        Logger::LogError("Shader Watcher: Could not watch " + folder);
+        Release();
+        return false;
+    }
+#else
+    m_watcher->inotify = inotify_init1(IN_NONBLOCK);
+    m_watcher->buffer.resize(BUFFER_SIZE);
+
+    if (m_watcher->inotify == -1 || inotify_add_watch(m_watcher->inotify,
+        folder.c_str(), IN_CLOSE_WRITE|IN_MOVED_TO) == -1)
+    {
+        Logger::LogError("Shader Watcher: Could not watch " + folder);
+        Release();
+        return false;
+    }
+#endif
+
+    m_running = true;
+    m_thread = std::thread(&ShaderWatcher::Run, this);
+
+    Logger::LogInfo("Shader Watcher: Watching " + folder);
+    return true;
+}
+
+void ShaderWatcher::Release()
+{
+    m_running = false;
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    if (m_watcher)
+    {
+#ifdef _WIN32
+        if (m_watcher->pending)
+        {
+            // The request must complete before the buffer is released
+            DWORD bytes = 0;
+            CancelIoEx(m_watcher->directory, &m_watcher->overlapped);
+            GetOverlappedResult(m_watcher->directory, &m_watcher->overlapped, &bytes, TRUE);
+        }
+        if (m_watcher->overlapped.hEvent)
+        {
+            CloseHandle(m_watcher->overlapped.hEvent);
+        }
+        if (m_watcher->directory != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(m_watcher->directory);
+        }
+#else
+        if (m_watcher->inotify != -1)
+        {
+            close(m_watcher->inotify);
+        }
+#endif
+        m_watcher.reset();
+    }
+
+    m_linker.reset();
+}
+
+std::vector<int> ShaderWatcher::GetReloadedShaders()
+{
+    std::vector<int> reloaded;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reloaded.swap(m_reloaded);
+    return reloaded;
+}
+
+void ShaderWatcher::Run()
+{
+    while (m_running)
+    {
+        std::vector<std::string> changed;
+        if (WaitForChanges(POLL_TIME, changed))
+        {
+            // Editors can save in multiple writes so wait for changes to settle
+            while (m_running && WaitForChanges(SETTLE_TIME, changed))
+            {
+            }
+
+            RegenerateShaders(changed);
+        }
+    }
+}
+
+bool ShaderWatcher::WaitForChanges(int timeout, std::vector<std::string>& changed)
+{
+#ifdef _WIN32
+    if (!m_watcher->pending ||
+        WaitForSingleObject(m_watcher->overlapped.hEvent, timeout) != WAIT_OBJECT_0)
+    {
+        return false;
+    }
+
+    DWORD bytes = 0;
+    const bool success = GetOverlappedResult(m_watcher->directory,
+        &m_watcher->overlapped, &bytes, FALSE) != 0;
+
+    m_watcher->pending = false;
+    ResetEvent(m_watcher->overlapped.hEvent);
+
+    if (success && bytes == 0)
+    {
+        // Notifications overflowed the buffer so assume all files changed
+        for (const auto& dependency : m_dependencies)
+        {
+            changed.push_back(dependency.first);
+        }
+    }
+    else if (success)
+    {
+        const char* data = reinterpret_cast<const char*>(&m_watcher->buffer[0]);
+        while (true)
+        {
+            const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(data);
+            const int length = info->FileNameLength / sizeof(WCHAR);
+            const int size = WideCharToMultiByte(CP_UTF8, 0,
+                info->FileName, length, nullptr, 0, nullptr, nullptr);
+
+            std::string filename(size, '\0');
+            WideCharToMultiByte(CP_UTF8, 0, info->FileName,
+                length, &filename[0], size, nullptr, nullptr);
+            changed.push_back(filename);
+
+            if (info->NextEntryOffset == 0)
+            {
+                break;
+            }
+            data += info->NextEntryOffset;
+        }
+    }
+
+    m_watcher->RequestChanges();
+    return true;
+#else
+    pollfd request = { m_watcher->inotify, POLLIN, 0 };
+    if (poll(&request, 1, timeout) <= 0)
+    {
+        return false;
+    }
+
+    bool found = false;
+    ssize_t bytes = 0;
+    while ((bytes = read(m_watcher->inotify, &m_watcher->buffer[0], m_watcher->buffer.size())) > 0)
+    {
+        for (ssize_t offset = 0; offset < bytes; )
+        {
+            const auto* info = reinterpret_cast<const inotify_event*>(&m_watcher->buffer[offset]);
+            if (info->len > 0)
+            {
+                changed.push_back(info->name);
+            }
+            offset += sizeof(inotify_event) + info->len;
+        }
+        found = true;
+    }
+    return found;
+#endif
+}
+
+void ShaderWatcher::RegenerateShaders(const std::vector<std::string>& changed)
+{
+    std::set<int> shaders;
+    for (const auto& file : changed)
+    {
+        auto itr = m_dependencies.find(boost::to_lower_copy(file));
+        if (itr != m_dependencies.end())
+        {
+            m_linker->ReloadBaseShader(itr->second.path);
+            shaders.insert(itr->second.shaders.begin(), itr->second.shaders.end());
+        }
+    }
+
+    std::vector<int> regenerated;
+    for (int index : shaders)
+    {
+        const auto& shader = *m_data.shaders[index];
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        bool generated = false;
+        {
+            // Recompiles from the gui write the same files on their own worker
+            std::lock_guard<std::mutex> lock(shader.FileMutex());
+            generated = m_linker->GenerateShader(shader);
+        }
+
+        if (generated)
+        {
+            const double time = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+
+            Logger::LogInfo("Shader Watcher: " + shader.Name() +
+                " regenerated in " + std::to_string(time) + "ms");
+
+            regenerated.push_back(index);
+        }
+        else
+        {
+            Logger::LogError("Shader Watcher: Could not regenerate " + shader.Name());
+        }
+    }
+
+    if (!regenerated.empty())
+    {
+        m_linker->SaveManifest();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int index : regenerated)
+        {
+            if (std::find(m_reloaded.begin(), m_reloaded.end(), index) == m_reloaded.end())
+            {
+                m_reloaded.push_back(index);
+            }
+        }
+    }
+}
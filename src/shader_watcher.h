@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - shader_watcher.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FragmentLinker;
+struct SceneData;
+struct WatcherData;
+
+/**
+* Watches the base shaders for changes and regenerates only the shaders that
+* use them on a worker thread. Regenerated shaders are collected until the
+* render thread is ready to recompile them between frames
+*/
+class ShaderWatcher : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param data The scene holding the shaders to watch
+    */
+    ShaderWatcher(const SceneData& data);
+
+    /**
+    * Destructor
+    */
+    ~ShaderWatcher();
+
+    /**
+    * Starts watching the base shaders
+    * @return whether watching was started
+    */
+    bool Initialise();
+
+    /**
+    * Stops watching the base shaders
+    */
+    void Release();
+
+    /**
+    * Takes the shaders regenerated since the last call
+    * @return the index of each shader requiring recompilation
+    */
+    std::vector<int> GetReloadedShaders();
+
+private:
+
+    /**
+    * Main loop for the worker thread
+    */
+    void Run();
+
+    /**
+    * Waits for any base shader files to change
+    * @param timeout The milliseconds to wait for
+    * @param changed The filenames of any changed files to add to
+    * @return whether any changes were found
+    */
+    bool WaitForChanges(int timeout, std::vector<std::string>& changed);
+
+    /**
+    * Regenerates all shaders using the changed files
+    * @param changed The filenames of the changed files
+    */
+    void RegenerateShaders(const std::vector<std::string>& changed);
+
+    /**
+    * The shaders generated from a single base shader file
+    */
+    struct Dependency
+    {
+        std::string path;          ///< Full path to the base shader
+        std::vector<int> shaders;  ///< Indices of shaders generated from the file
+    };
+
+private:
+
+    const SceneData& m_data;                                     ///< Scene holding the shaders
+    std::unique_ptr<FragmentLinker> m_linker;                    ///< Generates shaders on the worker thread
+    std::unique_ptr<WatcherData> m_watcher;                      ///< Platform specific watching state
+    std::unordered_map<std::string, Dependency> m_dependencies;  ///< Lower case filename to its dependency
+    std::thread m_thread;                                        ///< Worker thread for watching
+    std::mutex m_mutex;                                          ///< Guards the reloaded shaders
+    std::vector<int> m_reloaded;                                 ///< Shaders regenerated but not recompiled
+    std::atomic<bool> m_running;                                 ///< Whether the worker thread is running
+};
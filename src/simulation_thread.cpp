@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - simulation_thread.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "simulation_thread.h"
+#include "scene.h"
+#include "arena.h"
+
+#include <chrono>
+
+SimulationThread::SimulationThread(Scene& scene)
+    : m_scene(scene)
+{
+    m_thread = std::thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_signal.notify_all();
+    m_thread.join();
+}
+
+void SimulationThread::Start(float deltatime,
+                             const Float3& position,
+                             const BoundingArea& bounds)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_deltatime = deltatime;
+        m_position = position;
+        m_bounds = bounds;
+        m_requested = true;
+        m_inFlight = true;
+    }
+    m_signal.notify_all();
+}
+
+bool SimulationThread::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const bool inFlight = m_inFlight;
+    m_signal.wait(lock, [this](){ return !m_inFlight; });
+    return inFlight;
+}
+
+float SimulationThread::GetTickTime() const
+{
+    return m_tickTime;
+}
+
+void SimulationThread::Run()
+{
+    Memory::TrackAllocations();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_signal.wait(lock, [this](){ return m_requested || !m_running; });
+        if (!m_running)
+        {
+            break;
+        }
+
+        m_requested = false;
+        const float deltatime = m_deltatime;
+        const Float3 position = m_position;
+        const BoundingArea bounds = m_bounds;
+
+        lock.unlock();
+        const auto start = std::chrono::high_resolution_clock::now();
+        m_scene.Tick(deltatime, position, bounds);
+        const float tickTime = static_cast<float>(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count());
+        Scratch::Reset();
+        lock.lock();
+
+        m_tickTime = tickTime;
+        m_inFlight = false;
+        m_signal.notify_all();
+    }
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - simulation_thread.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "render_data.h"
+
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Scene;
+
+/**
+* Ticks the scene on a worker thread so the next frame
+* can be simulated while the current frame is rendered
+*/
+class SimulationThread : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param scene The scene to tick
+    */
+    SimulationThread(Scene& scene);
+
+    /**
+    * Destructor
+    */
+    ~SimulationThread();
+
+    /**
+    * Starts ticking the scene on the worker thread
+    * @param deltatime The time passed between ticks
+    * @param position The world position of the camera
+    * @param bounds Bounding area in front of the camera
+    * @note must not be called while a tick is in flight
+    */
+    void Start(float deltatime, const Float3& position, const BoundingArea& bounds);
+
+    /**
+    * Blocks until any tick in flight has completed
+    * @return whether a tick was in flight
+    */
+    bool Wait();
+
+    /**
+    * @return the milliseconds the last completed tick took
+    * @note only valid once waited on
+    */
+    float GetTickTime() const;
+
+private:
+
+    /**
+    * Main loop for the worker thread
+    */
+    void Run();
+
+private:
+
+    Scene& m_scene;                      ///< The scene to tick
+    std::thread m_thread;                ///< Worker thread for ticking
+    std::mutex m_mutex;                  ///< Mutex guarding the tick state
+    std::condition_variable m_signal;    ///< Signal for a change in tick state
+    float m_deltatime = 0.0f;            ///< The time passed between ticks
+    Float3 m_position;                   ///< The world position of the camera
+    BoundingArea m_bounds;               ///< Bounding area in front of the camera
+    float m_tickTime = 0.0f;             ///< Milliseconds the last tick took
+    bool m_requested = false;            ///< Whether a tick has been requested
+    bool m_inFlight = false;             ///< Whether a tick is requested or running
+    bool m_running = true;               ///< Whether the worker thread is running
+};
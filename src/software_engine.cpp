@@ -0,0 +1,536 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_engine.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "software_engine.h"
+#include "software_rasteriser.h"
+#include "software_post_processing.h"
+#include "software_worker_pool.h"
+#include "software_texture.h"
+#include "scene_interface.h"
+#include "mesh.h"
+#include "water.h"
+#include "terrain.h"
+#include "emitter.h"
+#include "light.h"
+#include "shader.h"
+#include "shader_compile_job.h"
+#include "postprocessing.h"
+#include "metrics.h"
+#include "logger.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+
+namespace
+{
+    /**
+    * Converts the row major matrix into a column major glm matrix
+    */
+    glm::mat4 ToGlm(const Matrix& matrix)
+    {
+        glm::mat4 result;
+
+        result[0][0] = matrix.m11;
+        result[1][0] = matrix.m12;
+        result[2][0] = matrix.m13;
+        result[3][0] = matrix.m14;
+
+        result[0][1] = matrix.m21;
+        result[1][1] = matrix.m22;
+        result[2][1] = matrix.m23;
+        result[3][1] = matrix.m24;
+
+        result[0][2] = matrix.m31;
+        result[1][2] = matrix.m32;
+        result[2][2] = matrix.m33;
+        result[3][2] = matrix.m34;
+
+        return result;
+    }
+
+    /**
+    * Shaders are not used by the rasteriser so each stage succeeds without work
+    */
+    class SoftwareCompileJob : public ShaderCompileJob
+    {
+    public:
+
+        virtual std::string Prepare() override
+        {
+            return std::string();
+        }
+
+        virtual std::string Finish() override
+        {
+            return std::string();
+        }
+    };
+}
+
+/**
+* Internal data for the software rendering engine
+*/
+struct SoftwareData
+{
+    SoftwareData();
+    ~SoftwareData();
+
+    /**
+    * Releases the device context and buffers
+    */
+    void Release();
+
+    HWND hwnd = nullptr;                 ///< Handle to the window
+    HDC hdc = nullptr;                   ///< Device context
+    SwWorkerPool workers;                ///< Threads shared by the rasteriser and post processing
+    SwRasteriser rasteriser;             ///< Rasterises the scene into the colour buffer
+    SwPostProcessing post;               ///< Post processes the rasterised scene
+    glm::vec3 cameraPosition;            ///< Position of the camera
+    glm::vec3 cameraUp;                  ///< The up vector of the camera
+    glm::mat4 projection;                ///< Projection matrix
+    glm::mat4 view;                      ///< View matrix
+    glm::mat4 viewProjection;            ///< View projection matrix
+    bool isWireframe = false;            ///< Whether to render the scene as wireframe
+    bool useDiffuseTextures = true;      ///< Whether to render diffuse textures
+    float fadeAmount = 0.0f;             ///< the amount to fade the scene by
+    float presentTime = 0.0f;            ///< Milliseconds spent presenting the last frame
+
+    std::vector<SwVertex> vertices;                   ///< Transformed vertices of the current instance
+    std::vector<std::unique_ptr<SwTexture>> textures; ///< Textures shared by all meshes
+};
+
+SoftwareData::SoftwareData()
+    : rasteriser(WINDOW_WIDTH, WINDOW_HEIGHT, workers)
+    , post(WINDOW_WIDTH, WINDOW_HEIGHT, workers)
+{
+}
+
+SoftwareData::~SoftwareData()
+{
+    Release();
+}
+
+void SoftwareData::Release()
+{
+    fadeAmount = 0.0f;
+
+    for(auto& texture : textures)
+    {
+        texture->Release();
+    }
+
+    rasteriser.Release();
+    post.Release();
+    workers.Release();
+
+    if(hdc)
+    {
+        ReleaseDC(hwnd, hdc);
+        hdc = nullptr;
+    }
+}
+
+SoftwareEngine::SoftwareEngine(HWND hwnd) :
+    m_hwnd(hwnd),
+    m_data(new SoftwareData())
+{
+    m_data->hwnd = hwnd;
+}
+
+SoftwareEngine::~SoftwareEngine()
+{
+    Release();
+}
+
+void SoftwareEngine::Release()
+{
+    m_data->Release();
+}
+
+bool SoftwareEngine::Initialize()
+{
+    m_data->hdc = GetDC(m_hwnd);
+    if (!m_data->hdc)
+    {
+        Logger::LogError("Software: Could not get device context");
+        return false;
+    }
+
+    m_data->workers.Initialise();
+
+    if (!m_data->rasteriser.Initialise())
+    {
+        Logger::LogError("Software: Rasteriser failed to initialise");
+        return false;
+    }
+
+    if (!m_data->post.Initialise())
+    {
+        Logger::LogError("Software: Post processing failed to initialise");
+        return false;
+    }
+
+    m_data->isWireframe = false;
+    m_data->projection = glm::perspective(FIELD_OF_VIEW,
+        RATIO, FRUSTRUM_NEAR, FRUSTRUM_FAR);
+
+    Logger::LogInfo("Software: Rasteriser using " + std::to_string(
+        m_data->workers.GetThreadCount()) + " threads successful");
+    return true;
+}
+
+std::string SoftwareEngine::CompileShader(int index)
+{
+    return std::string();
+}
+
+bool SoftwareEngine::InitialiseScene(const IScene& scene)
+{
+    m_data->textures.reserve(scene.Textures().size());
+    for(const auto& texture : scene.Textures())
+    {
+        m_data->textures.push_back(std::unique_ptr<SwTexture>(
+            new SwTexture(*texture, scene.Assets())));
+    }
+
+    return ReInitialiseScene();
+}
+
+bool SoftwareEngine::ReInitialiseScene()
+{
+    for(auto& texture : m_data->textures)
+    {
+        if(!texture->Initialise())
+        {
+            Logger::LogError("Software: Failed to re-initialise texture");
+            return false;
+        }
+    }
+
+    Logger::LogInfo("Software: Re-Initialised");
+    return true;
+}
+
+bool SoftwareEngine::FadeView(bool in, float amount)
+{
+    m_data->fadeAmount += in ? amount : -amount;
+
+    if(in && m_data->fadeAmount >= 1.0f)
+    {
+        m_data->fadeAmount = 1.0f;
+        return true;
+    }
+    else if(!in && m_data->fadeAmount <= 0.0f)
+    {
+        m_data->fadeAmount = 0.0f;
+        return true;
+    }
+    return false;
+}
+
+void SoftwareEngine::Render(const IScene& scene, float timer)
+{
+    const PostProcessing& post = scene.Post();
+    m_data->useDiffuseTextures = post.UseDiffuseTextures();
+
+    SwFrame frame;
+    frame.cameraPosition = m_data->cameraPosition;
+    frame.depthNear = post.DepthNear();
+    frame.depthFar = post.DepthFar();
+    frame.wireframe = m_data->isWireframe;
+
+    frame.lights.reserve(scene.Lights().size());
+    for (const auto& light : scene.Lights())
+    {
+        SwLight data;
+        data.position = glm::vec3(light->Position().x, light->Position().y, light->Position().z);
+        data.diffuse = glm::vec3(light->Diffuse().r, light->Diffuse().g, light->Diffuse().b);
+        data.specular = glm::vec3(light->Specular().r, light->Specular().g, light->Specular().b);
+        data.attenuation = glm::vec3(light->Attenuation().x, light->Attenuation().y, light->Attenuation().z);
+        data.specularity = light->Specularity();
+        data.active = light->Active();
+        frame.lights.push_back(data);
+    }
+
+    Metrics::SetPass(Metrics::Scene);
+    m_data->rasteriser.BeginFrame(frame);
+
+    RenderTerrain(scene);
+    RenderMeshes(scene);
+    RenderWater(scene);
+    RenderEmitters(scene);
+
+    m_data->rasteriser.EndFrame();
+
+    Metrics::SetPass(Metrics::Post);
+    m_data->post.Render(post, m_data->rasteriser.GetPixels(),
+        m_data->rasteriser.GetSceneDepth(), m_data->fadeAmount);
+
+    const auto presentStart = std::chrono::high_resolution_clock::now();
+    Present();
+    m_data->presentTime = static_cast<float>(std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - presentStart).count());
+}
+
+void SoftwareEngine::RenderMesh(const MeshData& mesh,
+                                const IScene& scene,
+                                SwMaterial& material)
+{
+    const int index = mesh.ShaderID();
+    if (index == -1)
+    {
+        return;
+    }
+
+    const auto& textures = mesh.RenderTextureIDs();
+    material.specular = GetTexture(textures[TextureSlot::Specular]);
+    material.lit = !scene.Shaders()[index]->HasComponent(Shader::Flat);
+    material.backfaceCull = mesh.BackfaceCull();
+
+    const auto& vertices = mesh.Vertices();
+    const auto& indices = mesh.Indices();
+    const int components = mesh.VertexComponentCount();
+    const bool hasNormals = components >= 8;
+    const int vertexCount = static_cast<int>(vertices.size()) / components;
+    m_data->vertices.resize(vertexCount);
+
+    for (const auto& instance : mesh.RenderInstances())
+    {
+        if (!instance.enabled || !instance.render)
+        {
+            continue;
+        }
+
+        material.diffuse = GetTexture(m_data->useDiffuseTextures ?
+            instance.colour : static_cast<int>(TextureIndex::BlankTexture));
+        m_data->rasteriser.SetMaterial(material);
+        Metrics::Count(Metrics::DrawCalls);
+
+        const glm::mat4 world = ToGlm(instance.world);
+        const glm::mat3 rotation(world);
+        const glm::mat4 worldViewProjection = m_data->viewProjection * world;
+
+        for (int i = 0; i < vertexCount; ++i)
+        {
+            const float* vertex = &vertices[i * components];
+            const glm::vec4 position(vertex[0], vertex[1], vertex[2], 1.0f);
+
+            SwVertex& output = m_data->vertices[i];
+            output.position = worldViewProjection * position;
+            output.world = glm::vec3(world * position);
+            output.uvs = glm::vec2(vertex[3], vertex[4]);
+            output.normal = hasNormals ?
+                rotation * glm::vec3(vertex[5], vertex[6], vertex[7]) : glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+
+        for (unsigned int i = 0; i + 2 < indices.size(); i += 3)
+        {
+            m_data->rasteriser.DrawTriangle(m_data->vertices[indices[i]],
+                m_data->vertices[indices[i + 1]], m_data->vertices[indices[i + 2]]);
+        }
+    }
+}
+
+void SoftwareEngine::RenderMeshes(const IScene& scene)
+{
+    for (const auto& mesh : scene.Meshes())
+    {
+        SwMaterial material;
+        RenderMesh(*mesh, scene, material);
+    }
+}
+
+void SoftwareEngine::RenderTerrain(const IScene& scene)
+{
+    for (const auto& terrain : scene.Terrains())
+    {
+        SwMaterial material;
+        RenderMesh(*terrain, scene, material);
+    }
+}
+
+void SoftwareEngine::RenderWater(const IScene& scene)
+{
+    for (const auto& water : scene.Waters())
+    {
+        // Waves and reflections are not simulated, the surface uses the deep colour
+        const Colour& deep = water->Deep();
+        SwMaterial material;
+        material.tint = glm::vec4(deep.r, deep.g, deep.b, deep.a);
+        material.alphaBlend = true;
+        RenderMesh(*water, scene, material);
+    }
+}
+
+void SoftwareEngine::RenderEmitters(const IScene& scene)
+{
+    const glm::vec2 corners[] =
+    {
+        glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f),
+        glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)
+    };
+
+    SwVertex quad[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        quad[i].uvs = (corners[i] + 1.0f) * 0.5f;
+    }
+
+    for (const auto& emitter : scene.Emitters())
+    {
+        if (emitter->ShaderID() == -1)
+        {
+            continue;
+        }
+
+        const Colour& tint = emitter->Tint();
+        SwMaterial material;
+        material.lit = false;
+        material.alphaBlend = true;
+        material.depthWrite = false;
+        material.backfaceCull = false;
+
+        for (const auto& instance : emitter->RenderInstances())
+        {
+            if (!instance.render)
+            {
+                continue;
+            }
+
+            for (const Particle& particle : instance.particles)
+            {
+                if (!particle.Alive())
+                {
+                    continue;
+                }
+
+                // Particle always facing the camera
+                const glm::vec3 position(particle.Position().x,
+                    particle.Position().y, particle.Position().z);
+                const glm::vec3 forward = glm::normalize(m_data->cameraPosition - position);
+                const glm::vec3 right = glm::cross(forward, m_data->cameraUp);
+                const glm::vec3 up = glm::cross(forward, right);
+
+                material.diffuse = GetTexture(particle.Texture());
+                material.tint = glm::vec4(tint.r, tint.g, tint.b, tint.a * particle.Alpha());
+                m_data->rasteriser.SetMaterial(material);
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    quad[i].world = position + (right * corners[i].x + up * corners[i].y) * particle.Size();
+                    quad[i].position = m_data->viewProjection * glm::vec4(quad[i].world, 1.0f);
+                    quad[i].normal = forward;
+                }
+
+                m_data->rasteriser.DrawTriangle(quad[0], quad[1], quad[2]);
+                m_data->rasteriser.DrawTriangle(quad[0], quad[2], quad[3]);
+                Metrics::Count(Metrics::DrawCalls);
+            }
+        }
+    }
+}
+
+void SoftwareEngine::Present()
+{
+    BITMAPINFO info;
+    memset(&info, 0, sizeof(BITMAPINFO));
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = WINDOW_WIDTH;
+    info.bmiHeader.biHeight = -WINDOW_HEIGHT; // Rows are stored from the top
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    RECT client;
+    GetClientRect(m_hwnd, &client);
+
+    StretchDIBits(m_data->hdc, 0, 0, client.right - client.left,
+        client.bottom - client.top, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT,
+        &m_data->post.GetPixels()[0], &info, DIB_RGB_COLORS, SRCCOPY);
+}
+
+const SwTexture* SoftwareEngine::GetTexture(int ID) const
+{
+    return ID == -1 ? nullptr : m_data->textures[ID].get();
+}
+
+std::string SoftwareEngine::GetName() const
+{
+    return "Software";
+}
+
+void SoftwareEngine::UpdateView(const Matrix& world)
+{
+    m_data->cameraPosition.x = world.m14;
+    m_data->cameraPosition.y = world.m24;
+    m_data->cameraPosition.z = world.m34;
+
+    m_data->cameraUp.x = world.m12;
+    m_data->cameraUp.y = world.m22;
+    m_data->cameraUp.z = world.m32;
+
+    m_data->view = glm::inverse(ToGlm(world));
+    m_data->viewProjection = m_data->projection * m_data->view;
+}
+
+std::string SoftwareEngine::GetShaderText(int index) const
+{
+    return std::string();
+}
+
+bool SoftwareEngine::GetShaderAssembly(int index, std::string& assembly)
+{
+    assembly.clear();
+    return true;
+}
+
+void SoftwareEngine::SetFade(float value)
+{
+    m_data->fadeAmount = value;
+}
+
+std::unique_ptr<ShaderCompileJob> SoftwareEngine::CreateCompileJob(int index,
+                                                                   const std::string& text)
+{
+    return std::make_unique<SoftwareCompileJob>();
+}
+
+std::unique_ptr<ShaderCompileJob> SoftwareEngine::CreateReloadJob(int index)
+{
+    return std::make_unique<SoftwareCompileJob>();
+}
+
+void SoftwareEngine::ToggleWireframe()
+{
+    m_data->isWireframe = !m_data->isWireframe;
+}
+
+void SoftwareEngine::ReloadTexture(int index)
+{
+    const auto& name = m_data->textures[index]->Name();
+    m_data->textures[index]->ReloadPixels() ?
+        Logger::LogInfo("Texture: " + name + " reload successful") :
+        Logger::LogError("Texture: " + name + " reload failed");
+}
+
+void SoftwareEngine::ReloadTerrain(int index)
+{
+}
+
+int SoftwareEngine::GetBytesUploaded() const
+{
+    return 0;
+}
+
+float SoftwareEngine::GetPresentTime() const
+{
+    return m_data->presentTime;
+}
+
+bool SoftwareEngine::RequiresGeometry() const
+{
+    // Meshes are transformed and rasterised from the scene each frame
+    return true;
+}
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_engine.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "render_engine.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+#include <Windows.h>
+
+class MeshData;
+class SwTexture;
+struct SwMaterial;
+struct SoftwareData;
+
+/**
+* Software Graphics engine, rasterises the scene on the cpu
+*/
+class SoftwareEngine : public RenderEngine
+{
+public:
+
+    /**
+    * Constructor
+    * @param hwnd Handle to the window
+    */
+    SoftwareEngine(HWND hwnd);
+
+    /**
+    * Destructor
+    */
+    ~SoftwareEngine();
+
+    /**
+    * Explicity releases resources for the engine
+    */
+    virtual void Release() override;
+
+    /**
+    * Sets up the graphics engine for rendering
+    * @return whether initialization succeeded
+    */
+    virtual bool Initialize() override;
+
+    /**
+    * Renders the 3D scene
+    * @param scene The elements making up the scene
+    * @param timer The time passed since scene start
+    */
+    virtual void Render(const IScene& scene,
+                        float timer) override;
+
+    /**
+    * Initialises the scene for the engine
+    * @param scene The elements making up the scene
+    * @return whether initialisation was successful
+    */
+    virtual bool InitialiseScene(const IScene& scene) override;
+
+    /**
+    * ReInitialises the scene for the software engine
+    * @return whether initialisation was successful
+    */
+    virtual bool ReInitialiseScene() override;
+
+    /**
+    * Reloads the texture at the given index
+    */
+    virtual void ReloadTexture(int index) override;
+
+    /**
+    * Reloads the terrain at the given index
+    * @note terrain vertices are read directly each frame
+    */
+    virtual void ReloadTerrain(int index) override;
+
+    /**
+    * Generates the shader for the engine
+    * @param index An unique index for the shader
+    * @return an error message if compilation failed
+    * @note shading is fixed function so there is nothing to compile
+    */
+    virtual std::string CompileShader(int index) override;
+
+    /**
+    * @return the name of the render engine
+    */
+    virtual std::string GetName() const override;
+
+    /**
+    * Updates the engine's cached view matrix
+    * @param world The world matrix of the camera
+    */
+    virtual void UpdateView(const Matrix& world) override;
+
+    /**
+    * Gets the text for a specific shader
+    * @param index The shader index
+    * @return the text for the shader
+    */
+    virtual std::string GetShaderText(int index) const override;
+
+    /**
+    * Gets the assembly for a specific shader
+    * @note does not block if the assembly is generated in the background
+    * @param index The shader index
+    * @param assembly Filled with the assembly for the shader once ready
+    * @return whether the assembly is ready
+    */
+    virtual bool GetShaderAssembly(int index, std::string& assembly) override;
+
+    /**
+    * Fades the screen in or out to black by the given amount
+    * @param in Whether to fade in or out
+    * @param amount The amount to fade by
+    * @return whether the fade has reached the capped target of [0,1]
+    */
+    virtual bool FadeView(bool in, float amount) override;
+
+    /**
+    * Explicitly sets the current amount of fade
+    * @param value The amount of fade between [0,1]
+    */
+    virtual void SetFade(float value) override;
+
+    /**
+    * Toggles whether meshes are rendered in wireframe
+    */
+    virtual void ToggleWireframe() override;
+
+    /**
+    * Creates a job to recompile a shader from new text
+    * @param index The shader index
+    * @param text The new text for the shader
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    virtual std::unique_ptr<ShaderCompileJob> CreateCompileJob(int index,
+                                                               const std::string& text) override;
+
+    /**
+    * Creates a job to recompile a shader from its regenerated files
+    * @param index The shader index
+    * @return the job to prepare on a worker thread and finish on the render thread
+    */
+    virtual std::unique_ptr<ShaderCompileJob> CreateReloadJob(int index) override;
+
+    /**
+    * @return the amount of bytes uploaded to the gpu during the last frame
+    */
+    virtual int GetBytesUploaded() const override;
+
+    /**
+    * @return the milliseconds spent presenting the last frame, including any wait on the gpu
+    */
+    virtual float GetPresentTime() const override;
+
+    /**
+    * @return whether the engine reads mesh geometry from the scene while rendering
+    */
+    virtual bool RequiresGeometry() const override;
+
+private:
+
+    /**
+    * Transforms and draws all visible instances of a mesh
+    * @param mesh The mesh to draw
+    * @param scene The scene to render
+    * @param material The material to draw with
+    */
+    void RenderMesh(const MeshData& mesh,
+                    const IScene& scene,
+                    SwMaterial& material);
+
+    /**
+    * Renders the scene meshes
+    * @param scene The scene to render
+    */
+    void RenderMeshes(const IScene& scene);
+
+    /**
+    * Renders the scene terrain
+    * @param scene The scene to render
+    */
+    void RenderTerrain(const IScene& scene);
+
+    /**
+    * Renders the scene water
+    * @param scene The scene to render
+    */
+    void RenderWater(const IScene& scene);
+
+    /**
+    * Renders all emitters as camera facing quads
+    * @param scene The scene to render
+    */
+    void RenderEmitters(const IScene& scene);
+
+    /**
+    * Copies the rendered image to the window
+    */
+    void Present();
+
+    /**
+    * @param ID The ID of the texture or -1 for none
+    * @return the texture to sample or null for none
+    */
+    const SwTexture* GetTexture(int ID) const;
+
+private:
+
+    HWND m_hwnd = nullptr;                 ///< handle to the window
+    std::unique_ptr<SoftwareData> m_data;  ///< member data of the software engine
+};
@@ -0,0 +1,298 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_post_processing.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "software_post_processing.h"
+#include "software_worker_pool.h"
+#include "postprocessing.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const int BAND_ROWS = 16;             ///< Number of rows processed by each job
+    const int MAX_BLUR_TAPS = 16;         ///< Maximum samples taken along each blur axis
+    const float TO_FLOAT = 1.0f / 255.0f; ///< Converts a channel to [0,1]
+
+    /**
+    * @return a register holding the colour in the first three components
+    */
+    __m128 LoadColour(const Colour& colour, float alpha = 0.0f)
+    {
+        return _mm_setr_ps(colour.r, colour.g, colour.b, alpha);
+    }
+
+    /**
+    * @return the weight clamped between [0,1] for each component
+    */
+    __m128 Saturate(__m128 value)
+    {
+        return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+
+    /**
+    * @return the largest of the first three components broadcast to all components
+    */
+    __m128 MaxComponent(__m128 value)
+    {
+        const __m128 rg = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 0, 1)));
+        const __m128 rgb = _mm_max_ps(rg, _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 2, 2)));
+        return _mm_shuffle_ps(rgb, rgb, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+
+    /**
+    * @return the dot product of the first three components broadcast to all components
+    */
+    __m128 Dot3(__m128 a, __m128 b)
+    {
+        const __m128 product = _mm_mul_ps(a, b);
+        const __m128 sum = _mm_add_ps(_mm_add_ps(product,
+            _mm_shuffle_ps(product, product, _MM_SHUFFLE(3, 3, 3, 1))),
+            _mm_shuffle_ps(product, product, _MM_SHUFFLE(3, 3, 3, 2)));
+        return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+    }
+
+    /**
+    * Converts an RGB colour to opaque packed BGRA
+    */
+    unsigned int Pack(__m128 colour)
+    {
+        const __m128 bgra = _mm_shuffle_ps(colour, colour, _MM_SHUFFLE(3, 0, 1, 2));
+        const __m128 scaled = _mm_mul_ps(Saturate(bgra), _mm_set1_ps(255.0f));
+        const __m128i channels = _mm_cvtps_epi32(scaled);
+        const __m128i shorts = _mm_packs_epi32(channels, channels);
+        const __m128i packed = _mm_packus_epi16(shorts, shorts);
+        return static_cast<unsigned int>(_mm_cvtsi128_si32(packed)) | 0xFF000000;
+    }
+}
+
+SwPostProcessing::SwPostProcessing(int width, int height, SwWorkerPool& workers)
+    : m_width(width)
+    , m_height(height)
+    , m_workers(workers)
+{
+}
+
+bool SwPostProcessing::Initialise()
+{
+    const int components = m_width * m_height * 4;
+    m_scene.assign(components, 0.0f);
+    m_blurHorizontal.assign(components, 0.0f);
+    m_blur.assign(components, 0.0f);
+    m_output.assign(m_width * m_height, 0xFF000000);
+    m_bands = (m_height + BAND_ROWS - 1) / BAND_ROWS;
+    return true;
+}
+
+void SwPostProcessing::Release()
+{
+    m_scene.clear();
+    m_blurHorizontal.clear();
+    m_blur.clear();
+    m_output.clear();
+    m_tapsHorizontal.clear();
+    m_tapsVertical.clear();
+}
+
+void SwPostProcessing::Render(const PostProcessing& post,
+                              const std::vector<unsigned int>& scene,
+                              const std::vector<float>& depth,
+                              float fadeAmount)
+{
+    UpdateBlurTaps(post);
+
+    // Each pass samples the rows of its neighbours so must complete before the next
+    m_workers.Run(m_bands, [&](int band){ RenderPreEffects(post, scene, band); });
+    m_workers.Run(m_bands, [&](int band){ RenderBlur(m_scene, m_blurHorizontal, true, band); });
+    m_workers.Run(m_bands, [&](int band){ RenderBlur(m_blurHorizontal, m_blur, false, band); });
+    m_workers.Run(m_bands, [&](int band){ RenderPostEffects(post, depth, fadeAmount, band); });
+}
+
+void SwPostProcessing::UpdateBlurTaps(const PostProcessing& post)
+{
+    const auto& weights = post.GetBlurWeights();
+    const int radius = std::min(static_cast<int>(weights.size()), (MAX_BLUR_TAPS + 1) / 2) - 1;
+
+    auto generate = [&](std::vector<BlurTap>& taps, int size)
+    {
+        taps.clear();
+        for (int i = -radius; i <= radius; ++i)
+        {
+            // Offsets are in texture coordinates and sampled with linear filtering
+            const float offset = i * post.BlurStep() * size;
+            BlurTap tap;
+            tap.offset = static_cast<int>(std::floor(offset));
+            tap.amount = offset - std::floor(offset);
+            tap.weight = weights[std::abs(i)];
+            taps.push_back(tap);
+        }
+    };
+
+    generate(m_tapsHorizontal, m_width);
+    generate(m_tapsVertical, m_height);
+}
+
+void SwPostProcessing::RenderPreEffects(const PostProcessing& post,
+                                        const std::vector<unsigned int>& scene,
+                                        int band)
+{
+    // Map range from end->start to 0->1
+    const float bloomEnd = post.BloomStart() - post.BloomFade();
+    const __m128 end = _mm_set1_ps(bloomEnd);
+    const __m128 scale = _mm_set1_ps(1.0f / (post.BloomStart() - bloomEnd));
+    const __m128 rgbMask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+    const int startRow = band * BAND_ROWS;
+    const int endRow = std::min(startRow + BAND_ROWS, m_height);
+    for (int pixel = startRow * m_width; pixel < endRow * m_width; ++pixel)
+    {
+        const unsigned int packed = scene[pixel];
+        const __m128 colour = _mm_mul_ps(_mm_setr_ps(
+            static_cast<float>((packed >> 16) & 0xFF),
+            static_cast<float>((packed >> 8) & 0xFF),
+            static_cast<float>(packed & 0xFF), 0.0f), _mm_set1_ps(TO_FLOAT));
+
+        const __m128 bloom = MaxComponent(Saturate(_mm_mul_ps(_mm_sub_ps(colour, end), scale)));
+        _mm_storeu_ps(&m_scene[pixel * 4], _mm_or_ps(
+            _mm_and_ps(rgbMask, colour), _mm_andnot_ps(rgbMask, bloom)));
+    }
+}
+
+void SwPostProcessing::RenderBlur(const std::vector<float>& source,
+                                  std::vector<float>& target,
+                                  bool horizontal,
+                                  int band)
+{
+    const auto& taps = horizontal ? m_tapsHorizontal : m_tapsVertical;
+    const int size = horizontal ? m_width : m_height;
+    const int stride = horizontal ? 4 : m_width * 4;
+    const int tapCount = static_cast<int>(taps.size());
+
+    __m128 firstWeights[MAX_BLUR_TAPS];
+    __m128 secondWeights[MAX_BLUR_TAPS];
+    for (int i = 0; i < tapCount; ++i)
+    {
+        firstWeights[i] = _mm_set1_ps(taps[i].weight * (1.0f - taps[i].amount));
+        secondWeights[i] = _mm_set1_ps(taps[i].weight * taps[i].amount);
+    }
+
+    // Pixels between these do not sample outside the image
+    const int innerStart = -taps.front().offset;
+    const int innerEnd = size - taps.back().offset - 1;
+
+    const int startRow = band * BAND_ROWS;
+    const int endRow = std::min(startRow + BAND_ROWS, m_height);
+    for (int y = startRow; y < endRow; ++y)
+    {
+        for (int x = 0; x < m_width; ++x)
+        {
+            const int position = horizontal ? x : y;
+            const float* pixel = &source[(y * m_width + x) * 4];
+            __m128 sum = _mm_setzero_ps();
+
+            if (position >= innerStart && position < innerEnd)
+            {
+                for (int i = 0; i < tapCount; ++i)
+                {
+                    const float* first = pixel + taps[i].offset * stride;
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(first), firstWeights[i]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(first + stride), secondWeights[i]));
+                }
+            }
+            else
+            {
+                // Samples outside the image are clamped to the edge
+                const float* base = pixel - position * stride;
+                for (int i = 0; i < tapCount; ++i)
+                {
+                    const int first = std::min(std::max(position + taps[i].offset, 0), size - 1);
+                    const int second = std::min(std::max(position + taps[i].offset + 1, 0), size - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(base + first * stride), firstWeights[i]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(base + second * stride), secondWeights[i]));
+                }
+            }
+
+            _mm_storeu_ps(&target[(y * m_width + x) * 4], sum);
+        }
+    }
+}
+
+void SwPostProcessing::RenderPostEffects(const PostProcessing& post,
+                                         const std::vector<float>& depth,
+                                         float fadeAmount,
+                                         int band)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 fogColour = LoadColour(post.FogColour());
+    const __m128 minimumColour = LoadColour(post.MinColour());
+    const __m128 colourRange = _mm_sub_ps(LoadColour(post.MaxColour()), minimumColour);
+    const __m128 luminanceWeights = _mm_setr_ps(0.2126f, 0.7152f, 0.0722f, 0.0f);
+    const __m128 saturation = _mm_set1_ps(post.Saturation());
+    const __m128 contrast = _mm_set1_ps(post.Contrast());
+    const __m128 bloomIntensity = _mm_set1_ps(post.BloomIntensity());
+    const __m128 fade = _mm_set1_ps(fadeAmount);
+
+    const __m128 finalMask = _mm_set1_ps(post.Mask(PostProcessing::Final));
+    const __m128 sceneMask = _mm_set1_ps(post.Mask(PostProcessing::Scene));
+    const __m128 depthMask = _mm_set1_ps(post.Mask(PostProcessing::Depth));
+    const __m128 blurMask = _mm_set1_ps(post.Mask(PostProcessing::Blur));
+    const __m128 dofMask = _mm_set1_ps(post.Mask(PostProcessing::Dof));
+    const __m128 fogMask = _mm_set1_ps(post.Mask(PostProcessing::Fog));
+    const __m128 bloomMask = _mm_set1_ps(post.Mask(PostProcessing::Bloom));
+
+    const float dofEnd = post.DOFStart() - post.DOFFade();
+    const float dofScale = 1.0f / (post.DOFStart() - dofEnd);
+    const float fogEnd = post.FogStart() + post.FogFade();
+    const float fogScale = 1.0f / (post.FogStart() - fogEnd);
+
+    const int startRow = band * BAND_ROWS;
+    const int endRow = std::min(startRow + BAND_ROWS, m_height);
+    for (int pixel = startRow * m_width; pixel < endRow * m_width; ++pixel)
+    {
+        const __m128 scene = _mm_loadu_ps(&m_scene[pixel * 4]);
+        const __m128 blur = _mm_loadu_ps(&m_blur[pixel * 4]);
+        const __m128 pixelDepth = _mm_set1_ps(depth[pixel]);
+
+        // Depth of Field
+        const __m128 dofWeight = Saturate(_mm_set1_ps((depth[pixel] - dofEnd) * dofScale));
+        const __m128 depthOfField = _mm_mul_ps(blur, dofWeight);
+        __m128 postScene = _mm_add_ps(_mm_mul_ps(scene, _mm_sub_ps(one, dofWeight)), depthOfField);
+
+        // Fog
+        const __m128 fogWeight = Saturate(_mm_set1_ps((depth[pixel] - fogEnd) * fogScale));
+        const __m128 fog = _mm_mul_ps(fogColour, fogWeight);
+        postScene = _mm_add_ps(_mm_mul_ps(postScene, _mm_sub_ps(one, fogWeight)), fog);
+
+        // Bloom
+        const __m128 bloomAmount = _mm_shuffle_ps(blur, blur, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128 bloom = _mm_mul_ps(_mm_mul_ps(blur, bloomAmount), bloomIntensity);
+        postScene = _mm_add_ps(postScene, bloom);
+
+        // Colour Correction
+        postScene = _mm_add_ps(_mm_mul_ps(Saturate(postScene), colourRange), minimumColour);
+
+        // Contrast and saturation
+        const __m128 luminance = Dot3(postScene, luminanceWeights);
+        postScene = _mm_add_ps(luminance, _mm_mul_ps(_mm_sub_ps(postScene, luminance), saturation));
+        postScene = _mm_sub_ps(postScene, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(contrast,
+            _mm_sub_ps(postScene, one)), postScene), _mm_sub_ps(postScene, half)));
+
+        // Masking the selected texture
+        __m128 output = _mm_mul_ps(postScene, finalMask);
+        output = _mm_add_ps(output, _mm_mul_ps(scene, sceneMask));
+        output = _mm_add_ps(output, _mm_mul_ps(pixelDepth, depthMask));
+        output = _mm_add_ps(output, _mm_mul_ps(blur, blurMask));
+        output = _mm_add_ps(output, _mm_mul_ps(depthOfField, dofMask));
+        output = _mm_add_ps(output, _mm_mul_ps(fog, fogMask));
+        output = _mm_add_ps(output, _mm_mul_ps(bloom, bloomMask));
+        m_output[pixel] = Pack(_mm_mul_ps(output, fade));
+    }
+}
+
+const std::vector<unsigned int>& SwPostProcessing::GetPixels() const
+{
+    return m_output;
+}
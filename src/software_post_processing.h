@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_post_processing.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+class PostProcessing;
+class SwWorkerPool;
+
+/**
+* Cpu implementation of the post processing chain. Mirrors the pre effects,
+* two pass blur and post effects shaders so results can be compared against
+* the gpu engines. Each pass runs in bands of rows across the worker pool
+* with a pixel held as a four component SSE register
+*/
+class SwPostProcessing : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param width The width of the image in pixels
+    * @param height The height of the image in pixels
+    * @param workers The pool to run each pass with
+    */
+    SwPostProcessing(int width, int height, SwWorkerPool& workers);
+
+    /**
+    * Allocates the intermediate images
+    * @return whether initialisation succeeded
+    */
+    bool Initialise();
+
+    /**
+    * Releases the intermediate images
+    */
+    void Release();
+
+    /**
+    * Runs all post processing passes on the scene
+    * @param post The post processing values to use
+    * @param scene The packed BGRA scene
+    * @param depth The normalised scene depth from one at the near plane
+    * @param fadeAmount The amount to fade the final image by
+    */
+    void Render(const PostProcessing& post,
+                const std::vector<unsigned int>& scene,
+                const std::vector<float>& depth,
+                float fadeAmount);
+
+    /**
+    * @return the final image as packed BGRA rows from the top of the image
+    */
+    const std::vector<unsigned int>& GetPixels() const;
+
+private:
+
+    /**
+    * Converts the scene to floating point and stores the bloom amount in alpha
+    * @param post The post processing values to use
+    * @param scene The packed BGRA scene
+    * @param band The band of rows to process
+    */
+    void RenderPreEffects(const PostProcessing& post,
+                          const std::vector<unsigned int>& scene,
+                          int band);
+
+    /**
+    * Blurs a band of rows along a single axis
+    * @param source The image to blur
+    * @param target The image to write to
+    * @param horizontal Whether to blur horizontally or vertically
+    * @param band The band of rows to process
+    */
+    void RenderBlur(const std::vector<float>& source,
+                    std::vector<float>& target,
+                    bool horizontal,
+                    int band);
+
+    /**
+    * Combines the scene, blur and depth into the final image
+    * @param post The post processing values to use
+    * @param depth The normalised scene depth
+    * @param fadeAmount The amount to fade the final image by
+    * @param band The band of rows to process
+    */
+    void RenderPostEffects(const PostProcessing& post,
+                           const std::vector<float>& depth,
+                           float fadeAmount,
+                           int band);
+
+    /**
+    * Generates the offsets and weights for each blur tap
+    * @param post The post processing values to use
+    */
+    void UpdateBlurTaps(const PostProcessing& post);
+
+    /**
+    * A single sample of the blur between two pixels
+    */
+    struct BlurTap
+    {
+        int offset = 0;          ///< Pixel offset of the first pixel sampled
+        float amount = 0.0f;     ///< Amount to interpolate towards the next pixel
+        float weight = 0.0f;     ///< Weight of the sample
+    };
+
+private:
+
+    int m_width = 0;                            ///< Width of the image
+    int m_height = 0;                           ///< Height of the image
+    int m_bands = 0;                            ///< Number of row bands for each pass
+    SwWorkerPool& m_workers;                    ///< Pool to run each pass with
+    std::vector<float> m_scene;                 ///< RGBA scene with bloom amount in alpha
+    std::vector<float> m_blurHorizontal;        ///< RGBA scene blurred horizontally
+    std::vector<float> m_blur;                  ///< RGBA scene blurred in both directions
+    std::vector<unsigned int> m_output;         ///< Packed BGRA final image
+    std::vector<BlurTap> m_tapsHorizontal;      ///< Samples for the horizontal blur
+    std::vector<BlurTap> m_tapsVertical;        ///< Samples for the vertical blur
+};
@@ -0,0 +1,448 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_rasteriser.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "software_rasteriser.h"
+#include "software_texture.h"
+#include "software_worker_pool.h"
+
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+    const int TILE_SIZE = 64;                     ///< Width and height of a tile in pixels, a multiple of four
+    const int MAX_CLIPPED = 4;                    ///< Maximum vertices from clipping a triangle to the near plane
+    const float EDGE_BIAS = 1.0e-4f;              ///< Excludes pixels exactly on an edge not owned by the triangle
+    const float WIREFRAME_WIDTH = 1.0f;           ///< Pixel width of edges when rendering wireframe
+    const unsigned int CLEAR_COLOUR = 0xFF000000; ///< Opaque black in packed BGRA
+
+    /**
+    * Linearly interpolates between two vertices
+    */
+    SwVertex Lerp(const SwVertex& v0, const SwVertex& v1, float amount)
+    {
+        SwVertex vertex;
+        vertex.position = glm::mix(v0.position, v1.position, amount);
+        vertex.world = glm::mix(v0.world, v1.world, amount);
+        vertex.normal = glm::mix(v0.normal, v1.normal, amount);
+        vertex.uvs = glm::mix(v0.uvs, v1.uvs, amount);
+        return vertex;
+    }
+
+    /**
+    * Clips a triangle to the near plane
+    * @param input The three vertices of the triangle
+    * @param output The vertices of the clipped polygon
+    * @return the number of vertices in the clipped polygon
+    */
+    int ClipNear(const SwVertex* input, SwVertex* output)
+    {
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const SwVertex& current = input[i];
+            const SwVertex& next = input[(i + 1) % 3];
+            const float currentDistance = current.position.z + current.position.w;
+            const float nextDistance = next.position.z + next.position.w;
+
+            if (currentDistance >= 0.0f)
+            {
+                output[count++] = current;
+            }
+            if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            {
+                const float amount = currentDistance / (currentDistance - nextDistance);
+                output[count++] = Lerp(current, next, amount);
+            }
+        }
+        return count;
+    }
+
+    /**
+    * @return whether all vertices are outside the same side of the view volume
+    */
+    bool IsOutsideView(const SwVertex& v0, const SwVertex& v1, const SwVertex& v2)
+    {
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (v0.position[axis] > v0.position.w &&
+                v1.position[axis] > v1.position.w &&
+                v2.position[axis] > v2.position.w)
+            {
+                return true;
+            }
+            if (v0.position[axis] < -v0.position.w &&
+                v1.position[axis] < -v1.position.w &&
+                v2.position[axis] < -v2.position.w)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+    * Converts a colour to packed BGRA
+    */
+    unsigned int Pack(const glm::vec3& colour)
+    {
+        const glm::vec3 clamped = glm::clamp(colour, 0.0f, 1.0f) * 255.0f + 0.5f;
+        return CLEAR_COLOUR |
+            (static_cast<unsigned int>(clamped.r) << 16) |
+            (static_cast<unsigned int>(clamped.g) << 8) |
+            static_cast<unsigned int>(clamped.b);
+    }
+
+    /**
+    * Converts packed BGRA to a colour
+    */
+    glm::vec3 Unpack(unsigned int colour)
+    {
+        return glm::vec3((colour >> 16) & 0xFF, (colour >> 8) & 0xFF, colour & 0xFF) / 255.0f;
+    }
+}
+
+SwRasteriser::SwRasteriser(int width, int height, SwWorkerPool& workers)
+    : m_width(width)
+    , m_height(height)
+    , m_workers(workers)
+{
+    assert(width % 4 == 0);
+}
+
+SwRasteriser::~SwRasteriser()
+{
+    Release();
+}
+
+bool SwRasteriser::Initialise()
+{
+    m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_colour.assign(m_width * m_height, CLEAR_COLOUR);
+    m_depth.assign(m_width * m_height, 1.0f);
+    m_sceneDepth.assign(m_width * m_height, 0.0f);
+    m_bins.resize(m_tilesX * m_tilesY);
+    return true;
+}
+
+void SwRasteriser::Release()
+{
+    m_colour.clear();
+    m_depth.clear();
+    m_sceneDepth.clear();
+    m_bins.clear();
+    m_triangles.clear();
+    m_materials.clear();
+}
+
+void SwRasteriser::BeginFrame(const SwFrame& frame)
+{
+    m_frame = frame;
+    m_triangles.clear();
+    m_materials.clear();
+    for (auto& bin : m_bins)
+    {
+        bin.clear();
+    }
+}
+
+void SwRasteriser::SetMaterial(const SwMaterial& material)
+{
+    m_materials.push_back(material);
+}
+
+void SwRasteriser::DrawTriangle(const SwVertex& v0, const SwVertex& v1, const SwVertex& v2)
+{
+    if (m_materials.empty() || IsOutsideView(v0, v1, v2))
+    {
+        return;
+    }
+
+    const SwVertex input[3] = { v0, v1, v2 };
+    SwVertex clipped[MAX_CLIPPED];
+    const int count = ClipNear(input, clipped);
+
+    for (int i = 2; i < count; ++i)
+    {
+        BinTriangle(clipped[0], clipped[i - 1], clipped[i]);
+    }
+}
+
+void SwRasteriser::BinTriangle(const SwVertex& v0, const SwVertex& v1, const SwVertex& v2)
+{
+    const SwVertex* vertices[3] = { &v0, &v1, &v2 };
+    const float halfWidth = m_width * 0.5f;
+    const float halfHeight = m_height * 0.5f;
+
+    float x[3], y[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec4& position = vertices[i]->position;
+        x[i] = (position.x / position.w + 1.0f) * halfWidth;
+        y[i] = (1.0f - position.y / position.w) * halfHeight;
+    }
+
+    // Counter clockwise triangles in device space are clockwise once y is flipped
+    const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    const bool isFrontFacing = area < 0.0f;
+    if (area == 0.0f || (!isFrontFacing && m_materials.back().backfaceCull))
+    {
+        return;
+    }
+
+    // Wind all triangles so the area and edge functions inside are positive
+    const int order[3] = { 0, isFrontFacing ? 2 : 1, isFrontFacing ? 1 : 2 };
+
+    Triangle triangle;
+    triangle.material = static_cast<int>(m_materials.size()) - 1;
+    triangle.invArea = 1.0f / std::abs(area);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const SwVertex& vertex = *vertices[order[i]];
+        const float invW = 1.0f / vertex.position.w;
+        triangle.invW[i] = invW;
+        triangle.z[i] = vertex.position.z * invW;
+        triangle.uvs[i] = vertex.uvs * invW;
+        triangle.world[i] = vertex.world * invW;
+        triangle.normal[i] = vertex.normal * invW;
+    }
+
+    float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 0; i < 3; ++i)
+    {
+        const int start = order[(i + 1) % 3];
+        const int end = order[(i + 2) % 3];
+
+        // Edge function opposite each vertex, giving its barycentric weight
+        const float a = y[start] - y[end];
+        const float b = x[end] - x[start];
+        const bool ownsEdge = a > 0.0f || (a == 0.0f && b > 0.0f);
+
+        triangle.a[i] = a;
+        triangle.b[i] = b;
+        triangle.c[i] = x[start] * y[end] - y[start] * x[end] - (ownsEdge ? 0.0f : EDGE_BIAS);
+        triangle.edgeScale[i] = 1.0f / std::sqrt(a * a + b * b);
+
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+    }
+
+    triangle.minX = std::max(0, static_cast<int>(std::floor(minX)));
+    triangle.minY = std::max(0, static_cast<int>(std::floor(minY)));
+    triangle.maxX = std::min(m_width - 1, static_cast<int>(std::ceil(maxX)));
+    triangle.maxY = std::min(m_height - 1, static_cast<int>(std::ceil(maxY)));
+
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    {
+        return;
+    }
+
+    const int index = static_cast<int>(m_triangles.size());
+    m_triangles.push_back(triangle);
+
+    for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; ++tileY)
+    {
+        for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; ++tileX)
+        {
+            m_bins[tileY * m_tilesX + tileX].push_back(index);
+        }
+    }
+}
+
+void SwRasteriser::EndFrame()
+{
+    m_workers.Run(static_cast<int>(m_bins.size()),
+        [this](int tile){ RasteriseTile(tile); });
+}
+
+void SwRasteriser::RasteriseTile(int tile)
+{
+    const int tileX = (tile % m_tilesX) * TILE_SIZE;
+    const int tileY = (tile / m_tilesX) * TILE_SIZE;
+    const int tileMaxX = std::min(tileX + TILE_SIZE, m_width) - 1;
+    const int tileMaxY = std::min(tileY + TILE_SIZE, m_height) - 1;
+    const int tileWidth = tileMaxX - tileX + 1;
+
+    for (int y = tileY; y <= tileMaxY; ++y)
+    {
+        std::fill_n(&m_colour[y * m_width + tileX], tileWidth, CLEAR_COLOUR);
+        std::fill_n(&m_depth[y * m_width + tileX], tileWidth, 1.0f);
+        std::fill_n(&m_sceneDepth[y * m_width + tileX], tileWidth, 0.0f);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+    for (const int index : m_bins[tile])
+    {
+        const Triangle& triangle = m_triangles[index];
+        const SwMaterial& material = m_materials[triangle.material];
+
+        // Start on a multiple of four so each group stays within the tile
+        const int minX = std::max(triangle.minX, tileX) & ~3;
+        const int maxX = std::min(triangle.maxX, tileMaxX);
+        const int minY = std::max(triangle.minY, tileY);
+        const int maxY = std::min(triangle.maxY, tileMaxY);
+
+        const __m128 a0 = _mm_set1_ps(triangle.a[0]);
+        const __m128 a1 = _mm_set1_ps(triangle.a[1]);
+        const __m128 a2 = _mm_set1_ps(triangle.a[2]);
+        const __m128 z0 = _mm_set1_ps(triangle.z[0]);
+        const __m128 z1 = _mm_set1_ps(triangle.z[1]);
+        const __m128 z2 = _mm_set1_ps(triangle.z[2]);
+        const __m128 invArea = _mm_set1_ps(triangle.invArea);
+
+        for (int y = minY; y <= maxY; ++y)
+        {
+            const float pixelY = y + 0.5f;
+            const __m128 row0 = _mm_set1_ps(triangle.b[0] * pixelY + triangle.c[0]);
+            const __m128 row1 = _mm_set1_ps(triangle.b[1] * pixelY + triangle.c[1]);
+            const __m128 row2 = _mm_set1_ps(triangle.b[2] * pixelY + triangle.c[2]);
+
+            for (int x = minX; x <= maxX; x += 4)
+            {
+                const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), pixelOffsets);
+                const __m128 w0 = _mm_add_ps(_mm_mul_ps(a0, pixelX), row0);
+                const __m128 w1 = _mm_add_ps(_mm_mul_ps(a1, pixelX), row1);
+                const __m128 w2 = _mm_add_ps(_mm_mul_ps(a2, pixelX), row2);
+
+                __m128 mask = _mm_and_ps(_mm_and_ps(
+                    _mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+
+                if (_mm_movemask_ps(mask) == 0)
+                {
+                    continue;
+                }
+
+                const int pixel = y * m_width + x;
+                const __m128 l0 = _mm_mul_ps(w0, invArea);
+                const __m128 l1 = _mm_mul_ps(w1, invArea);
+                const __m128 l2 = _mm_mul_ps(w2, invArea);
+                const __m128 depth = _mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(l0, z0), _mm_mul_ps(l1, z1)), _mm_mul_ps(l2, z2));
+
+                mask = _mm_and_ps(mask, _mm_cmplt_ps(depth, _mm_loadu_ps(&m_depth[pixel])));
+                const int covered = _mm_movemask_ps(mask);
+                if (covered == 0)
+                {
+                    continue;
+                }
+
+                alignas(16) float weights[3][4];
+                alignas(16) float depths[4];
+                _mm_store_ps(weights[0], l0);
+                _mm_store_ps(weights[1], l1);
+                _mm_store_ps(weights[2], l2);
+                _mm_store_ps(depths, depth);
+
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if ((covered & (1 << lane)) == 0)
+                    {
+                        continue;
+                    }
+
+                    if (m_frame.wireframe)
+                    {
+                        const float area = 1.0f / triangle.invArea;
+                        const float distance = std::min(std::min(
+                            weights[0][lane] * area * triangle.edgeScale[0],
+                            weights[1][lane] * area * triangle.edgeScale[1]),
+                            weights[2][lane] * area * triangle.edgeScale[2]);
+
+                        if (distance > WIREFRAME_WIDTH)
+                        {
+                            continue;
+                        }
+                    }
+
+                    const glm::vec4 colour = ShadePixel(triangle,
+                        weights[0][lane], weights[1][lane], weights[2][lane]);
+
+                    unsigned int& target = m_colour[pixel + lane];
+                    target = material.alphaBlend ?
+                        Pack(glm::mix(Unpack(target), glm::vec3(colour), colour.a)) :
+                        Pack(glm::vec3(colour));
+
+                    if (material.depthWrite)
+                    {
+                        // Matches the normalised depth written by the scene shaders
+                        const float w = 1.0f / (weights[0][lane] * triangle.invW[0] +
+                            weights[1][lane] * triangle.invW[1] + weights[2][lane] * triangle.invW[2]);
+
+                        m_depth[pixel + lane] = depths[lane];
+                        m_sceneDepth[pixel + lane] = 1.0f - (depths[lane] * w - m_frame.depthNear) /
+                            (m_frame.depthFar - m_frame.depthNear);
+                    }
+                }
+            }
+        }
+    }
+}
+
+glm::vec4 SwRasteriser::ShadePixel(const Triangle& triangle, float l0, float l1, float l2) const
+{
+    const SwMaterial& material = m_materials[triangle.material];
+
+    // Attributes were divided by w for perspective correct interpolation
+    const float w = 1.0f / (l0 * triangle.invW[0] + l1 * triangle.invW[1] + l2 * triangle.invW[2]);
+    const glm::vec2 uvs = (l0 * triangle.uvs[0] + l1 * triangle.uvs[1] + l2 * triangle.uvs[2]) * w;
+    const glm::vec3 world = (l0 * triangle.world[0] + l1 * triangle.world[1] + l2 * triangle.world[2]) * w;
+    const glm::vec3 toCamera = m_frame.cameraPosition - world;
+
+    glm::vec4 colour = material.tint;
+    if (material.diffuse)
+    {
+        colour *= material.diffuse->Sample(uvs);
+    }
+
+    if (material.lit)
+    {
+        const glm::vec3 normal = glm::normalize(
+            l0 * triangle.normal[0] + l1 * triangle.normal[1] + l2 * triangle.normal[2]);
+        const glm::vec3 view = glm::normalize(toCamera);
+        const float specularMap = material.specular ? material.specular->Sample(uvs).r : 0.0f;
+
+        glm::vec3 diffuse(0.0f), specular(0.0f);
+        for (const SwLight& light : m_frame.lights)
+        {
+            glm::vec3 toLight = light.position - world;
+            const float distance = glm::length(toLight);
+            toLight /= distance;
+
+            const float attenuation = light.active / (light.attenuation.x +
+                light.attenuation.y * distance + light.attenuation.z * distance * distance);
+
+            const float lambert = std::max(glm::dot(normal, toLight), 0.0f);
+            diffuse += light.diffuse * lambert * attenuation;
+
+            if (specularMap > 0.0f && lambert > 0.0f)
+            {
+                const glm::vec3 halfVector = glm::normalize(toLight + view);
+                const float highlight = std::pow(std::max(glm::dot(normal, halfVector), 0.0f), light.specularity);
+                specular += light.specular * highlight * specularMap * attenuation;
+            }
+        }
+
+        colour = glm::vec4(glm::vec3(colour) * diffuse + specular, colour.a);
+    }
+
+    return colour;
+}
+
+const std::vector<unsigned int>& SwRasteriser::GetPixels() const
+{
+    return m_colour;
+}
+
+const std::vector<float>& SwRasteriser::GetSceneDepth() const
+{
+    return m_sceneDepth;
+}
@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_rasteriser.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+class SwTexture;
+class SwWorkerPool;
+
+/**
+* Vertex after transformation by the software engine
+*/
+struct SwVertex
+{
+    glm::vec4 position;  ///< Clip space position
+    glm::vec3 world;     ///< World space position
+    glm::vec3 normal;    ///< World space normal
+    glm::vec2 uvs;       ///< Texture coordinates
+};
+
+/**
+* Fixed function state used to shade triangles
+*/
+struct SwMaterial
+{
+    const SwTexture* diffuse = nullptr;   ///< Diffuse texture or null for white
+    const SwTexture* specular = nullptr;  ///< Specular texture or null for no specular
+    glm::vec4 tint = glm::vec4(1.0f);     ///< Colour multiplied with the diffuse
+    bool lit = true;                      ///< Whether lighting is applied
+    bool alphaBlend = false;              ///< Whether to blend with the colour buffer
+    bool depthWrite = true;               ///< Whether to write to the depth buffer
+    bool backfaceCull = true;             ///< Whether back facing triangles are culled
+};
+
+/**
+* Point light used to shade triangles
+*/
+struct SwLight
+{
+    glm::vec3 position;           ///< World position of the light
+    glm::vec3 diffuse;            ///< Diffuse colour of the light
+    glm::vec3 specular;           ///< Specular colour of the light
+    glm::vec3 attenuation;        ///< Constant, linear and quadratic attenuation
+    float specularity = 1.0f;     ///< Specular power of the light
+    float active = 1.0f;          ///< Whether the light is active
+};
+
+/**
+* Per frame state used to shade triangles
+*/
+struct SwFrame
+{
+    std::vector<SwLight> lights;            ///< Lights in the scene
+    glm::vec3 cameraPosition;               ///< World position of the camera
+    float depthNear = 0.0f;                 ///< Distance of the near depth value
+    float depthFar = 1.0f;                  ///< Distance of the far depth value
+    bool wireframe = false;                 ///< Whether to only draw triangle edges
+};
+
+/**
+* Multithreaded tile based rasteriser. Triangles are clipped and binned into
+* screen tiles as they are drawn, then each tile is rasterised in submission
+* order across the worker pool, testing four pixels at a time with SSE
+*/
+class SwRasteriser : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param width The width of the colour buffer in pixels, a multiple of four
+    * @param height The height of the colour buffer in pixels
+    * @param workers The pool to rasterise tiles with
+    */
+    SwRasteriser(int width, int height, SwWorkerPool& workers);
+
+    /**
+    * Destructor
+    */
+    ~SwRasteriser();
+
+    /**
+    * Allocates the buffers
+    * @return whether initialisation succeeded
+    */
+    bool Initialise();
+
+    /**
+    * Releases the buffers
+    */
+    void Release();
+
+    /**
+    * Begins a new frame
+    * @param frame The state to shade the frame with
+    */
+    void BeginFrame(const SwFrame& frame);
+
+    /**
+    * Sets the material for all triangles drawn after this call
+    * @param material The material to shade with
+    */
+    void SetMaterial(const SwMaterial& material);
+
+    /**
+    * Clips and bins a triangle
+    * @param v0/v1/v2 The vertices of the triangle, counter clockwise facing forward
+    */
+    void DrawTriangle(const SwVertex& v0, const SwVertex& v1, const SwVertex& v2);
+
+    /**
+    * Rasterises all binned triangles across the workers
+    */
+    void EndFrame();
+
+    /**
+    * @return the colour buffer as packed BGRA rows from the top of the image
+    */
+    const std::vector<unsigned int>& GetPixels() const;
+
+    /**
+    * @return the normalised scene depth from one at the near plane, as written by the scene shaders
+    */
+    const std::vector<float>& GetSceneDepth() const;
+
+private:
+
+    /**
+    * Triangle prepared for rasterisation
+    */
+    struct Triangle
+    {
+        float a[3];              ///< X coefficient for each edge function
+        float b[3];              ///< Y coefficient for each edge function
+        float c[3];              ///< Constant for each edge function
+        float edgeScale[3];      ///< Converts each edge function into a pixel distance
+        float z[3];              ///< Normalised device depth of each vertex
+        float invW[3];           ///< Reciprocal clip space w of each vertex
+        glm::vec2 uvs[3];        ///< Texture coordinates divided by w
+        glm::vec3 world[3];      ///< World positions divided by w
+        glm::vec3 normal[3];     ///< Normals divided by w
+        float invArea = 0.0f;    ///< Reciprocal of twice the screen area
+        int minX = 0;            ///< Left most pixel covered
+        int minY = 0;            ///< Top most pixel covered
+        int maxX = 0;            ///< Right most pixel covered
+        int maxY = 0;            ///< Bottom most pixel covered
+        int material = 0;        ///< Index of the material to shade with
+    };
+
+    /**
+    * Sets up a clipped triangle and adds it to the tiles it overlaps
+    */
+    void BinTriangle(const SwVertex& v0, const SwVertex& v1, const SwVertex& v2);
+
+    /**
+    * Clears and rasterises a single tile
+    * @param tile The index of the tile
+    */
+    void RasteriseTile(int tile);
+
+    /**
+    * Shades a single pixel
+    * @param triangle The triangle covering the pixel
+    * @param l0/l1/l2 Screen space barycentric weights of the pixel
+    * @return the colour of the pixel
+    */
+    glm::vec4 ShadePixel(const Triangle& triangle, float l0, float l1, float l2) const;
+
+private:
+
+    int m_width = 0;                              ///< Width of the colour buffer
+    int m_height = 0;                             ///< Height of the colour buffer
+    int m_tilesX = 0;                             ///< Number of tile columns
+    int m_tilesY = 0;                             ///< Number of tile rows
+    SwWorkerPool& m_workers;                      ///< Pool to rasterise tiles with
+    SwFrame m_frame;                              ///< State for shading the current frame
+    std::vector<unsigned int> m_colour;           ///< Packed BGRA colour buffer
+    std::vector<float> m_depth;                   ///< Normalised device depth buffer
+    std::vector<float> m_sceneDepth;              ///< Depth in the same range as the scene shaders
+    std::vector<Triangle> m_triangles;            ///< Triangles drawn this frame
+    std::vector<SwMaterial> m_materials;          ///< Materials set this frame
+    std::vector<std::vector<int>> m_bins;         ///< Triangle indices overlapping each tile
+};
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_texture.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "software_texture.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float TO_FLOAT = 1.0f / 255.0f; ///< Converts a channel to [0,1]
+}
+
+SwTexture::SwTexture(const Texture& texture, AssetCache& assets)
+    : m_texture(texture)
+    , m_assets(assets)
+{
+}
+
+void SwTexture::Release()
+{
+    m_image.reset();
+    m_pixels = nullptr;
+    m_width = 0;
+    m_height = 0;
+}
+
+bool SwTexture::Initialise()
+{
+    if (!m_texture.IsRenderable() || m_texture.IsCubeMap())
+    {
+        return true;
+    }
+
+    if (m_texture.HasPixels())
+    {
+        return ReloadPixels();
+    }
+
+    m_image = m_assets.GetImage(m_texture.Path());
+    if (!m_image)
+    {
+        Logger::LogError("Software: Failed to load " + m_texture.Path() + " texture");
+        return false;
+    }
+
+    m_pixels = &m_image->pixels[0];
+    m_width = m_image->width;
+    m_height = m_image->height;
+    return true;
+}
+
+bool SwTexture::ReloadPixels()
+{
+    if (m_texture.IsRenderable() && m_texture.HasPixels())
+    {
+        // Procedural pixels are packed RGBA and owned by the scene
+        m_image.reset();
+        m_pixels = reinterpret_cast<const unsigned char*>(&m_texture.Pixels()[0]);
+        m_width = m_texture.Size();
+        m_height = m_texture.Size();
+    }
+    return true;
+}
+
+glm::vec4 SwTexture::Sample(const glm::vec2& uvs) const
+{
+    if (!m_pixels)
+    {
+        return glm::vec4(1.0f);
+    }
+
+    const float u = uvs.x - std::floor(uvs.x);
+    const float v = uvs.y - std::floor(uvs.y);
+
+    if (m_texture.Filtering() == Texture::Nearest)
+    {
+        const int x = std::min(static_cast<int>(u * m_width), m_width - 1);
+        const int y = std::min(static_cast<int>(v * m_height), m_height - 1);
+        const unsigned char* texel = m_pixels + (y * m_width + x) * 4;
+        return glm::vec4(texel[0], texel[1], texel[2], texel[3]) * TO_FLOAT;
+    }
+
+    // Bilinear filtering between the four closest texels
+    const float x = u * m_width - 0.5f;
+    const float y = v * m_height - 0.5f;
+    const float fx = x - std::floor(x);
+    const float fy = y - std::floor(y);
+    const int x0 = (static_cast<int>(std::floor(x)) + m_width) % m_width;
+    const int y0 = (static_cast<int>(std::floor(y)) + m_height) % m_height;
+    const int x1 = (x0 + 1) % m_width;
+    const int y1 = (y0 + 1) % m_height;
+
+    auto fetch = [this](int column, int row)
+    {
+        const unsigned char* texel = m_pixels + (row * m_width + column) * 4;
+        return glm::vec4(texel[0], texel[1], texel[2], texel[3]);
+    };
+
+    const glm::vec4 top = glm::mix(fetch(x0, y0), fetch(x1, y0), fx);
+    const glm::vec4 bottom = glm::mix(fetch(x0, y1), fetch(x1, y1), fx);
+    return glm::mix(top, bottom, fy) * TO_FLOAT;
+}
+
+const std::string& SwTexture::Name() const
+{
+    return m_texture.Name();
+}
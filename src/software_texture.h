@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_texture.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "asset_cache.h"
+#include "texture.h"
+
+#include "glm/glm.hpp"
+
+/**
+* Holds an individual texture sampled by the software rasteriser
+* @note cube maps are not sampled by the software engine
+*/
+class SwTexture : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    * @param texture Contains the texture data
+    * @param assets The decoded assets to sample from
+    */
+    SwTexture(const Texture& texture, AssetCache& assets);
+
+    /**
+    * Releases the texture
+    */
+    void Release();
+
+    /**
+    * Initialises the texture
+    * @return whether initialisation succeeded or not
+    */
+    bool Initialise();
+
+    /**
+    * Reloads the texture from pixels
+    * @return whether reloading was successful
+    */
+    bool ReloadPixels();
+
+    /**
+    * Samples the texture with wrapping
+    * @param uvs The texture coordinates to sample
+    * @return the colour of the texture in [0,1]
+    */
+    glm::vec4 Sample(const glm::vec2& uvs) const;
+
+    /**
+    * @return the filename of the texture
+    */
+    const std::string& Name() const;
+
+private:
+
+    const Texture& m_texture;                        ///< Contains the texture data
+    AssetCache& m_assets;                            ///< Decoded assets to sample from
+    std::shared_ptr<const AssetCache::Image> m_image; ///< Decoded image if loaded from file
+    const unsigned char* m_pixels = nullptr;         ///< RGBA pixels of the texture
+    int m_width = 0;                                 ///< Width of the texture in pixels
+    int m_height = 0;                                ///< Height of the texture in pixels
+};
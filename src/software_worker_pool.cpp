@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_worker_pool.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "software_worker_pool.h"
+#include "memory_usage.h"
+
+#include <algorithm>
+
+SwWorkerPool::SwWorkerPool()
+    : m_job(nullptr)
+    , m_nextJob(0)
+{
+}
+
+SwWorkerPool::~SwWorkerPool()
+{
+    Release();
+}
+
+void SwWorkerPool::Initialise()
+{
+    if (m_running)
+    {
+        return;
+    }
+
+    // The thread calling Run also takes jobs
+    const int workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1;
+
+    m_running = true;
+    for (int i = 0; i < workers; ++i)
+    {
+        m_workers.emplace_back(&SwWorkerPool::WorkerLoop, this);
+    }
+}
+
+void SwWorkerPool::Release()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_start.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    // Workers started again begin counting runs from zero
+    m_generation = 0;
+}
+
+void SwWorkerPool::Run(int jobs, const std::function<void(int)>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_jobs = jobs;
+        m_nextJob = 0;
+        m_busyWorkers = static_cast<int>(m_workers.size());
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    RunJobs();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this](){ return m_busyWorkers == 0; });
+    m_job = nullptr;
+}
+
+int SwWorkerPool::GetThreadCount() const
+{
+    return static_cast<int>(m_workers.size()) + 1;
+}
+
+void SwWorkerPool::RunJobs()
+{
+    for (int job = m_nextJob++; job < m_jobs; job = m_nextJob++)
+    {
+        (*m_job)(job);
+    }
+}
+
+void SwWorkerPool::WorkerLoop()
+{
+    Memory::TrackAllocations();
+
+    int generation = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_start.wait(lock, [&](){ return !m_running || m_generation != generation; });
+        if (!m_running)
+        {
+            break;
+        }
+
+        generation = m_generation;
+        lock.unlock();
+        RunJobs();
+        lock.lock();
+
+        if (--m_busyWorkers == 0)
+        {
+            m_finished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - software_worker_pool.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+* Pool of threads shared by the software rendering stages. Each run splits
+* the work into jobs that are taken in order by the workers and the caller
+*/
+class SwWorkerPool : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    */
+    SwWorkerPool();
+
+    /**
+    * Destructor
+    */
+    ~SwWorkerPool();
+
+    /**
+    * Starts a worker for each hardware thread besides the caller
+    */
+    void Initialise();
+
+    /**
+    * Stops and joins all workers
+    */
+    void Release();
+
+    /**
+    * Runs the jobs across the pool, returning once all have finished
+    * @param jobs The number of jobs to run
+    * @param job Called with the index of each job
+    */
+    void Run(int jobs, const std::function<void(int)>& job);
+
+    /**
+    * @return the number of threads running jobs including the caller
+    */
+    int GetThreadCount() const;
+
+private:
+
+    /**
+    * Runs jobs until none remain
+    */
+    void RunJobs();
+
+    /**
+    * Main loop for each worker thread
+    */
+    void WorkerLoop();
+
+private:
+
+    std::vector<std::thread> m_workers;       ///< Threads running jobs
+    std::mutex m_mutex;                       ///< Guards the worker state
+    std::condition_variable m_start;          ///< Signals the workers to start a run
+    std::condition_variable m_finished;       ///< Signals all workers have finished a run
+    const std::function<void(int)>* m_job;    ///< Job for the current run
+    std::atomic<int> m_nextJob;               ///< Next job to be run
+    int m_jobs = 0;                           ///< Number of jobs for the current run
+    int m_generation = 0;                     ///< Incremented for each run
+    int m_busyWorkers = 0;                    ///< Number of workers yet to finish the run
+    bool m_running = false;                   ///< Whether the workers are running
+};
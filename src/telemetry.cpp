@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - telemetry.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "telemetry.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+void Telemetry::Publish(const FrameStats& stats)
+{
+    const unsigned int frame = m_published.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[frame % CAPACITY];
+
+    // Readers discard the record if the sequence changes while copying
+    const unsigned int sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.stats = stats;
+    slot.stats.frame = frame;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_published.store(frame + 1, std::memory_order_release);
+}
+
+bool Telemetry::Read(unsigned int frame, FrameStats& stats) const
+{
+    const Slot& slot = m_slots[frame % CAPACITY];
+    const unsigned int sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence % 2 != 0)
+    {
+        return false;
+    }
+
+    stats = slot.stats;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return slot.sequence.load(std::memory_order_relaxed) == sequence &&
+        stats.frame == frame;
+}
+
+bool Telemetry::GetLatest(FrameStats& stats) const
+{
+    while (true)
+    {
+        const unsigned int published = m_published.load(std::memory_order_acquire);
+        if (published == 0)
+        {
+            return false;
+        }
+
+        // Only fails if the ring has been written over while copying
+        if (Read(published - 1, stats))
+        {
+            return true;
+        }
+    }
+}
+
+unsigned int Telemetry::GetSince(unsigned int frame, std::vector<FrameStats>& stats) const
+{
+    const unsigned int published = m_published.load(std::memory_order_acquire);
+    const unsigned int first = published - frame > CAPACITY ? published - CAPACITY : frame;
+
+    FrameStats record;
+    for (unsigned int i = first; i != published; ++i)
+    {
+        if (Read(i, record))
+        {
+            stats.push_back(record);
+        }
+    }
+    return published;
+}
+
+bool Telemetry::WriteTrace(const std::string& path) const
+{
+    std::vector<FrameStats> frames;
+    GetSince(0, frames);
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        Logger::LogError("Telemetry: Could not open " + path);
+        return false;
+    }
+
+    // Times are in microseconds, each frame starts with its simulation stage
+    file << "{\"traceEvents\":[";
+    const char* separator = "\n";
+    auto writeStage = [&](const char* name, double start, float duration)
+    {
+        file << separator << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << start << ",\"dur\":" << duration * 1000.0f << "}";
+        separator = ",\n";
+    };
+
+    for (const FrameStats& stats : frames)
+    {
+        // Stage times belong to the frame which ended as the record was published
+        const double end = stats.timer * 1000000.0;
+        const FrameTimes& times = stats.times;
+        double start = end - (times.simulation + times.submission + times.gpuWait) * 1000.0;
+
+        writeStage("Simulation", start, times.simulation);
+        start += times.simulation * 1000.0;
+        writeStage("Submission", start, times.submission);
+        start += times.submission * 1000.0;
+        writeStage("GPU Wait", start, times.gpuWait);
+
+        file << ",\n{\"name\":\"Frame\",\"ph\":\"C\",\"pid\":1,\"ts\":" << end
+             << ",\"args\":{\"Frame Time\":" << stats.deltaTime * 1000.0f
+             << ",\"Particles\":" << stats.aliveParticles
+             << ",\"Patches\":" << stats.patchesPlaced
+             << ",\"Bytes Uploaded\":" << stats.bytesUploaded << "}}";
+    }
+
+    file << "\n]}\n";
+    Logger::LogInfo("Telemetry: Wrote %d frames to %s", static_cast<int>(frames.size()), path.c_str());
+    return true;
+}
+
+FrameSummary Telemetry::Summarise() const
+{
+    FrameSummary summary;
+    summary.histogram.fill(0);
+
+    const unsigned int published = m_published.load(std::memory_order_acquire);
+    const unsigned int first = published > CAPACITY ? published - CAPACITY : 0;
+
+    float total = 0.0f;
+    FrameStats stats;
+    std::array<float, CAPACITY> times;
+
+    for (unsigned int frame = first; frame < published; ++frame)
+    {
+        if (Read(frame, stats))
+        {
+            const float time = stats.deltaTime * 1000.0f;
+            const int bucket = std::min(static_cast<int>(time) /
+                FrameSummary::BUCKET_SIZE, FrameSummary::BUCKETS - 1);
+
+            ++summary.histogram[std::max(bucket, 0)];
+            times[summary.frames++] = time;
+            total += time;
+        }
+    }
+
+    if (summary.frames == 0)
+    {
+        return summary;
+    }
+
+    std::sort(times.begin(), times.begin() + summary.frames);
+
+    // Nearest rank of the sorted frame times
+    auto percentile = [&](float amount) -> float
+    {
+        const int rank = static_cast<int>(std::ceil(amount * summary.frames));
+        return times[std::max(0, std::min(rank, summary.frames) - 1)];
+    };
+
+    summary.average = total / summary.frames;
+    summary.median = percentile(0.5f);
+    summary.percentile95 = percentile(0.95f);
+    summary.percentile99 = percentile(0.99f);
+    summary.maximum = times[summary.frames - 1];
+    return summary;
+}
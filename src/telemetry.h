@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - telemetry.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+
+/**
+* Milliseconds spent on each stage of a frame
+*/
+struct FrameTimes
+{
+    float simulation = 0.0f;          ///< Ticking the scene, on the worker when pipelined
+    float submission = 0.0f;          ///< Submitting the frame to the render engine
+    float gpuWait = 0.0f;             ///< Presenting, including any wait on the gpu
+};
+
+/**
+* Statistics recorded for a single frame
+* @note fixed layout so records can be copied without allocating
+*/
+struct FrameStats
+{
+    /**
+    * Selected objects with rendered instances
+    */
+    enum Object
+    {
+        Mesh,
+        Water,
+        Terrain,
+        Emitter,
+        Max
+    };
+
+    unsigned int frame = 0;           ///< Number of the frame, set when published
+    float deltaTime = 0.0f;           ///< Seconds passed since the previous frame
+    float timer = 0.0f;               ///< Seconds passed since starting
+    int framesPerSec = 0;             ///< Frames per second for the application
+    int bytesUploaded = 0;            ///< Bytes uploaded to the gpu during the frame
+    int visibleInstances[Max] = {};   ///< Instances rendered of each selected object
+    int totalInstances[Max] = {};     ///< Instances of each selected object, 0 if none selected
+    int sceneInstances = 0;           ///< Instances rendered over all objects in the scene
+    int aliveParticles = 0;           ///< Particles alive over all emitters
+    int patchesPlaced = 0;            ///< Terrain patches re-placed during the previous frame
+    int allocations = 0;              ///< Heap allocations of the frame loop during the previous frame
+    FrameTimes times;                 ///< Stage times of the previous frame
+};
+
+/**
+* Rolling statistics of the frame times held by the telemetry
+*/
+struct FrameSummary
+{
+    static const int BUCKETS = 16;      ///< Number of histogram buckets
+    static const int BUCKET_SIZE = 2;   ///< Milliseconds for each bucket, the last holds all slower frames
+
+    int frames = 0;                     ///< Number of frames summarised
+    float average = 0.0f;               ///< Average frame time in milliseconds
+    float median = 0.0f;                ///< 50th percentile frame time in milliseconds
+    float percentile95 = 0.0f;          ///< 95th percentile frame time in milliseconds
+    float percentile99 = 0.0f;          ///< 99th percentile frame time in milliseconds
+    float maximum = 0.0f;               ///< Slowest frame time in milliseconds
+    std::array<int, BUCKETS> histogram; ///< Number of frames within each bucket
+};
+
+/**
+* Wait-free channel for statistics of each frame. A single thread
+* publishes records into a ring which readers on any thread copy
+* from without locking or blocking the publisher
+*/
+class Telemetry : boost::noncopyable
+{
+public:
+
+    static const unsigned int CAPACITY = 256; ///< Number of frames held, must be a power of two
+
+    /**
+    * Publishes the statistics of a frame
+    * @note only called by a single thread
+    * @param stats The statistics to publish
+    */
+    void Publish(const FrameStats& stats);
+
+    /**
+    * Copies the statistics of the last published frame
+    * @param stats Filled with the statistics
+    * @return whether any frames have been published
+    */
+    bool GetLatest(FrameStats& stats) const;
+
+    /**
+    * Copies the statistics of all frames held published after a frame
+    * @param frame The number of frames already copied
+    * @param stats Appended with the statistics, oldest first
+    * @return the number of frames published when copied
+    */
+    unsigned int GetSince(unsigned int frame, std::vector<FrameStats>& stats) const;
+
+    /**
+    * Writes the frames held as a trace viewable in chrome://tracing
+    * @param path The path to write to
+    * @return whether the file could be written
+    */
+    bool WriteTrace(const std::string& path) const;
+
+    /**
+    * Computes frame time percentiles and a histogram of the frames held
+    * @return the statistics of the frames held
+    */
+    FrameSummary Summarise() const;
+
+private:
+
+    /**
+    * Copies the statistics of a frame if still held
+    * @param frame The number of the frame
+    * @param stats Filled with the statistics
+    * @return whether the statistics were copied without being overwritten
+    */
+    bool Read(unsigned int frame, FrameStats& stats) const;
+
+    /**
+    * A record within the ring
+    */
+    struct Slot
+    {
+        std::atomic<unsigned int> sequence { 0 };  ///< Odd while the record is being written
+        FrameStats stats;                          ///< Statistics of the frame
+    };
+
+    std::array<Slot, CAPACITY> m_slots;            ///< Ring of the most recent frames
+    std::atomic<unsigned int> m_published { 0 };   ///< Number of frames published
+};
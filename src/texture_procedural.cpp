@@ -22,9 +22,11 @@ ProceduralTexture::ProceduralTexture(const std::string& name,
                                      Generation generation)
     : Texture(name, path, Type::Procedural, Filter::Nearest)
     , m_generation(generation)
+    , m_pixelMemory(Memory::TexturePixels)
 {
     m_size = size;
     m_pixels.resize(size * size);
+    m_pixelMemory.Set(m_pixels.capacity() * sizeof(unsigned int));
 
     m_savePath = boost::filesystem::initial_path().string();
     m_savePath += std::string(path.begin() + 1, path.end()); // Remove .
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "texture.h"
+#include "memory_usage.h"
 
 /**
 * Manages generating textures 
@@ -174,4 +175,5 @@ private:
     float m_amplitude = 1.0f;           ///< Amplitude value for generating a texture
     float m_contrast = 1.0f;            ///< Brightness multiplier of the final texture
     int m_iterations = 1;               ///< Number of iterations for the algorithm
+    MemoryUsage m_pixelMemory;          ///< Bytes held by the pixels
 };
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - tweak_queue.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <array>
+
+/**
+* A change to a single attribute made through the tweaker
+*/
+struct TweakEvent
+{
+    /**
+    * The object the changed attribute belongs to
+    */
+    enum Object
+    {
+        Camera,
+        Light,
+        Mesh,
+        Water,
+        Wave,
+        Emitter,
+        Post,
+        Terrain,
+        Texture,
+        Max
+    };
+
+    Object object = Max;   ///< Object the attribute belongs to
+    int attribute = 0;     ///< Attribute of the object that changed
+    float value = 0.0f;    ///< The new value of the attribute
+};
+
+/**
+* Lock-free queue of attribute changes sent from the gui to the application
+* @note only a single thread may push and a single thread may pop
+*/
+class TweakQueue
+{
+public:
+
+    /**
+    * Adds a change to the queue
+    * @note called by the gui thread
+    * @param event The change made
+    * @return whether there was room for the change
+    */
+    bool Push(const TweakEvent& event)
+    {
+        const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            return false;
+        }
+
+        m_events[tail % CAPACITY] = event;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+    * Removes the oldest change from the queue
+    * @note called by the application thread
+    * @param event Filled with the change made
+    * @return whether there was a change to remove
+    */
+    bool Pop(TweakEvent& event)
+    {
+        const unsigned int head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        event = m_events[head % CAPACITY];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+    * Notifies the application that changes were sent outside of the queue
+    * @note called by the gui thread once the changes have been cached
+    */
+    void SetOverflowed()
+    {
+        m_overflowed = true;
+    }
+
+    /**
+    * Clears whether changes were sent outside of the queue
+    * @return whether all attributes should be read again from the cache
+    */
+    bool TakeOverflowed()
+    {
+        return m_overflowed.exchange(false);
+    }
+
+private:
+
+    static const unsigned int CAPACITY = 256; ///< Maximum changes waiting, must be a power of two
+
+    std::array<TweakEvent, CAPACITY> m_events;     ///< Ring buffer of changes
+    std::atomic<unsigned int> m_head { 0 };        ///< Position of the oldest change
+    std::atomic<unsigned int> m_tail { 0 };        ///< Position after the newest change
+    std::atomic<bool> m_overflowed { false };      ///< Whether changes were sent outside the queue
+};
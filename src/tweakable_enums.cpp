@@ -401,6 +401,8 @@ namespace Tweakable
             return "Mesh";
         case Post:
             return "Post";
+        case Performance:
+            return "Performance";
         }
         return "";
     }
@@ -254,6 +254,7 @@ namespace Tweakable
             Area,
             Mesh,
             Post,
+            Performance,
             None
         };
         const char* toString(Page value);
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - worker_thread.cpp
+////////////////////////////////////////////////////////////////////////////////////////
+
+#include "worker_thread.h"
+
+WorkerThread::WorkerThread()
+{
+    m_thread = std::thread(&WorkerThread::Run, this);
+}
+
+WorkerThread::~WorkerThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_signal.notify_all();
+    m_thread.join();
+}
+
+void WorkerThread::Push(std::function<void(void)> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_signal.notify_all();
+}
+
+void WorkerThread::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_signal.wait(lock, [this](){ return m_jobs.empty() && !m_busy; });
+}
+
+void WorkerThread::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_signal.wait(lock, [this](){ return !m_jobs.empty() || !m_running; });
+        if (m_jobs.empty())
+        {
+            break;
+        }
+
+        auto job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_busy = true;
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        m_busy = false;
+        m_signal.notify_all();
+    }
+}
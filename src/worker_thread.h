@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////////
+// Kara Jensen - mail@karajensen.com - worker_thread.h
+////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+* Single owned thread running background jobs one at a time in the order
+* they were pushed. Jobs still queued are finished before the thread is
+* joined so any files they write are never left partially written
+*/
+class WorkerThread : boost::noncopyable
+{
+public:
+
+    /**
+    * Constructor
+    */
+    WorkerThread();
+
+    /**
+    * Destructor, finishes all queued jobs before joining
+    */
+    ~WorkerThread();
+
+    /**
+    * Queues a job to run on the worker thread
+    * @param job The job to run
+    */
+    void Push(std::function<void(void)> job);
+
+    /**
+    * Blocks until all queued jobs have finished
+    */
+    void Wait();
+
+private:
+
+    /**
+    * Main loop for the worker thread
+    */
+    void Run();
+
+private:
+
+    std::thread m_thread;                          ///< Thread running the jobs
+    std::mutex m_mutex;                            ///< Guards the job state
+    std::condition_variable m_signal;              ///< Signal for a change in job state
+    std::deque<std::function<void(void)>> m_jobs;  ///< Jobs yet to be started
+    bool m_busy = false;                           ///< Whether a job is running
+    bool m_running = true;                         ///< Whether the thread is running
+};